@@ -0,0 +1,531 @@
+#include "CPU/Z80.h"
+#include "Core/Machine.h"
+#include "Memory/MemoryBus.h"
+#include "Video/TileDecoder.h"
+#include "Video/VideoController.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Micro-benchmark dei percorsi caldi di CPU, memory bus e video.
+// Ogni caso esegue blocchi di operazioni finche' non raggiunge il tempo minimo,
+// ripetuto per piu' campioni; si riportano il campione migliore e la mediana.
+// I risultati vanno in un file JSON, pensato per essere confrontato commit per
+// commit; su stdout resta una tabella leggibile (il core ci scrive anche i suoi log).
+//
+// Uso: PacmanBench [--roms DIR] [--filter TESTO] [--min-time S] [--samples N] [--output FILE]
+//   --roms DIR      directory delle ROM di Pac-Man (default assets)
+//   --filter TESTO  esegue solo i casi il cui nome contiene TESTO
+//   --min-time S    durata minima di ogni campione in secondi (default 0.2)
+//   --samples N     campioni per caso (default 5)
+//   --output FILE   file JSON dei risultati (default PacmanBench.json)
+
+namespace {
+
+// Le somme di controllo finiscono qui, cosi' il compilatore non elimina i loop
+volatile uint32_t g_sink = 0;
+
+struct BenchOptions {
+    std::string romDir = "assets";
+    std::string filter;
+    double minSeconds = 0.2;
+    int samples = 5;
+    std::string outputPath = "PacmanBench.json";
+};
+
+bool IsSelected(const BenchOptions &options, const std::string &name)
+{
+    return name.find(options.filter) != std::string::npos;
+}
+
+struct BenchResult {
+    std::string name;
+    std::string unit;               // Cosa conta come una operazione
+    uint64_t operations = 0;        // Operazioni del campione migliore
+    double bestNsPerOp = 0.0;
+    double medianNsPerOp = 0.0;
+    double opsPerSecond = 0.0;      // Dal campione migliore
+    double emulatedMhz = 0.0;       // Solo per i casi CPU (0 = non applicabile)
+};
+
+// Esegue un blocco di operazioni e ne restituisce il numero
+using BenchBody = std::function<uint64_t()>;
+
+// Cicli Z80 consumati dal caso (per i MHz emulati); nullptr per i casi non CPU
+using CycleCounter = std::function<uint64_t()>;
+
+BenchResult Measure(const std::string &name, const std::string &unit, const BenchOptions &options,
+    const BenchBody &body, const CycleCounter &cycles = nullptr)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Riscaldamento: cache, predittori, atlanti costruiti al primo frame
+    body();
+
+    std::vector<double> nsPerOp;
+    BenchResult result;
+    result.name = name;
+    result.unit = unit;
+
+    for (int sample = 0; sample < options.samples; sample++) {
+        uint64_t operations = 0;
+        uint64_t startCycles = cycles ? cycles() : 0;
+        auto start = Clock::now();
+        std::chrono::duration<double> elapsed{};
+
+        do {
+            operations += body();
+            elapsed = Clock::now() - start;
+        } while (elapsed.count() < options.minSeconds);
+
+        double seconds = elapsed.count();
+        double ns = seconds * 1e9 / operations;
+        nsPerOp.push_back(ns);
+
+        if (sample == 0 || ns < result.bestNsPerOp) {
+            result.bestNsPerOp = ns;
+            result.operations = operations;
+            result.opsPerSecond = operations / seconds;
+            if (cycles) {
+                result.emulatedMhz = (cycles() - startCycles) / seconds / 1e6;
+            }
+        }
+    }
+
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    result.medianNsPerOp = nsPerOp[nsPerOp.size() / 2];
+    return result;
+}
+
+// --- Z80::Step ---------------------------------------------------------------
+
+constexpr uint16_t PROGRAM_START = 0x0100;
+constexpr uint64_t STEP_BATCH = 10000;
+
+// Programmi di prova: un prologo seguito da un loop infinito che termina con
+// JP al byte indicato da loopStart (offset dall'inizio del programma)
+struct InstructionMix {
+    const char *name;
+    std::vector<uint8_t> program;
+    uint16_t loopStart;
+};
+
+std::vector<InstructionMix> BuildInstructionMixes()
+{
+    std::vector<InstructionMix> mixes;
+
+    // LD e ALU a 8 bit fra registri e immediati
+    mixes.push_back({ "cpu.step.ld_alu", {
+        0x78,               // LD A,B
+        0x81,               // ADD A,C
+        0x57,               // LD D,A
+        0xAB,               // XOR E
+        0x5F,               // LD E,A
+        0x04,               // INC B
+        0x0D,               // DEC C
+        0xE6, 0x7F,         // AND 0x7F
+        0xB2,               // OR D
+        0xD6, 0x11,         // SUB 0x11
+        0xBD,               // CP L
+        0x67,               // LD H,A
+        0x8C,               // ADC A,H
+        0x2C,               // INC L
+        0xC3, 0x00, 0x00,   // JP loop
+    }, 0 });
+
+    // Prefisso CB: rotazioni/shift, BIT, SET/RES su registri e (HL)
+    mixes.push_back({ "cpu.step.cb", {
+        0x21, 0x00, 0x80,   // LD HL,0x8000
+        0xCB, 0x00,         // loop: RLC B
+        0xCB, 0x19,         // RR C
+        0xCB, 0x22,         // SLA D
+        0xCB, 0x3B,         // SRL E
+        0xCB, 0x2F,         // SRA A
+        0xCB, 0x16,         // RL (HL)
+        0xCB, 0x5F,         // BIT 3,A
+        0xCB, 0x7C,         // BIT 7,H
+        0xCB, 0x46,         // BIT 0,(HL)
+        0xCB, 0xD5,         // SET 2,L
+        0xCB, 0x95,         // RES 2,L
+        0xCB, 0xFE,         // SET 7,(HL)
+        0xC3, 0x00, 0x00,   // JP loop
+    }, 3 });
+
+    // Copie a blocchi: ogni ripetizione di LDIR conta come una istruzione
+    mixes.push_back({ "cpu.step.ldir", {
+        0x21, 0x00, 0x40,   // loop: LD HL,0x4000
+        0x11, 0x00, 0x60,   // LD DE,0x6000
+        0x01, 0x00, 0x01,   // LD BC,0x0100
+        0xED, 0xB0,         // LDIR
+        0xC3, 0x00, 0x00,   // JP loop
+    }, 0 });
+
+    // Prefissi DD/FD: accessi (IX+d)/(IY+d), DDCB/FDCB, aritmetica a 16 bit
+    mixes.push_back({ "cpu.step.indexed", {
+        0xDD, 0x21, 0x00, 0x80,     // LD IX,0x8000
+        0xFD, 0x21, 0x00, 0x81,     // LD IY,0x8100
+        0xDD, 0x7E, 0x01,           // loop: LD A,(IX+1)
+        0xFD, 0x86, 0x02,           // ADD A,(IY+2)
+        0xDD, 0x77, 0x03,           // LD (IX+3),A
+        0xFD, 0x34, 0x04,           // INC (IY+4)
+        0xDD, 0x46, 0x05,           // LD B,(IX+5)
+        0xDD, 0xCB, 0x06, 0xCE,     // SET 1,(IX+6)
+        0xFD, 0xCB, 0x07, 0x8E,     // RES 1,(IY+7)
+        0xDD, 0x23,                 // INC IX
+        0xDD, 0x2B,                 // DEC IX
+        0xDD, 0x09,                 // ADD IX,BC
+        0xDD, 0x21, 0x00, 0x80,     // LD IX,0x8000
+        0xC3, 0x00, 0x00,           // JP loop
+    }, 8 });
+
+    // Il JP finale punta all'inizio del loop
+    for (InstructionMix &mix : mixes) {
+        uint16_t target = PROGRAM_START + mix.loopStart;
+        size_t size = mix.program.size();
+        mix.program[size - 2] = target & 0xFF;
+        mix.program[size - 1] = target >> 8;
+    }
+
+    return mixes;
+}
+
+void RunCpuBenchmarks(const BenchOptions &options, std::vector<BenchResult> &results)
+{
+    for (const InstructionMix &mix : BuildInstructionMixes()) {
+        if (!IsSelected(options, mix.name)) continue;
+
+        // RAM flat: i programmi non dipendono dalle ROM di Pac-Man
+        auto memory = std::make_unique<MemoryBus>();
+        memory->EnableFlatMemory();
+        for (size_t i = 0; i < mix.program.size(); i++) {
+            memory->Write(static_cast<uint16_t>(PROGRAM_START + i), mix.program[i]);
+        }
+
+        auto cpu = std::make_unique<Z80>(memory.get());
+        cpu->SetPC(PROGRAM_START);
+
+        Z80 *z80 = cpu.get();
+        results.push_back(Measure(mix.name, "instruction", options,
+            [z80]() {
+                for (uint64_t i = 0; i < STEP_BATCH; i++) {
+                    z80->Step();
+                }
+                return STEP_BATCH;
+            },
+            [z80]() { return z80->GetTotalCycles(); }));
+    }
+}
+
+// --- MemoryBus::Read/Write ---------------------------------------------------
+
+constexpr uint64_t MEMORY_BATCH = 65536;
+
+struct MemoryRegion {
+    const char *name;
+    uint16_t base;
+    uint16_t mask;      // Gli indirizzi scorrono in base + (i & mask)
+};
+
+// Regioni della mappa di Pac-Man. ROM e I/O in scrittura passano dal gestore lento.
+constexpr MemoryRegion READ_REGIONS[] = {
+    { "rom", 0x0000, 0x3FFF },
+    { "vram", 0x4000, 0x03FF },
+    { "cram", 0x4400, 0x03FF },
+    { "ram", 0x4C00, 0x03FF },
+    { "io", 0x5000, 0x00FF },
+};
+
+constexpr MemoryRegion WRITE_REGIONS[] = {
+    { "rom", 0x0000, 0x3FFF },
+    { "vram", 0x4000, 0x03FF },
+    { "cram", 0x4400, 0x03FF },
+    { "ram", 0x4C00, 0x03FF },
+    { "io", 0x5040, 0x001F },     // Registri del generatore sonoro
+};
+
+void RunMemoryBenchmarks(const BenchOptions &options, Machine &machine, std::vector<BenchResult> &results)
+{
+    MemoryBus *memory = &machine.GetMemory();
+
+    for (const MemoryRegion &region : READ_REGIONS) {
+        std::string name = std::string("memory.read.") + region.name;
+        if (!IsSelected(options, name)) continue;
+
+        results.push_back(Measure(name, "access", options, [memory, region]() {
+            uint32_t sum = 0;
+            for (uint64_t i = 0; i < MEMORY_BATCH; i++) {
+                sum += memory->Read(static_cast<uint16_t>(region.base + (i & region.mask)));
+            }
+            g_sink = g_sink + sum;
+            return MEMORY_BATCH;
+        }));
+    }
+
+    for (const MemoryRegion &region : WRITE_REGIONS) {
+        std::string name = std::string("memory.write.") + region.name;
+        if (!IsSelected(options, name)) continue;
+
+        results.push_back(Measure(name, "access", options, [memory, region]() {
+            for (uint64_t i = 0; i < MEMORY_BATCH; i++) {
+                memory->Write(static_cast<uint16_t>(region.base + (i & region.mask)), static_cast<uint8_t>(i));
+            }
+            return MEMORY_BATCH;
+        }));
+    }
+}
+
+// --- Video -------------------------------------------------------------------
+
+void RunVideoBenchmarks(const BenchOptions &options, Machine &machine, std::vector<BenchResult> &results)
+{
+    if (IsSelected(options, "video.decode_tile")) {
+        auto decoder = std::make_shared<TileDecoder>(machine.GetMemory());
+        results.push_back(Measure("video.decode_tile", "tile", options, [decoder]() {
+            uint32_t sum = 0;
+            for (int palette = 0; palette < 64; palette++) {
+                for (int tile = 0; tile < 256; tile++) {
+                    std::array<uint32_t, 64> pixels = decoder->DecodeTile(static_cast<uint8_t>(tile), static_cast<uint8_t>(palette));
+                    sum += pixels[tile & 63];
+                }
+            }
+            g_sink = g_sink + sum;
+            return uint64_t(64 * 256);
+        }));
+    }
+
+    // Riferimento scalare (il fallback degli host senza SSE2)
+    if (IsSelected(options, "video.decode_tile_scalar")) {
+        auto decoder = std::make_shared<TileDecoder>(machine.GetMemory());
+        results.push_back(Measure("video.decode_tile_scalar", "tile", options, [decoder]() {
+            uint32_t sum = 0;
+            for (int palette = 0; palette < 64; palette++) {
+                for (int tile = 0; tile < 256; tile++) {
+                    std::array<uint32_t, 64> pixels = decoder->DecodeTileScalar(static_cast<uint8_t>(tile), static_cast<uint8_t>(palette));
+                    sum += pixels[tile & 63];
+                }
+            }
+            g_sink = g_sink + sum;
+            return uint64_t(64 * 256);
+        }));
+    }
+
+    VideoController *video = &machine.GetVideo();
+
+    // Regime del gioco: solo le celle sporche (o sotto gli sprite) vengono ridisegnate
+    if (IsSelected(options, "video.render_scanline")) {
+        results.push_back(Measure("video.render_scanline", "scanline", options, [video]() {
+            for (int y = 0; y < SCREEN_HEIGHT; y++) {
+                video->RenderScanline(y);
+            }
+            return uint64_t(SCREEN_HEIGHT);
+        }));
+    }
+
+    // Caso peggiore: tutti i tile marcati da ridisegnare a ogni frame
+    if (IsSelected(options, "video.render_scanline_full")) {
+        results.push_back(Measure("video.render_scanline_full", "scanline", options, [video]() {
+            video->MarkAllTilesForRedraw();
+            for (int y = 0; y < SCREEN_HEIGHT; y++) {
+                video->RenderScanline(y);
+            }
+            return uint64_t(SCREEN_HEIGHT);
+        }));
+    }
+
+    if (IsSelected(options, "video.render_frame")) {
+        results.push_back(Measure("video.render_frame", "frame", options, [video]() {
+            video->RenderFrame();
+            return uint64_t(1);
+        }));
+    }
+
+    if (IsSelected(options, "video.render_frame_full")) {
+        results.push_back(Measure("video.render_frame_full", "frame", options, [video]() {
+            video->RenderFrame(true);
+            return uint64_t(1);
+        }));
+    }
+
+    // Framebuffer indicizzato: stesso frame a 1 byte per pixel, poi ritorno a RGBA
+    if (IsSelected(options, "video.render_frame_full_indexed")) {
+        video->SetFrameBufferFormat(FrameBufferFormat::INDEXED);
+        results.push_back(Measure("video.render_frame_full_indexed", "frame", options, [video]() {
+            video->RenderFrame(true);
+            return uint64_t(1);
+        }));
+        video->SetFrameBufferFormat(FrameBufferFormat::RGBA);
+    }
+
+    // Conversione differita in RGBA (presentazione, screenshot, osservazioni RGBA)
+    if (IsSelected(options, "video.convert_rgba")) {
+        video->SetFrameBufferFormat(FrameBufferFormat::INDEXED);
+        video->RenderFrame();
+        auto rgba = std::make_shared<std::vector<uint32_t>>(SCREEN_SIZE);
+        results.push_back(Measure("video.convert_rgba", "frame", options, [video, rgba]() {
+            video->ConvertFrameBufferToRGBA(rgba->data());
+            g_sink = g_sink + (*rgba)[SCREEN_SIZE / 2];
+            return uint64_t(1);
+        }));
+        video->SetFrameBufferFormat(FrameBufferFormat::RGBA);
+    }
+}
+
+// --- Frame completo ----------------------------------------------------------
+
+void RunFrameBenchmarks(const BenchOptions &options, Machine &machine, std::vector<BenchResult> &results)
+{
+    Machine *pacman = &machine;
+    Z80 *cpu = machine.GetCPU();
+
+    if (IsSelected(options, "frame.headless")) {
+        results.push_back(Measure("frame.headless", "frame", options,
+            [pacman]() {
+                pacman->RunFrame(true);
+                return uint64_t(1);
+            },
+            [cpu]() { return cpu->GetTotalCycles(); }));
+    }
+
+    if (IsSelected(options, "frame.headless_indexed")) {
+        machine.GetVideo().SetFrameBufferFormat(FrameBufferFormat::INDEXED);
+        results.push_back(Measure("frame.headless_indexed", "frame", options,
+            [pacman]() {
+                pacman->RunFrame(true);
+                return uint64_t(1);
+            },
+            [cpu]() { return cpu->GetTotalCycles(); }));
+        machine.GetVideo().SetFrameBufferFormat(FrameBufferFormat::RGBA);
+    }
+
+    if (IsSelected(options, "frame.headless_novideo")) {
+        results.push_back(Measure("frame.headless_novideo", "frame", options,
+            [pacman]() {
+                pacman->RunFrame(false);
+                return uint64_t(1);
+            },
+            [cpu]() { return cpu->GetTotalCycles(); }));
+    }
+}
+
+// --- Output JSON -------------------------------------------------------------
+
+std::string EscapeJson(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void WriteJson(std::ostream &out, const BenchOptions &options, const std::vector<BenchResult> &results)
+{
+    out << "{\n";
+    out << "  \"benchmark\": \"PacmanBench\",\n";
+    out << "  \"version\": 1,\n";
+#ifdef _DEBUG
+    out << "  \"build\": \"debug\",\n";
+#else
+    out << "  \"build\": \"release\",\n";
+#endif
+    out << "  \"min_time_s\": " << options.minSeconds << ",\n";
+    out << "  \"samples\": " << options.samples << ",\n";
+    out << "  \"results\": [\n";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        out << "    {\"name\": \"" << EscapeJson(r.name) << "\""
+            << ", \"unit\": \"" << EscapeJson(r.unit) << "\""
+            << ", \"operations\": " << r.operations
+            << ", \"ns_per_op\": " << r.bestNsPerOp
+            << ", \"median_ns_per_op\": " << r.medianNsPerOp
+            << ", \"ops_per_second\": " << r.opsPerSecond;
+        if (r.emulatedMhz > 0.0) {
+            out << ", \"emulated_mhz\": " << r.emulatedMhz;
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    BenchOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--roms" && hasValue) {
+            options.romDir = argv[++i];
+        }
+        else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        }
+        else if (arg == "--min-time" && hasValue) {
+            options.minSeconds = std::stod(argv[++i]);
+        }
+        else if (arg == "--samples" && hasValue) {
+            options.samples = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--output" && hasValue) {
+            options.outputPath = argv[++i];
+        }
+        else {
+            std::cerr << "Argomento sconosciuto: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    RunCpuBenchmarks(options, results);
+
+    // Memoria, video e frame girano sulla macchina vera, portata in modalita'
+    // demo perche' VRAM, sprite e suono abbiano contenuti realistici
+    auto machine = std::make_unique<Machine>();
+    if (!machine->LoadRomSet(options.romDir)) {
+        std::cerr << "Impossibile caricare le ROM da " << options.romDir << std::endl;
+        return 2;
+    }
+    constexpr int WARMUP_FRAMES = 600;
+    for (int frame = 0; frame < WARMUP_FRAMES; frame++) {
+        machine->RunFrame(true);
+    }
+
+    // La memoria per ultima: le scritture sporcano VRAM e RAM del gioco
+    RunVideoBenchmarks(options, *machine, results);
+    RunFrameBenchmarks(options, *machine, results);
+    RunMemoryBenchmarks(options, *machine, results);
+
+    std::cout << "\n";
+    for (const BenchResult &r : results) {
+        std::cout << std::left << std::setw(28) << r.name << std::right
+            << std::fixed << std::setprecision(2) << std::setw(14) << r.bestNsPerOp << " ns/" << r.unit;
+        if (r.emulatedMhz > 0.0) {
+            std::cout << "  (" << r.emulatedMhz << " MHz Z80 emulati)";
+        }
+        std::cout << "\n";
+    }
+    std::cout.unsetf(std::ios::floatfield);
+
+    std::ofstream file(options.outputPath);
+    if (!file) {
+        std::cerr << "Impossibile scrivere " << options.outputPath << std::endl;
+        return 2;
+    }
+    WriteJson(file, options, results);
+    std::cout << "Risultati scritti in " << options.outputPath << std::endl;
+
+    return 0;
+}
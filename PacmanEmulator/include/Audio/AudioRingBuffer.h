@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Coda circolare lock-free single-producer / single-consumer per i campioni audio.
+// Il produttore e' il thread di emulazione, il consumatore il thread audio.
+// Nessuna delle due parti si blocca mai: se la coda e' piena i nuovi campioni
+// vengono scartati, se e' vuota il consumatore riceve meno campioni di quelli chiesti.
+// Tutta la memoria e' allocata nel costruttore.
+class AudioRingBuffer
+{
+public:
+	// La capacita' viene arrotondata alla potenza di due successiva
+	explicit AudioRingBuffer(size_t capacity);
+
+	AudioRingBuffer(const AudioRingBuffer &) = delete;
+	AudioRingBuffer &operator=(const AudioRingBuffer &) = delete;
+
+	// Solo dal thread produttore: ritorna i campioni effettivamente accodati
+	size_t Push(const int16_t *samples, size_t count);
+
+	// Solo dal thread consumatore: ritorna i campioni effettivamente letti
+	size_t Pop(int16_t *samples, size_t count);
+
+	// Campioni in coda (valore indicativo se letto dall'altro thread)
+	size_t GetAvailable() const;
+	size_t GetCapacity() const { return m_mask + 1; }
+
+	// Campioni scartati perche' la coda era piena
+	uint64_t GetDroppedSamples() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+	std::unique_ptr<int16_t[]> m_buffer;
+	size_t m_mask;
+
+	// Indici liberi di crescere (il modulo e' applicato con la maschera),
+	// su linee di cache separate per non far rimbalzare la linea tra i due thread
+	alignas(64) std::atomic<size_t> m_writeIndex;
+	alignas(64) std::atomic<size_t> m_readIndex;
+	alignas(64) std::atomic<uint64_t> m_dropped;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "Core/SaveState.h"
+
+// Generatore di forme d'onda Namco (WSG) a 3 voci di Pac-Man.
+// Ogni voce ha un accumulatore di fase a 20 bit, una frequenza, un volume a
+// 4 bit e una delle 8 forme d'onda da 32 campioni a 4 bit della PROM 82s126.1m.
+//
+// Registri (offset da 0x5040, solo il nibble basso):
+//   0x05 / 0x0A / 0x0F   forma d'onda delle voci 0 / 1 / 2
+//   0x10-0x14            frequenza voce 0 (20 bit, nibble meno significativo per primo)
+//   0x16-0x19, 0x1B-0x1E frequenza voci 1 e 2 (16 bit: il nibble basso vale 0)
+//   0x15 / 0x1A / 0x1F   volume delle voci 0 / 1 / 2
+// Gli offset 0x00-0x04, 0x06-0x09 e 0x0B-0x0E sono gli accumulatori interni.
+class NamcoWSG
+{
+public:
+	// Il chip genera un campione ogni 32 cicli CPU (3.072 MHz / 32 = 96 kHz)
+	static constexpr int CYCLES_PER_CHIP_SAMPLE = 32;
+	static constexpr int CHIP_SAMPLE_RATE = 96000;
+
+	// In uscita due campioni del chip vengono mediati: 48 kHz mono
+	static constexpr int OUTPUT_DECIMATION = 2;
+	static constexpr int OUTPUT_SAMPLE_RATE = CHIP_SAMPLE_RATE / OUTPUT_DECIMATION;
+	static constexpr int CYCLES_PER_OUTPUT_SAMPLE = CYCLES_PER_CHIP_SAMPLE * OUTPUT_DECIMATION;
+
+	static constexpr int VOICE_COUNT = 3;
+
+	NamcoWSG();
+
+	void Reset();
+
+	// Genera 'count' campioni a 48 kHz dai registri correnti
+	void Render(const uint8_t *registers, const uint8_t *waveforms, bool enabled, int16_t *out, size_t count);
+
+	// Save state: accumulatori delle voci
+	static constexpr size_t STATE_SIZE = VOICE_COUNT * sizeof(uint32_t);
+	void SaveState(StateWriter &writer) const;
+	void LoadState(StateReader &reader);
+
+private:
+	std::array<uint32_t, VOICE_COUNT> m_accumulators;
+};
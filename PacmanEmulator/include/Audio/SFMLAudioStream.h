@@ -0,0 +1,43 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <atomic>
+#include <vector>
+#include "Audio/AudioRingBuffer.h"
+
+// Uscita audio SFML: il thread audio di SFML preleva i campioni dalla coda
+// lock-free riempita dall'emulazione. Se la coda e' vuota ripete l'ultimo
+// campione (niente click) invece di aspettare, cosi' il thread audio non
+// attende mai l'emulazione.
+// I campioni passano da un ricampionatore lineare con rapporto regolabile
+// (controllo dinamico del rate del FramePacer).
+class SFMLAudioStream : public sf::SoundStream
+{
+public:
+	SFMLAudioStream(AudioRingBuffer &ring, unsigned int sampleRate);
+
+	// Campioni letti dalla coda per campione riprodotto (1.0 = nessun ricampionamento).
+	// Chiamabile dal thread di emulazione mentre lo stream suona.
+	void SetRateRatio(double ratio) { m_rateRatio.store(ratio, std::memory_order_relaxed); }
+
+	// Campioni mancanti per coda vuota, sostituiti ripetendo l'ultimo campione
+	uint64_t GetUnderrunSamples() const { return m_underrunSamples.load(std::memory_order_relaxed); }
+
+protected:
+	bool onGetData(Chunk &data) override;
+	void onSeek(sf::Time timeOffset) override;
+
+private:
+	// ~10 ms a 48 kHz per blocco
+	static constexpr size_t CHUNK_SAMPLES = 512;
+
+	AudioRingBuffer &m_ring;
+	std::atomic<double> m_rateRatio;
+	std::atomic<uint64_t> m_underrunSamples;
+
+	// Stato del ricampionatore (solo thread audio): ultimo campione letto e fase tra questo e il successivo
+	std::vector<int16_t> m_input;
+	std::vector<int16_t> m_chunk;
+	int16_t m_lastSample;
+	double m_phase;
+};
@@ -1,6 +1,10 @@
 #pragma once
+#include <array>
 #include <cstdint>
+#include <memory>
+#include <vector>
 #include "Memory/MemoryBus.h"
+#include "Core/SaveState.h"
 
 union RegisterPair {
 	uint16_t pair;
@@ -13,11 +17,18 @@ union RegisterPair {
 static const uint8_t FLAG_C = 0x01;  // Carry
 static const uint8_t FLAG_N = 0x02;  // Add/Subtract
 static const uint8_t FLAG_PV = 0x04; // Parity/Overflow
+static const uint8_t FLAG_X = 0x08;  // Non documentato: copia del bit 3 del risultato
 static const uint8_t FLAG_H = 0x10;  // Half Carry
+static const uint8_t FLAG_Y = 0x20;  // Non documentato: copia del bit 5 del risultato
 static const uint8_t FLAG_Z = 0x40;  // Zero
 static const uint8_t FLAG_S = 0x80;  // Sign
 
+class Z80Jit;
+
 class Z80 {
+	// Il JIT genera codice che accede direttamente a registri e handler
+	friend class Z80Jit;
+
 private:
 	// Memory bus
 	MemoryBus *m_memory;
@@ -38,118 +49,132 @@ private:
 	uint64_t m_totalCycles;
 	int m_cyclesLastInstruction;
 
-	// Register mapping array
-	uint8_t *m_registerMap[8];
-	uint16_t *m_register16Map[4];
-
 	uint8_t m_interruptMode = 1;
 	bool m_interruptsEnabled;
 	bool pendingInterrupt;
 	bool m_halted = false;
 	uint8_t m_interruptVector = 0xFF; // Default vector
 
-	// Opcode table
+	// Tabelle di dispatch (senza prefisso e CB, ED, DD, FD), costruite a compile time in Z80.cpp
 	using OpcodeFunction = void (Z80::*)();
-	OpcodeFunction m_opcodeTable[256];
+	static const std::array<OpcodeFunction, 256> s_opcodeTable;
+	static const std::array<OpcodeFunction, 256> s_cbTable;
+	static const std::array<OpcodeFunction, 256> s_edTable;
+	static const std::array<OpcodeFunction, 256> s_ddTable;
+	static const std::array<OpcodeFunction, 256> s_fdTable;
+	static constexpr std::array<OpcodeFunction, 256> BuildOpcodeTable();
+	static constexpr std::array<OpcodeFunction, 256> BuildCBTable();
+	static constexpr std::array<OpcodeFunction, 256> BuildEDTable();
+	template<uint16_t Z80::*XY> static constexpr std::array<OpcodeFunction, 256> BuildIndexTable();
+
+	// DDCB/FDCB: il prefisso calcola (IX+d)/(IY+d), la tabella e' condivisa
+	using IndexedCBFunction = void (Z80::*)(uint16_t address);
+	static const std::array<IndexedCBFunction, 256> s_indexCBTable;
+	static constexpr std::array<IndexedCBFunction, 256> BuildIndexCBTable();
+
+	// Block cache (Z80BlockCache.cpp): il codice in ROM non cambia mai, quindi le
+	// sequenze lineari di istruzioni vengono decodificate una volta sola in array
+	// di handler ed eseguite senza fetch dell'opcode ne' lookup in tabella.
+	// Un blocco termina con la prima istruzione che puo' saltare, ripetersi o
+	// fermare la CPU: tutte le istruzioni precedenti hanno durata fissa, quindi
+	// la loro somma (prefixCycles) dice in anticipo se il blocco sta nel budget.
+	// Sul bus piatto (MemoryBus::EnableFlatMemory) 0x0000-0x3FFF e' RAM: Run non usa la cache.
+	struct CachedBlock {
+		uint32_t first;				// Primo handler in m_blockHandlers
+		uint32_t count;				// Istruzioni nel blocco (l'ultima e' il terminatore)
+		uint32_t prefixCycles;		// Cicli di tutte le istruzioni tranne l'ultima
+	};
 
-	void InitOpcodeTable();
+	static constexpr uint16_t BLOCK_CACHE_LIMIT = 0x4000;		// ROM CPU (0x0000-0x3FFF)
+	static constexpr size_t MAX_BLOCK_INSTRUCTIONS = 64;
+	static constexpr int32_t BLOCK_NOT_BUILT = -1;
+
+	std::vector<int32_t> m_blockIndex;			// PC di partenza -> indice in m_blocks
+	std::vector<CachedBlock> m_blocks;
+	std::vector<OpcodeFunction> m_blockHandlers;
+	std::vector<uint16_t> m_blockAddresses;		// Indirizzo di ogni istruzione (per il JIT)
+	std::vector<OpcodeFunction> m_recordedHandlers;	// Blocco in registrazione
+	std::vector<uint16_t> m_recordedAddresses;
+	bool m_blockCacheEnabled;
+
+	// Backend JIT opzionale: traduce i blocchi della cache in codice x86-64
+	std::unique_ptr<Z80Jit> m_jit;
+
+#if defined(Z80_SWITCH_DISPATCH)
+	// Core di dispatch a switch/computed goto (Z80Switch.cpp), scelto a compile
+	// time definendo Z80_SWITCH_DISPATCH. Sostituisce tabella e block cache
+	// quando il JIT non e' attivo.
+	uint64_t RunSwitch(uint64_t cycleBudget);
+#endif
 
-	// Helper per calcolo parit
-	bool CalculateParity(uint8_t value);
+	void RecordBlock(uint64_t target);
+	void ExecuteBlock(const CachedBlock &block);
+	bool EndsBlock(uint16_t address, OpcodeFunction handler) const;
 
 	// Opcodes
 	void OP_NotImplemented();
 	void OP_NOP();
 
-	// Opcodes handlers - INC
-	void OP_INC_A();
-	void OP_INC_B();
-	void OP_INC_C();
-	void OP_INC_D();
-	void OP_INC_E();
-	void OP_INC_H();
-	void OP_INC_L();
-
-	// Opcodes handlers - DEC
-	void OP_DEC_A();
-	void OP_DEC_B();
-	void OP_DEC_C();
-	void OP_DEC_D();
-	void OP_DEC_E();
-	void OP_DEC_H();
-	void OP_DEC_L();
-
-	// Opcodes handlers - LD r, n
-	void OP_LD_A_n();
-	void OP_LD_B_n();
-	void OP_LD_C_n();
-	void OP_LD_D_n();
-	void OP_LD_E_n();
-	void OP_LD_H_n();
-	void OP_LD_L_n();
-
-	// Opcodes handelers - ADD A, r
-	void OP_ADD_A_A();
-	void OP_ADD_A_B();
-	void OP_ADD_A_C();
-	void OP_ADD_A_D();
-	void OP_ADD_A_E();
-	void OP_ADD_A_H();
-	void OP_ADD_A_L();
-	void OP_ADD_A_HL();
-
-	// Opcodes handelers - SUB A, r
-	void OP_SUB_A_A();
-	void OP_SUB_A_B();
-	void OP_SUB_A_C();
-	void OP_SUB_A_D();
-	void OP_SUB_A_E();
-	void OP_SUB_A_H();
-	void OP_SUB_A_L();
-	void OP_SUB_A_HL();
-
-	//Opcode handler unico per LD r, r'
-	void OP_LD_r_r();
-
-	// Opcode handlers - AND A,r
-	void OP_AND_A_A(); 
-	void OP_AND_A_B(); 
-	void OP_AND_A_C(); 
-	void OP_AND_A_D(); 
-	void OP_AND_A_E(); 
-	void OP_AND_A_H(); 
-	void OP_AND_A_L();
-	void OP_AND_A_HL();
-
-	// Opcode handlers - XOR A,r
-	void OP_XOR_A_A();
-	void OP_XOR_A_B();
-	void OP_XOR_A_C();
-	void OP_XOR_A_D();
-	void OP_XOR_A_E();
-	void OP_XOR_A_H();
-	void OP_XOR_A_L();
-	void OP_XOR_A_HL();
-
-	// Opcode handlers - OR A,r
-	void OP_OR_A_A();
-	void OP_OR_A_B();
-	void OP_OR_A_C();
-	void OP_OR_A_D();
-	void OP_OR_A_E();
-	void OP_OR_A_H();
-	void OP_OR_A_L();
-	void OP_OR_A_HL();
-
-	// Opcode handlers - CP A,r
-	void OP_CP_A_A();
-	void OP_CP_A_B();
-	void OP_CP_A_C();
-	void OP_CP_A_D();
-	void OP_CP_A_E();
-	void OP_CP_A_H();
-	void OP_CP_A_L();
-	void OP_CP_A_HL();
+	// Handler generati da template per le famiglie con il registro codificato
+	// nell'opcode (0=B 1=C 2=D 3=E 4=H 5=L 6=(HL) 7=A)
+	template<int Index> uint8_t &Reg8();
+	template<int Index> uint16_t &Reg16();					// 0=BC 1=DE 2=HL 3=SP
+	template<int Operation> void ALU_A(uint8_t value);
+	template<int Operation> void RotateShift(uint8_t &value);
+	template<int Bit> void BIT_n(uint8_t value);
+	template<int Dst, int Src> void OP_LD_r_r();			// LD r,r' (0x76 = HALT)
+	template<int Operation, int Src> void OP_ALU_r();		// ADD ADC SUB SBC AND XOR OR CP
+	template<int Reg> void OP_INC_r();
+	template<int Reg> void OP_DEC_r();
+	template<int Reg> void OP_LD_r_n();
+	template<int Operation, int Reg> void OP_CB_Rotate();	// RLC RRC RL RR SLA SRA SLL SRL
+	template<int Bit, int Reg> void OP_CB_BIT();
+	template<int Bit, int Reg> void OP_CB_RES();
+	template<int Bit, int Reg> void OP_CB_SET();
+
+	// Prefissi DD/FD: XY e' &Z80::IX o &Z80::IY, H/L diventano XYH/XYL
+	template<uint16_t Z80::*XY, int Index> uint8_t &RegXY8();
+	template<uint16_t Z80::*XY> uint16_t IndexAddress();	// Legge d e ritorna XY+d
+	void OP_XY_Ignored();									// Prefisso seguito da un opcode senza HL
+	template<uint16_t Z80::*XY, int Dst, int Src> void OP_XY_LD_r_r();
+	template<uint16_t Z80::*XY, int Operation, int Src> void OP_XY_ALU_r();
+	template<uint16_t Z80::*XY, int Reg> void OP_XY_INC_r();
+	template<uint16_t Z80::*XY, int Reg> void OP_XY_DEC_r();
+	template<uint16_t Z80::*XY, int Reg> void OP_XY_LD_r_n();
+	template<uint16_t Z80::*XY, int Src> void OP_XY_ADD_rr();
+	template<uint16_t Z80::*XY> void OP_XY_LD_nn();
+	template<uint16_t Z80::*XY> void OP_XY_LD_pnn_XY();
+	template<uint16_t Z80::*XY> void OP_XY_LD_XY_pnn();
+	template<uint16_t Z80::*XY> void OP_XY_INC();
+	template<uint16_t Z80::*XY> void OP_XY_DEC();
+	template<uint16_t Z80::*XY> void OP_XY_PUSH();
+	template<uint16_t Z80::*XY> void OP_XY_POP();
+	template<uint16_t Z80::*XY> void OP_XY_EX_pSP();
+	template<uint16_t Z80::*XY> void OP_XY_JP();
+	template<uint16_t Z80::*XY> void OP_XY_LD_SP();
+	template<uint16_t Z80::*XY> void OP_XY_CB_Prefix();
+	template<int Operation, int Reg> void OP_XYCB_Rotate(uint16_t address);
+	template<int Bit> void OP_XYCB_BIT(uint16_t address);
+	template<int Bit, int Reg> void OP_XYCB_RES(uint16_t address);
+	template<int Bit, int Reg> void OP_XYCB_SET(uint16_t address);
+
+	// Prefisso ED
+	void OP_ED_NOP();
+	template<int Reg> void OP_ED_IN_r_C();
+	template<int Reg> void OP_ED_OUT_C_r();
+	template<int Reg> void OP_ED_SBC_HL();
+	template<int Reg> void OP_ED_ADC_HL();
+	template<int Reg> void OP_ED_LD_pnn_rr();
+	template<int Reg> void OP_ED_LD_rr_pnn();
+	template<int Mode> void OP_ED_IM();
+	void OP_ED_LD_I_A();
+	void OP_ED_LD_R_A();
+	void OP_ED_LD_A_I();
+	void OP_ED_LD_A_R();
+	void OP_ED_RRD();
+	void OP_ED_RLD();
+	template<int Step, bool Repeat> void OP_ED_BlockIn();	// INI IND INIR INDR
+	template<int Step, bool Repeat> void OP_ED_BlockOut();	// OUTI OUTD OTIR OTDR
 
 	//Opcode HALT
 	void OP_HALT();
@@ -160,6 +185,9 @@ private:
 	void OP_JP_NZ_nn();
 	void OP_JP_C_nn();
 	void OP_JP_NC_nn();
+	void OP_JP_PO_nn();
+	void OP_JP_PE_nn();
+	void OP_JP_P_nn();
 
 	// Jump relativi
 	void OP_JR_e();
@@ -174,11 +202,19 @@ private:
 	void OP_CALL_NZ_nn();
 	void OP_CALL_C_nn();
 	void OP_CALL_NC_nn();
+	void OP_CALL_PO_nn();
+	void OP_CALL_PE_nn();
+	void OP_CALL_P_nn();
+	void OP_CALL_M_nn();
 	void OP_RET();
 	void OP_RET_Z();
 	void OP_RET_NZ();
 	void OP_RET_C();
 	void OP_RET_NC();
+	void OP_RET_PO();
+	void OP_RET_PE();
+	void OP_RET_P();
+	void OP_RET_M();
 
 	// Push/Pop
 	void OP_PUSH_BC();
@@ -232,25 +268,9 @@ private:
 	void OP_LD_HL_n();
 
 	// ADC A, r
-	void OP_ADC_A_B();
-	void OP_ADC_A_C();
-	void OP_ADC_A_D();
-	void OP_ADC_A_E();
-	void OP_ADC_A_H();
-	void OP_ADC_A_L();
-	void OP_ADC_A_HL();
-	void OP_ADC_A_A(); 
 	void OP_ADC_A_n();
 
 	// SBC A, r
-	void OP_SBC_A_B();
-	void OP_SBC_A_C();
-	void OP_SBC_A_D();
-	void OP_SBC_A_E();
-	void OP_SBC_A_H();
-	void OP_SBC_A_L();
-	void OP_SBC_A_HL();
-	void OP_SBC_A_A();
 	void OP_SBC_A_n();
 
 	// LD 16bit
@@ -281,6 +301,9 @@ private:
 	void OP_RST_38();
 
 	void OP_EX_DE_HL();
+	void OP_EX_AF_AF();
+	void OP_EX_pSP_HL();
+	void OP_DAA();
 	void OP_JP_HL();
 
 	void OP_DI();
@@ -306,14 +329,11 @@ private:
 
 	void OP_RLCA();
 
-	void OP_INC_pHL();
-	void OP_DEC_pHL();
 					  
 	// Helper functions per operazioni comuni
 	void INC_r(uint8_t &reg);								// Incremento 8-bit
 	void DEC_r(uint8_t &reg);								// Decremento 8-bit
 	void LD_r_n(uint8_t &reg);								// Load immediate
-	void LD_r_r(uint8_t &dest, uint8_t src);				// Load register to register
 	void ADD_A_r(uint8_t value);							// Addizione
 	void SUB_A_r(uint8_t value);							// Sottrazione
 	void AND_A_r(uint8_t value);							// AND
@@ -330,8 +350,7 @@ private:
 	void INC_rr(uint16_t & reg);							// Inc 16 bit
 	void DEC_rr(uint16_t &reg);								// Dec 16 bit
 	void ADD_HL_rr(uint16_t reg);							// ADD 16 bit
-	void ADD_IX_rr(uint16_t reg);							// ADD 16 bit
-	void ADD_IY_rr(uint16_t reg);							// ADD 16 bit
+	void ADD_XY_rr(uint16_t &xy, uint16_t reg);				// ADD 16 bit su IX/IY
 	void INC_Memory(uint16_t address);						// Incremente valore in memoria
 	void DEC_Memory(uint16_t address);						// Decremente valore in memoria
 	void LD_A_indirect(uint16_t address);					// Load da memoria indirizzo registro
@@ -340,21 +359,13 @@ private:
 	void LD_addr_A();										// Store in memoria indirizzo istruzione
 	void ADC_A_r(uint8_t value);							// Somma con carry
 	void SBC_A_r(uint8_t value);							// Sottrazione con carry
-	void HandleRotateShift(uint8_t operation, uint8_t reg); // Rotate shift operation
-	void HandleBit(uint8_t bit_number, uint8_t reg);		// Bit operation
-	void HandleRes(uint8_t bit_number, uint8_t reg);		// Bit reset
-	void HandleSet(uint8_t bit_number, uint8_t reg);		// Bit set
-	void HandleRotateShift_pIXOffset(uint8_t operation, int8_t offset);
-	void HandleBit_pIXOffset(uint8_t operation, int8_t offset);
-	void HandleRes_pIXOffset(uint8_t operation, int8_t offset);
-	void HandleSet_pIXOffset(uint8_t operation, int8_t offset);
 	void CB_RLC(uint8_t &reg);								// Rotazione a sinistra con carry
 	void CB_RRC(uint8_t &reg);								// Rotazione a destra con carry
 	void CB_RL(uint8_t &reg);								// Rotazione a sinistra
 	void CB_RR(uint8_t &reg);								// Rotazione a destra
 	void CB_SLA(uint8_t &reg);								// Shift a sinistra aritmetico
 	void CB_SRA(uint8_t &reg);								// Shift a destra aritmetico
-	void CB_SWAP(uint8_t &reg);								// swap del nibble
+	void CB_SLL(uint8_t &reg);								// Shift a sinistra con bit 0 a 1
 	void CB_SRL(uint8_t &reg);								// Shift a destra logico
 	void SBC_HL(const uint16_t *reg);						// Sottrazione a 16 bit con carry
 	void LD_pnn_rr(const uint16_t *reg);					// Store in memoria da indirizzo opcode contenuto registro
@@ -369,20 +380,19 @@ private:
 	void CPIR();											// Compare and increment repeat
 	void CPD();												// Compare and decrement
 	void CPDR();											// Compare and decrement repeat
-	void LD_r_pIXOffset(uint8_t &reg);						// Legge da memoria a indirizzo IX+offset e mette in r
-	void LD_pIXOffset_r(const uint8_t reg);					// Scrive in memoria a indirizzo IX+offset registo r
-	void LD_pIYOffset_r(const uint8_t reg);					// Scrive in memoria a indirizzo IY+offset registo r
-	void LD_pIXOffset_n();									// Scrive in memoria a indirizzo IX+offset il valore contenuto nell'opcode
-	void LD_pIYOffset_n();									// Scrive in memoria a indirizzo IY+offset il valore contenuto nell'opcode
-	void AND_r_pIXOffset(uint8_t &reg);						// And tra r e valore in memoria a IX+offset
-	void ADD_r_pIXOffset();						// Add tra r e valore in memoria a IX+offset
+	uint8_t ReadPort(uint8_t port);							// IN
+	void WritePort(uint8_t port, uint8_t value);			// OUT
 
 	// Helper functions per stack
 	void PUSH_16bit(uint16_t value);
 	uint16_t POP_16bit();
 
+	// Fetch inline di opcode e operandi da PC (fast path della page table)
+	inline uint8_t FetchByte() { return m_memory->Read(PC++); }
+
 public:
 	Z80(MemoryBus *memory);
+	~Z80();
 	
 	void Reset();
 	void SetFlag(uint8_t flag, bool value);
@@ -394,14 +404,34 @@ public:
 
 	int Step();
 
+	// Esegue istruzioni in un loop interno finche' non sono stati consumati
+	// almeno cycleBudget cicli. Ritorna i cicli eseguiti (l'ultima istruzione
+	// puo' sforare il budget).
+	uint64_t Run(uint64_t cycleBudget);
+
+	// Block cache per il codice in ROM (attiva di default). Va invalidata se la ROM cambia.
+	void SetBlockCacheEnabled(bool enabled) { m_blockCacheEnabled = enabled; }
+	bool IsBlockCacheEnabled() const { return m_blockCacheEnabled; }
+	void InvalidateBlockCache();
+
+	// JIT x86-64 per i blocchi della cache (richiede la block cache attiva).
+	// Ritorna false se l'host non e' supportato; in quel caso resta l'interprete.
+	bool SetJitEnabled(bool enabled);
+	bool IsJitEnabled() const { return m_jit != nullptr; }
+	Z80Jit *GetJit() { return m_jit.get(); }
+
 	uint64_t GetTotalCycles() const { return m_totalCycles; }
 	void ResetCycles() { m_totalCycles = 0; }
 	bool IsHalted() const { return m_halted; }
 
 	void Interrupt();
 
-#ifdef _DEBUG
-	// Debug getters
+	// Save state: registri, shadow register, stato interrupt/HALT e cicli
+	static constexpr size_t STATE_SIZE = 43;
+	void SaveState(StateWriter &writer) const;
+	void LoadState(StateReader &reader);
+
+	// Lettura dei registri (debugger, harness di test)
 	uint16_t GetHL() const { return HL.pair; }
 	uint16_t GetDE() const { return DE.pair; }
 	uint8_t GetA() const { return A; }
@@ -414,6 +444,7 @@ public:
 	uint16_t GetSP() const { return SP; }
 	uint8_t GetR() const { return R; }
 
+#ifdef _DEBUG
 	// Debug setters
 	void SetHL(uint16_t value) { HL.pair = value; }
 	void SetDE(uint16_t value) { DE.pair = value; }
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Z80;
+
+// Backend JIT x86-64 del Z80 (opzionale, spento di default).
+// Traduce in codice macchina host i blocchi di ROM registrati dalla block cache:
+// le istruzioni semplici senza flag (NOP, LD r,r', LD r,n, LD rr,nn, INC/DEC rr,
+// JP nn) diventano istruzioni x86 sui registri del Z80 in memoria con gli
+// operandi gia' estratti dalla ROM; tutte le altre chiamano direttamente
+// l'handler dell'interprete, quindi flag e cicli restano quelli dell'interprete.
+// Su host non x86-64 IsSupported() e' false e si usa solo l'interprete.
+//
+// In modalita' di verifica differenziale ogni blocco viene eseguito dal JIT e poi
+// rieseguito dall'interprete partendo dallo stesso stato (CPU e memoria): al primo
+// stato diverso il blocco viene segnalato e da li' in poi interpretato.
+class Z80Jit
+{
+public:
+	explicit Z80Jit(Z80 &cpu);
+	~Z80Jit();
+
+	Z80Jit(const Z80Jit &) = delete;
+	Z80Jit &operator=(const Z80Jit &) = delete;
+
+	static bool IsSupported();
+
+	// Esegue il blocco 'index' della block cache (compilandolo al primo uso)
+	void Execute(uint32_t index);
+
+	// Scarta tutto il codice generato (la ROM e' cambiata)
+	void Reset();
+
+	void SetDifferentialCheck(bool enabled) { m_differentialCheck = enabled; }
+	bool IsDifferentialCheckEnabled() const { return m_differentialCheck; }
+
+	// Statistiche
+	size_t GetCompiledBlocks() const { return m_compiledBlocks; }
+	size_t GetCodeSize() const { return m_codeUsed; }
+	uint64_t GetMismatches() const { return m_mismatches; }
+
+private:
+	using BlockFunction = void (*)(Z80 *);
+
+	// Stato dei blocchi: non ancora compilato, da interpretare (arena piena o verifica fallita)
+	static constexpr uintptr_t BLOCK_PENDING = 0;
+	static constexpr uintptr_t BLOCK_INTERPRET = 1;
+
+	static constexpr size_t CODE_ARENA_SIZE = 2 * 1024 * 1024;
+
+	Z80 &m_cpu;
+	uint8_t *m_codeArena;
+	size_t m_codeUsed;
+	std::vector<uintptr_t> m_blockCode;		// Indice blocco -> BlockFunction o stato
+	size_t m_compiledBlocks;
+
+	bool m_differentialCheck;
+	uint64_t m_mismatches;
+	std::vector<uint8_t> m_stateBefore;
+	std::vector<uint8_t> m_stateJit;
+	std::vector<uint8_t> m_stateInterpreter;
+
+	// Buffer di emissione del blocco corrente
+	std::vector<uint8_t> m_emit;
+
+	uintptr_t Compile(uint32_t index);
+	void RunChecked(uint32_t index, BlockFunction code);
+	void CaptureState(std::vector<uint8_t> &buffer);
+	void RestoreState(const std::vector<uint8_t> &buffer);
+
+	// Encoder x86-64 (registro base rbx = puntatore al Z80)
+	void Emit8(uint8_t value);
+	void Emit16(uint16_t value);
+	void Emit32(uint32_t value);
+	void Emit64(uint64_t value);
+	void EmitAddPC(uint16_t delta);
+	void EmitStoreCycles(int cycles);
+	void EmitCall(const void *function);
+};
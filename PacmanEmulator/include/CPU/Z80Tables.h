@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include "CPU/Z80.h"
+
+// Tabelle dei flag precalcolate per le operazioni ALU.
+// Ogni operazione calcola F con uno o due accessi a tabella invece di
+// impostare i flag un bit alla volta.
+struct Z80FlagTables {
+	uint8_t sz[256];            // S, Z, X, Y del valore
+	uint8_t szp[256];           // S, Z, X, Y e parita' del valore
+	uint8_t inc[256];           // Flag dopo INC (indice = risultato), C escluso
+	uint8_t dec[256];           // Flag dopo DEC (indice = risultato), C escluso
+	uint8_t add[2][256][256];   // ADD/ADC: [carry][A][operando]
+	uint8_t sub[2][256][256];   // SUB/SBC/CP: [carry][A][operando]
+
+	Z80FlagTables()
+	{
+		for (int v = 0; v < 256; v++) {
+			uint8_t flags = v & (FLAG_S | FLAG_Y | FLAG_X);
+			if (v == 0) flags |= FLAG_Z;
+			sz[v] = flags;
+
+			int bits = 0;
+			for (int b = 0; b < 8; b++) bits += (v >> b) & 0x01;
+			szp[v] = flags | ((bits % 2) == 0 ? FLAG_PV : 0);
+
+			// INC: half-carry quando il nibble basso passa da 0xF a 0x0,
+			// overflow quando 0x7F diventa 0x80
+			inc[v] = flags;
+			if ((v & 0x0F) == 0x00) inc[v] |= FLAG_H;
+			if (v == 0x80) inc[v] |= FLAG_PV;
+
+			// DEC: half-borrow quando il nibble basso passa da 0x0 a 0xF,
+			// overflow quando 0x80 diventa 0x7F
+			dec[v] = flags | FLAG_N;
+			if ((v & 0x0F) == 0x0F) dec[v] |= FLAG_H;
+			if (v == 0x7F) dec[v] |= FLAG_PV;
+		}
+
+		for (int carry = 0; carry < 2; carry++) {
+			for (int a = 0; a < 256; a++) {
+				for (int value = 0; value < 256; value++) {
+					// Addizione
+					int result = a + value + carry;
+					uint8_t flags = sz[result & 0xFF];
+					if (result > 0xFF) flags |= FLAG_C;
+					if ((a & 0x0F) + (value & 0x0F) + carry > 0x0F) flags |= FLAG_H;
+					if (((a ^ result) & (value ^ result) & 0x80) != 0) flags |= FLAG_PV;
+					add[carry][a][value] = flags;
+
+					// Sottrazione
+					result = a - value - carry;
+					flags = sz[result & 0xFF] | FLAG_N;
+					if (result < 0) flags |= FLAG_C;
+					if ((a & 0x0F) - (value & 0x0F) - carry < 0) flags |= FLAG_H;
+					if (((a ^ value) & (a ^ result) & 0x80) != 0) flags |= FLAG_PV;
+					sub[carry][a][value] = flags;
+				}
+			}
+		}
+	}
+};
+
+
+extern const Z80FlagTables g_z80Flags;
+
+// Cicli T di ogni opcode senza prefisso, gli stessi che impostano gli handler.
+// Per salti, call e ret condizionali e' il costo con condizione falsa: il core
+// aggiunge la differenza quando la condizione e' vera (JR/DJNZ +5, CALL +7,
+// RET +6). I prefissi valgono 0 perche' il costo dipende dal secondo byte.
+inline constexpr uint8_t Z80_CYCLES[256] = {
+	 4, 10,  7,  6,  4,  4,  7,  4,  4, 11,  7,  6,  4,  4,  7,  4,	// 0x00
+	 8, 10,  7,  6,  4,  4,  7,  4, 12, 11,  7,  6,  4,  4,  7,  4,	// 0x10
+	 7, 10, 16,  6,  4,  4,  7,  4,  7, 11, 16,  6,  4,  4,  7,  4,	// 0x20
+	 7, 10, 13,  6, 11, 11, 12,  4,  7, 11, 10,  6,  4,  4,  7,  4,	// 0x30
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,	// 0x40
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,	// 0x50
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,	// 0x60
+	 7,  7,  7,  7,  7,  7,  4,  7,  4,  4,  4,  4,  4,  4,  7,  4,	// 0x70
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,	// 0x80
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,	// 0x90
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,	// 0xA0
+	 4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,	// 0xB0
+	 5, 10, 10, 10, 10, 11,  7, 11,  5, 10, 10,  0, 10, 17,  7, 11,	// 0xC0
+	 5, 10, 10, 11, 10, 11,  7, 11,  5,  4, 10, 11, 10,  0,  7, 11,	// 0xD0
+	 5, 10, 10, 19, 10, 11,  7, 11,  5,  4, 10,  4, 10,  0,  7, 11,	// 0xE0
+	 5, 10, 10,  4, 10, 11,  7, 11,  5,  6, 10,  4, 10,  0,  7, 11,	// 0xF0
+};
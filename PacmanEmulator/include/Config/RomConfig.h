@@ -12,4 +12,5 @@ extern const std::vector<ROMFile> cpuRoms;
 extern const std::vector<ROMFile> graphicRoms;
 extern const ROMFile graphicsPaletteFile;
 extern const ROMFile graphicsPaletteLookupFile;
+extern const ROMFile soundWaveformFile;
 
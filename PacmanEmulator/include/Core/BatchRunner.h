@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Core/Machine.h"
+
+// Osservazioni copiate dopo ogni Step (combinabili con |)
+enum ObservationFlags : uint32_t {
+    OBS_NONE = 0,
+    OBS_FRAMEBUFFER = 1 << 0,           // SCREEN_SIZE pixel RGBA per istanza
+    OBS_RAM = 1 << 1,                   // MemoryBus::RAM_SIZE byte per istanza
+    OBS_FRAMEBUFFER_INDEXED = 1 << 2    // SCREEN_SIZE indici colore (1 byte) per istanza
+};
+
+// Esegue N macchine Pac-Man indipendenti in lockstep su un pool di thread.
+// Le macchine sono allocate in un unico array contiguo e condividono la stessa
+// RomImage; le osservazioni vengono raccolte in array contigui (istanza i
+// all'offset i * dimensione osservazione).
+class BatchRunner
+{
+public:
+    // threadCount = 0: usa std::thread::hardware_concurrency()
+    BatchRunner(size_t instanceCount, unsigned int threadCount = 0,
+        uint32_t observations = OBS_FRAMEBUFFER | OBS_RAM);
+    ~BatchRunner();
+
+    // Previeni copia
+    BatchRunner(const BatchRunner &) = delete;
+    BatchRunner &operator=(const BatchRunner &) = delete;
+
+    // Carica le ROM una sola volta e le condivide con tutte le istanze
+    bool LoadRomSet(const std::string &romDir);
+
+    // Reset di tutte le istanze
+    void Reset();
+
+    // Attiva il JIT della CPU su tutte le istanze (false se l'host non lo supporta)
+    bool SetJitEnabled(bool enabled);
+
+    // Avanza tutte le istanze di 'frames' frame e aggiorna le osservazioni
+    void Step(int frames = 1);
+
+    size_t GetInstanceCount() const { return m_instanceCount; }
+    unsigned int GetThreadCount() const { return static_cast<unsigned int>(m_workers.size()) + 1; }
+    Machine &GetMachine(size_t index) { return m_machines[index]; }
+
+    // Osservazioni contigue (valide fino al prossimo Step)
+    const uint32_t *GetFrameObservations() const { return m_frameObservations.data(); }
+    const uint8_t *GetIndexedFrameObservations() const { return m_indexedFrameObservations.data(); }
+    const uint8_t *GetRamObservations() const { return m_ramObservations.data(); }
+
+private:
+    size_t m_instanceCount;
+    uint32_t m_observations;
+    std::unique_ptr<Machine[]> m_machines;
+
+    std::vector<uint32_t> m_frameObservations;
+    std::vector<uint8_t> m_indexedFrameObservations;
+    std::vector<uint8_t> m_ramObservations;
+
+    // Pool di thread: il thread chiamante lavora come worker 0
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_startCondition;
+    std::condition_variable m_doneCondition;
+    uint64_t m_generation;      // Incrementato ad ogni Step
+    unsigned int m_pending;     // Worker che non hanno ancora finito
+    int m_framesToRun;
+    bool m_shutdown;
+
+    void WorkerLoop(unsigned int workerIndex);
+    void RunSlice(unsigned int workerIndex, int frames);
+};
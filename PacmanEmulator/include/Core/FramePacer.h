@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "Audio/AudioRingBuffer.h"
+
+// Sorgente del clock che scandisce i frame in modalita' interattiva
+enum class PacingMode {
+    AUDIO,  // Il consumo del dispositivo audio fa da clock: il periodo dei frame segue la coda
+    VSYNC,  // Present() blocca sul refresh del display, l'audio si adegua col ricampionamento
+    TIMER   // Clock di sistema, l'audio si adegua col ricampionamento (anche senza audio)
+};
+
+// Statistiche sulla durata dei frame misurata tra due EndFrame consecutivi
+struct FramePacerStats {
+    uint64_t frames = 0;
+    double meanFrameMs = 0.0;
+    double jitterMs = 0.0;          // Deviazione standard della durata dei frame
+    double minFrameMs = 0.0;
+    double maxFrameMs = 0.0;
+    uint64_t lateFrames = 0;        // Frame durati piu' di 1.5 periodi
+    double meanRateRatio = 1.0;     // Rapporto medio di ricampionamento applicato all'audio
+    double meanPeriodScale = 1.0;   // Correzione media del periodo dei frame (modalita' AUDIO)
+};
+
+// Regola il ritmo del game loop sul clock scelto. Lo scarto del riempimento della
+// coda audio dal livello obiettivo corregge il clock che non e' il master:
+// - AUDIO: allunga o accorcia il periodo dei frame, l'audio non viene ricampionato;
+// - VSYNC e TIMER: cambia il rapporto di ricampionamento (campioni letti per
+//   campione riprodotto) intorno al rapporto nominale.
+// La correzione dinamica e' limitata a +-0.5%: abbastanza per assorbire la deriva
+// tra i clock, non udibile come variazione di intonazione o di velocita'.
+// Attendere direttamente la coda darebbe frame irregolari: il dispositivo la
+// svuota a blocchi di ~10 ms, non in modo continuo.
+class FramePacer
+{
+public:
+    static constexpr double MAX_RATE_ADJUST = 0.005;
+
+    FramePacer(PacingMode mode, double frameRate);
+
+    // Coda da cui l'uscita audio legge; targetFill in campioni.
+    // Senza coda la modalita' AUDIO si comporta come TIMER.
+    void SetAudioSource(const AudioRingBuffer *ring, size_t targetFill, size_t samplesPerFrame);
+
+    // Riparte da zero con le scadenze (dopo una pausa), le statistiche restano
+    void Reset();
+
+    // Da chiamare dopo Present(): attende secondo la modalita' e aggiorna statistiche e rapporto
+    void EndFrame();
+
+    PacingMode GetMode() const { return m_mode; }
+    double GetRateRatio() const { return m_rateRatio; }
+    FramePacerStats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    PacingMode m_mode;
+    double m_frameRate;
+    Clock::duration m_period;
+
+    const AudioRingBuffer *m_ring;
+    size_t m_targetFill;
+    size_t m_samplesPerFrame;
+
+    bool m_started;
+    Clock::time_point m_lastFrameEnd;
+    Clock::time_point m_nextDeadline;
+
+    // Medie esponenziali: refresh misurato (VSYNC) e riempimento della coda
+    double m_averageIntervalSeconds;
+    double m_averageFill;
+    double m_rateRatio;
+    double m_periodScale;
+
+    // Statistiche (Welford per media e varianza della durata dei frame)
+    uint64_t m_frames;
+    double m_meanMs;
+    double m_m2;
+    double m_minMs;
+    double m_maxMs;
+    uint64_t m_lateFrames;
+    double m_rateRatioSum;
+    double m_periodScaleSum;
+
+    void WaitForDeadline();
+    void UpdateClockAdjust(double intervalSeconds);
+    void RecordFrame(double intervalSeconds);
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "Audio/AudioRingBuffer.h"
+#include "Audio/NamcoWSG.h"
+#include "CPU/Z80.h"
+#include "Core/Scheduler.h"
+#include "Memory/MemoryBus.h"
+#include "Video/VideoController.h"
+
+// Una singola macchina Pac-Man senza finestra: memoria, CPU e video.
+// I componenti sono membri diretti (nessuna allocazione separata) cosi'
+// piu' macchine possono vivere in un unico blocco contiguo di memoria.
+class Machine
+{
+public:
+    Machine();
+
+    // Previeni copia (Z80 e VideoController puntano alla memoria interna)
+    Machine(const Machine &) = delete;
+    Machine &operator=(const Machine &) = delete;
+
+    // Carica le ROM di Pac-Man dalla directory indicata
+    bool LoadRomSet(const std::string &romDir);
+
+    // Usa i dati ROM di un'altra istanza invece di una copia propria
+    void ShareRomImage(std::shared_ptr<RomImage> image);
+
+    // Reset di CPU e RAM (le ROM restano caricate)
+    void Reset();
+
+    // Esegue un frame completo: 288 scanline + interrupt VBLANK, guidati dallo scheduler.
+    // Con renderVideo = false la CPU gira ma il framebuffer non viene aggiornato.
+    void RunFrame(bool renderVideo = true);
+
+    // Destinazione dei campioni audio (48 kHz mono). Il suono viene sintetizzato
+    // comunque, cosi' lo stato e' identico con o senza uscita; nullptr = nessuna uscita.
+    void SetAudioOutput(AudioRingBuffer *output) { m_audioOutput = output; }
+
+    // Campioni audio dell'ultimo RunFrame (48 kHz mono, ~792 per frame), validi
+    // fino al frame successivo. Alternativa alla coda per chi consuma a frame.
+    std::span<const int16_t> GetAudio() const { return { m_frameAudio, m_frameAudioCount }; }
+
+    // Save state a layout fisso (header + scheduler + CPU + memoria, ROM escluse).
+    // SaveState sovrascrive il buffer: riusandolo non ci sono allocazioni.
+    // LoadState rifiuta blob di dimensione, magic o versione diversi senza toccare lo stato.
+    static constexpr size_t STATE_HEADER_SIZE = 8;
+    static constexpr size_t STATE_SIZE = STATE_HEADER_SIZE + Scheduler::STATE_SIZE + 8
+        + Z80::STATE_SIZE + MemoryBus::STATE_SIZE + NamcoWSG::STATE_SIZE + 8;
+    void SaveState(std::vector<uint8_t> &buffer) const;
+    bool LoadState(const uint8_t *data, size_t size);
+
+    // Input per i prossimi frame (IN0, IN1, DIP switch)
+    void SetInputs(const InputState &inputs) { m_memory.SetInputs(inputs); }
+    InputState GetInputs() const { return m_memory.GetInputs(); }
+
+    // Hash FNV-1a della RAM di lavoro (verifica dei replay) e della ROM CPU
+    uint32_t GetRamHash() const;
+    uint64_t GetRomHash() const;
+
+    MemoryBus &GetMemory() { return m_memory; }
+    Z80 *GetCPU() { return &m_cpu; }
+    VideoController &GetVideo() { return m_videoController; }
+    const uint32_t *GetFrameBuffer() const { return m_videoController.GetFrameBuffer(); }
+    const uint8_t *GetIndexedFrameBuffer() const { return m_videoController.GetIndexedFrameBuffer(); }
+
+    // Timing: 3.072 MHz / (176 * 288) = 60.61 Hz, come l'hardware reale
+    static constexpr int Z80_FREQUENCY = 3072000;  // 3.072 MHz
+    static constexpr int CYCLES_PER_SCANLINE = 176;
+    static constexpr int TOTAL_SCANLINES = 288;
+    static constexpr int CYCLES_PER_FRAME = CYCLES_PER_SCANLINE * TOTAL_SCANLINES;
+    static constexpr double FRAME_RATE = static_cast<double>(Z80_FREQUENCY) / CYCLES_PER_FRAME;
+    static constexpr int WATCHDOG_FRAMES = 16;     // Frame senza scritture a 0x50C0 prima del reset
+
+private:
+    MemoryBus m_memory;
+    Z80 m_cpu;
+    VideoController m_videoController;
+
+    // Eventi di frame (scanline, VBLANK, watchdog) sulla timeline dei cicli CPU
+    Scheduler m_scheduler;
+    int m_scanline;
+    int m_watchdogFrames;
+
+    // Audio: il WSG viene fatto avanzare fino al ciclo corrente a ogni scanline
+    NamcoWSG m_soundGenerator;
+    AudioRingBuffer *m_audioOutput;
+    uint64_t m_audioCycle;
+    static constexpr size_t AUDIO_SCRATCH_SAMPLES = 64;
+    int16_t m_audioScratch[AUDIO_SCRATCH_SAMPLES];
+
+    // Campioni del frame corrente (margine per frame non allineati al campione)
+    static constexpr size_t AUDIO_FRAME_SAMPLES = CYCLES_PER_FRAME / NamcoWSG::CYCLES_PER_OUTPUT_SAMPLE + 1;
+    int16_t m_frameAudio[AUDIO_FRAME_SAMPLES];
+    size_t m_frameAudioCount;
+
+    void ScheduleFirstFrame();
+    void GenerateAudio(uint64_t upToCycle);
+};
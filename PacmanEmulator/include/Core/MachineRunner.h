@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "Core/Machine.h"
+#include "Core/Movie.h"
+
+// Condizioni di stop per la modalita' headless (0 = nessun limite)
+struct HeadlessOptions {
+    uint64_t maxFrames = 0;
+    double maxSeconds = 0.0;
+};
+
+// Statistiche di esecuzione della modalita' headless
+struct HeadlessStats {
+    uint64_t frames = 0;
+    double elapsedSeconds = 0.0;
+    double framesPerSecond = 0.0;   // Frame emulati al secondo
+    double speedFactor = 0.0;       // Rapporto rispetto al tempo reale (Machine::FRAME_RATE, ~60.61 Hz)
+    uint64_t desyncFrames = 0;      // Frame di replay con hash della RAM diverso dal movie
+};
+
+// Esecuzione a frame di una Machine con registrazione e replay dei movie.
+// Non dipende da finestre o audio: la usano sia i frontend (con gli input
+// della tastiera) sia i runner headless (input nulli o dal movie).
+class MachineRunner
+{
+public:
+    explicit MachineRunner(Machine &machine);
+
+    // Previeni copia
+    MachineRunner(const MachineRunner &) = delete;
+    MachineRunner &operator=(const MachineRunner &) = delete;
+
+    // Registra gli input di ogni frame in un movie
+    bool StartRecording(const std::string &path);
+
+    // Rigioca un movie (input dal file invece che dal frontend) verificando
+    // l'hash della RAM frame per frame
+    bool StartReplay(const std::string &path);
+
+    bool IsMovieActive() const { return m_movieRecorder.IsOpen() || m_moviePlayer; }
+
+    // Esegue un frame: in replay gli input vengono dal movie, altrimenti da liveInputs.
+    // false a fine movie (nessun frame eseguito).
+    bool EmulateFrame(const InputState &liveInputs);
+
+    // Loop senza limite di framerate con input nulli (o dal movie)
+    HeadlessStats RunHeadless(const HeadlessOptions &options);
+
+    uint64_t GetDesyncFrames() const { return m_desyncFrames; }
+    Machine &GetMachine() { return m_machine; }
+
+private:
+    Machine &m_machine;
+
+    MovieRecorder m_movieRecorder;
+    std::unique_ptr<MoviePlayer> m_moviePlayer;
+    uint64_t m_desyncFrames;
+};
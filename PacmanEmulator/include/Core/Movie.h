@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Memory/InputState.h"
+
+// File "movie": gli input di ogni frame a partire dal reset, per rigiocare una
+// sessione in modo deterministico.
+//
+// Layout (little-endian):
+//   header  : magic "PMOV" (u32), versione (u32), hash della ROM CPU (u64)
+//   frame   : IN0 (u8), IN1 (u8), DSW1 (u8), hash della RAM a fine frame (u32)
+//
+// I frame hanno dimensione fissa e vengono solo aggiunti in coda: un file
+// troncato (es. crash durante la registrazione) resta leggibile fino
+// all'ultimo frame completo.
+static constexpr uint32_t MOVIE_MAGIC = 0x564F4D50;	// "PMOV"
+static constexpr uint32_t MOVIE_VERSION = 1;
+static constexpr size_t MOVIE_HEADER_SIZE = 16;
+static constexpr size_t MOVIE_FRAME_SIZE = 7;
+
+struct MovieFrame {
+    InputState inputs;
+    uint32_t ramHash = 0;
+};
+
+class MovieRecorder
+{
+public:
+    MovieRecorder() = default;
+    ~MovieRecorder();
+
+    // Crea il file e scrive l'header
+    bool Open(const std::string &path, uint64_t romHash);
+
+    // Aggiunge un frame (input usati e hash della RAM risultante)
+    void RecordFrame(const MovieFrame &frame);
+
+    void Close();
+    bool IsOpen() const { return m_file.is_open(); }
+    uint64_t GetFrameCount() const { return m_frameCount; }
+
+private:
+    std::ofstream m_file;
+    uint64_t m_frameCount = 0;
+};
+
+class MoviePlayer
+{
+public:
+    // Carica tutto il file in memoria: la riproduzione non fa I/O
+    bool Open(const std::string &path);
+
+    // Prossimo frame registrato; false a fine movie
+    bool NextFrame(MovieFrame &frame);
+
+    uint64_t GetRomHash() const { return m_romHash; }
+    size_t GetFrameCount() const { return m_frames.size(); }
+    size_t GetPosition() const { return m_position; }
+
+private:
+    std::vector<MovieFrame> m_frames;
+    size_t m_position = 0;
+    uint64_t m_romHash = 0;
+};
@@ -1,17 +1,21 @@
 ﻿#pragma once
 
-#include <SFML/Graphics.hpp>
 #include <CPU/Z80.h>
 #include <memory>
 #include <string>
-#include "Video/VideoController.h"
-#include "Video/SFMLBackend.h"
+#include "Core/Machine.h"
+#include "Core/MachineRunner.h"
+#include "Core/RewindBuffer.h"
+#include "Core/FramePacer.h"
+#include "Audio/AudioRingBuffer.h"
+#include "Video/RenderBackend.h"
 
 class MemoryBus;
-// // Forward declarations (le useremo dopo)
-// class Z80;
-// class VideoController;
+class SFMLAudioStream;
 
+// Frontend interattivo: finestra, tastiera e audio sopra la Machine.
+// SFML resta confinata nei backend (SFMLBackend, SFMLAudioStream) creati in
+// Initialize; per l'esecuzione senza finestra si usa MachineRunner direttamente.
 class PacmanEmulator
 {
 public:
@@ -22,7 +26,7 @@ public:
     PacmanEmulator(const PacmanEmulator &) = delete;
     PacmanEmulator &operator=(const PacmanEmulator &) = delete;
 
-    // Inizializza l'emulatore
+    // Inizializza l'emulatore (finestra, audio, ritmo dei frame)
     bool Initialize();
 
     // Carica le ROM di Pac-Man
@@ -34,26 +38,45 @@ public:
     // Reset dell'emulatore
     void Reset();
 
-    MemoryBus &GetMemory() const { return *m_memory; }
-    Z80 *GetCPU() { return m_cpu.get(); }
+    // Clock del game loop (da impostare prima di Initialize, default AUDIO)
+    void SetPacingMode(PacingMode mode) { m_pacingMode = mode; }
+
+    // Registra gli input di ogni frame in un movie
+    bool StartRecording(const std::string &path);
+
+    // Rigioca un movie (input dal file invece che dalla tastiera) verificando
+    // l'hash della RAM frame per frame. L'esecuzione termina a fine movie.
+    bool StartReplay(const std::string &path);
+
+    MemoryBus &GetMemory() const { return m_machine->GetMemory(); }
+    Z80 *GetCPU() { return m_machine->GetCPU(); }
 
 private:
-    std::unique_ptr<MemoryBus> m_memory;
-    // Componenti dell'emulatore (commentiamo per ora, li aggiungeremo dopo)
-    std::unique_ptr<Z80> m_cpu;
-    std::unique_ptr<VideoController> m_videoController;
+    // Componenti dell'emulatore (memoria, CPU, video)
+    std::unique_ptr<Machine> m_machine;
+
+    // Storico per il rewind (Backspace tenuto premuto)
+    std::unique_ptr<RewindBuffer> m_rewindBuffer;
+    static constexpr size_t REWIND_SECONDS = 600;
 
-    // SFML
-    std::unique_ptr<sf::RenderWindow> m_window;
+    // Esecuzione dei frame e movie (registrazione e riproduzione degli input)
+    std::unique_ptr<MachineRunner> m_runner;
 
-    // Render backend
+    // Audio: la macchina riempie la coda, lo stream SFML la svuota dal suo thread
+    std::unique_ptr<AudioRingBuffer> m_audioRing;
+    std::unique_ptr<SFMLAudioStream> m_audioStream;
+    static constexpr size_t AUDIO_RING_SAMPLES = 8192;    // ~170 ms a 48 kHz
+    static constexpr size_t AUDIO_TARGET_FILL = 1600;     // ~33 ms di latenza in coda
+
+    // Ritmo dei frame e statistiche di jitter
+    PacingMode m_pacingMode;
+    std::unique_ptr<FramePacer> m_framePacer;
+
+    // Render backend (finestra, eventi e tastiera)
     std::unique_ptr<RenderBackend> m_renderBackend;
 
-    // Timing
-    static constexpr int Z80_FREQUENCY = 3072000;  // 3.072 MHz
-    static constexpr int CYCLES_PER_FRAME = Z80_FREQUENCY / 60;  // ~51.200
-    static constexpr int CYCLES_PER_SCANLINE = 224;
-    static constexpr int TOTAL_SCANLINES = 288;
+    // Timing (i parametri della macchina sono in Machine)
+    static constexpr double TARGET_FPS = Machine::FRAME_RATE;
 
     // Stato
     bool m_isRunning;
@@ -61,9 +84,5 @@ private:
 
     // Metodi privati
     void ProcessInput();
-    void Update(float deltaTime);
-    void Render();
-
-    // Debug
-    void DrawDebugInfo();
+    InputState ReadKeyboardInputs() const;
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Core/Machine.h"
+
+// Storico degli stati della macchina, uno per frame, per tornare indietro nel tempo.
+// Gli stati sono raggruppati in segmenti: il primo stato di ogni segmento e' un
+// keyframe, gli altri sono salvati come XOR rispetto al frame precedente e compressi
+// con un RLE sugli zeri (tra due frame cambiano poche decine di byte, rispetto a un
+// keyframe di un secondo prima alcune centinaia). Ripristinare un frame costa al piu'
+// un keyframe e keyframeInterval - 1 delta da applicare, poi un LoadState.
+class RewindBuffer
+{
+public:
+    // capacityFrames: frame di storico (i segmenti piu' vecchi vengono scartati interi)
+    // keyframeInterval: frame per segmento
+    RewindBuffer(size_t capacityFrames, size_t keyframeInterval = 60);
+
+    // Cattura lo stato corrente (da chiamare una volta per frame)
+    void Push(const Machine &machine);
+
+    // Torna indietro di 'frames' frame rispetto all'ultimo catturato: ripristina quello
+    // stato nella macchina e scarta tutti quelli successivi. Con 0 ripristina l'ultimo.
+    bool Rewind(Machine &machine, size_t frames);
+
+    void Clear();
+
+    size_t GetFrameCount() const { return m_frameCount; }
+    size_t GetMemoryUsage() const;
+
+private:
+    struct Segment {
+        std::vector<uint8_t> keyframe;              // Compresso rispetto a uno stato nullo
+        std::vector<std::vector<uint8_t>> deltas;   // Ognuno compresso rispetto allo stato precedente
+        size_t deltaCount = 0;                      // Delta validi (i buffer oltre vengono riusati)
+    };
+
+    size_t m_keyframeInterval;
+    std::vector<Segment> m_segments;    // Ring di segmenti
+    size_t m_firstSegment;              // Segmento piu' vecchio
+    size_t m_segmentCount;              // Segmenti in uso
+    size_t m_frameCount;
+
+    // Buffer di lavoro riusati tra una chiamata e l'altra
+    std::vector<uint8_t> m_state;
+    std::vector<uint8_t> m_lastState;       // Ultimo stato catturato, decompresso
+    std::vector<uint8_t> m_encoded;
+
+    Segment &GetSegment(size_t index) { return m_segments[(m_firstSegment + index) % m_segments.size()]; }
+
+    // Il riferimento vuoto equivale a uno stato tutto a zero (keyframe)
+    static void Encode(const std::vector<uint8_t> &state, const std::vector<uint8_t> &reference, std::vector<uint8_t> &out);
+    static bool Apply(const std::vector<uint8_t> &encoded, std::vector<uint8_t> &state);
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Formato binario dei save state: layout fisso, little-endian, nessun padding.
+// Ogni componente scrive i propri campi sempre nello stesso ordine; qualsiasi
+// modifica al layout richiede di incrementare SAVE_STATE_VERSION.
+static constexpr uint32_t SAVE_STATE_MAGIC = 0x54534D50;	// "PMST"
+static constexpr uint32_t SAVE_STATE_VERSION = 2;	// 2: registri e stato del suono
+
+// Scrive i campi in coda al buffer (il buffer puo' essere riusato tra un
+// salvataggio e l'altro: dopo il primo non ci sono piu' allocazioni)
+class StateWriter
+{
+public:
+	explicit StateWriter(std::vector<uint8_t> &buffer) : m_buffer(buffer) {}
+
+	void Write8(uint8_t value) { m_buffer.push_back(value); }
+	void WriteBool(bool value) { Write8(value ? 1 : 0); }
+	void Write16(uint16_t value) { Write8(value & 0xFF); Write8(value >> 8); }
+	void Write32(uint32_t value) { Write16(value & 0xFFFF); Write16(value >> 16); }
+	void Write64(uint64_t value) { Write32(value & 0xFFFFFFFF); Write32(value >> 32); }
+
+	void WriteBytes(const uint8_t *data, size_t size)
+	{
+		m_buffer.insert(m_buffer.end(), data, data + size);
+	}
+
+private:
+	std::vector<uint8_t> &m_buffer;
+};
+
+// Legge i campi in sequenza. Una lettura oltre la fine non esce dal buffer:
+// ritorna 0 e segna il reader come fallito.
+class StateReader
+{
+public:
+	StateReader(const uint8_t *data, size_t size) : m_data(data), m_size(size), m_pos(0), m_failed(false) {}
+
+	uint8_t Read8()
+	{
+		if (m_pos >= m_size) {
+			m_failed = true;
+			return 0;
+		}
+		return m_data[m_pos++];
+	}
+	bool ReadBool() { return Read8() != 0; }
+	uint16_t Read16() { uint16_t low = Read8(); return low | (Read8() << 8); }
+	uint32_t Read32() { uint32_t low = Read16(); return low | (static_cast<uint32_t>(Read16()) << 16); }
+	uint64_t Read64() { uint64_t low = Read32(); return low | (static_cast<uint64_t>(Read32()) << 32); }
+
+	void ReadBytes(uint8_t *dest, size_t size)
+	{
+		if (m_size - m_pos < size) {
+			m_failed = true;
+			return;
+		}
+		std::memcpy(dest, m_data + m_pos, size);
+		m_pos += size;
+	}
+
+	bool Failed() const { return m_failed; }
+	size_t Remaining() const { return m_size - m_pos; }
+
+private:
+	const uint8_t *m_data;
+	size_t m_size;
+	size_t m_pos;
+	bool m_failed;
+};
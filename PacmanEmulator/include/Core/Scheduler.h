@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "Core/SaveState.h"
+
+// Scheduler a eventi per il loop di frame: ogni tipo di evento ha al piu'
+// una scadenza, espressa in cicli assoluti della CPU (Z80::GetTotalCycles).
+// La CPU gira senza interruzioni fino alla scadenza piu' vicina.
+class Scheduler
+{
+public:
+    // A parita' di scadenza gli eventi vengono serviti in quest'ordine
+    enum class EventType {
+        SCANLINE,   // Fine di una scanline: rendering della riga
+        VBLANK,     // Fine del frame: sprite e interrupt
+        WATCHDOG,   // Controllo del watchdog (una volta per frame)
+        NONE
+    };
+
+    static constexpr uint64_t NEVER = UINT64_MAX;
+
+    Scheduler();
+
+    // Rimuove tutti gli eventi
+    void Reset();
+
+    void Schedule(EventType type, uint64_t cycle);
+    void Cancel(EventType type);
+
+    // Scadenza piu' vicina tra tutti gli eventi (NEVER se non ce ne sono)
+    uint64_t GetNextDeadline() const { return m_nextDeadline; }
+
+    // Estrae il prossimo evento scaduto al ciclo 'now' (NONE se non ce ne sono).
+    // In 'deadline' restituisce la scadenza originale, per ripianificare senza deriva.
+    EventType PopDueEvent(uint64_t now, uint64_t &deadline);
+
+    // Save state: le scadenze di tutti gli eventi
+    void SaveState(StateWriter &writer) const;
+    void LoadState(StateReader &reader);
+
+private:
+    static constexpr int EVENT_COUNT = static_cast<int>(EventType::NONE);
+
+public:
+    static constexpr size_t STATE_SIZE = EVENT_COUNT * sizeof(uint64_t);
+
+private:
+    std::array<uint64_t, EVENT_COUNT> m_deadlines;
+    uint64_t m_nextDeadline;
+
+    void UpdateNextDeadline();
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+// Valori delle porte di input di Pac-Man (tutti i bit sono attivi bassi:
+// 0 = premuto). Letti dalla CPU a 0x5000 (IN0), 0x5040 (IN1) e 0x5080 (DSW1).
+struct InputState {
+	uint8_t in0 = 0xFF;
+	uint8_t in1 = 0xFF;
+	uint8_t dipSwitches = 0xC9;	// 1 moneta = 1 credito, 3 vite, bonus a 10000, difficolta' normale
+};
+
+// IN0: joystick giocatore 1, gettoniera e servizio
+static constexpr uint8_t IN0_UP = 0x01;
+static constexpr uint8_t IN0_LEFT = 0x02;
+static constexpr uint8_t IN0_RIGHT = 0x04;
+static constexpr uint8_t IN0_DOWN = 0x08;
+static constexpr uint8_t IN0_RACK_TEST = 0x10;
+static constexpr uint8_t IN0_COIN1 = 0x20;
+static constexpr uint8_t IN0_COIN2 = 0x40;
+static constexpr uint8_t IN0_SERVICE = 0x80;
+
+// IN1: joystick giocatore 2 (cocktail), test e pulsanti di start
+static constexpr uint8_t IN1_UP = 0x01;
+static constexpr uint8_t IN1_LEFT = 0x02;
+static constexpr uint8_t IN1_RIGHT = 0x04;
+static constexpr uint8_t IN1_DOWN = 0x08;
+static constexpr uint8_t IN1_TEST = 0x10;
+static constexpr uint8_t IN1_START1 = 0x20;
+static constexpr uint8_t IN1_START2 = 0x40;
+static constexpr uint8_t IN1_CABINET = 0x80;	// 1 = cabinato verticale
@@ -3,18 +3,20 @@
 #include<string>
 #include<vector>
 #include<array>
+#include<memory>
+#include<bitset>
 #include "Config/RomConfig.h"
+#include "Memory/RomImage.h"
+#include "Memory/InputState.h"
+#include "Core/SaveState.h"
 
 class MemoryBus {
 private:
-	std::array<uint8_t, 0X4000> m_rom;		// Rom
+	std::shared_ptr<RomImage> m_romImage;	// Rom, tile e palette (condivisibili)
 	std::array<uint8_t, 0X400> m_VRam;		// Video Ram
 	std::array<uint8_t, 0X400> m_CRam;		// Color Ram
 	std::array<uint8_t, 0X0800> m_ram;		// Ram
 	std::array<uint8_t, 0X100> m_SRam;		// Sprite ram
-	std::array<uint8_t, 0x2000> m_graphicsTiles;
-	std::array<uint8_t, 0x100> m_graphicsPalette;
-	std::array<uint8_t, 0x100> m_paletteLookup;
 
 	// I/O Ports
 	uint8_t m_in0 = 0xFF;        // Joystick P1, coin, etc.
@@ -22,31 +24,118 @@ private:
 	uint8_t m_dipSwitches = 0xC9; // DIP switches config
 
 	bool m_irqEnabled = false;
+	bool m_watchdogKicked = false;	// Scrittura a 0x50C0 dall'ultimo controllo
+
+	// Sound: registri del generatore Namco (0x5040-0x505F, solo 4 bit) e abilitazione (0x5001)
+	std::array<uint8_t, 0x20> m_soundRegs;
+	bool m_soundEnabled = false;
+
+	// Dirty tracking di Video RAM e Color RAM: un bit per offset (0x000-0x3FF),
+	// tile e colore della stessa cella condividono l'offset
+	std::bitset<0x400> m_tileDirty;
 
 	// Sprite data (la VERA sprite RAM)
 	std::array<uint8_t, 16> m_spriteCoords;   // 0x5060-0x506F
 	std::array<uint8_t, 16> m_spriteAttribs;  // 0x5060-0x506F (different view)
 
+	// Page table: 256 pagine da 256 byte che puntano direttamente agli array.
+	// nullptr = la pagina passa dal gestore lento (I/O, ROM in scrittura, non mappata)
+	static constexpr int PAGE_SHIFT = 8;
+	static constexpr int PAGE_COUNT = 0x10000 >> PAGE_SHIFT;
+	std::array<const uint8_t *, PAGE_COUNT> m_readPages;
+	std::array<uint8_t *, PAGE_COUNT> m_writePages;
+
+	// Modalita' flat: 64 KB di RAM lineare al posto della mappa di Pac-Man
+	std::vector<uint8_t> m_flatMemory;
+
+	void BuildPageTable();
+	uint8_t ReadSlow(uint16_t address);
+	void WriteSlow(uint16_t address, uint8_t value);
+
 public:
 	enum class ROMType {
 		CPU,
 		GRAPHICS_TILES,
 		GRAPHICS_PALETTE,
-		PALETTE_LOOKUP
+		PALETTE_LOOKUP,
+		SOUND_WAVEFORMS
 	};
 
 	MemoryBus();
 	~MemoryBus();
 
-	uint8_t Read(uint16_t address);
-	void Write(uint16_t address, uint8_t value);
+	// La page table punta agli array interni: niente copie
+	MemoryBus(const MemoryBus &) = delete;
+	MemoryBus &operator=(const MemoryBus &) = delete;
+
+	// Fast path inline: un accesso alla page table e uno all'array
+	inline uint8_t Read(uint16_t address)
+	{
+		const uint8_t *page = m_readPages[address >> PAGE_SHIFT];
+		if (page) return page[address & 0xFF];
+		return ReadSlow(address);
+	}
+
+	inline void Write(uint16_t address, uint8_t value)
+	{
+		uint8_t *page = m_writePages[address >> PAGE_SHIFT];
+		if (page) {
+			page[address & 0xFF] = value;
+			return;
+		}
+		WriteSlow(address, value);
+	}
+
 	void Initialize();
+
+	// Sostituisce la mappa di Pac-Man con 64 KB di RAM lineare, tutta sul fast
+	// path (harness CP/M e test della CPU). ROM, I/O e video non sono piu' visibili.
+	void EnableFlatMemory();
+	bool IsFlatMemory() const { return !m_flatMemory.empty(); }
 	size_t LoadRom(const std::string &filename, ROMType type, size_t offset = 0);
+
+	// Condivisione dei dati ROM tra istanze: nessuna copia, solo un riferimento
+	std::shared_ptr<RomImage> GetRomImage() const { return m_romImage; }
+	void ShareRomImage(std::shared_ptr<RomImage> image);
+	uint32_t GetGraphicsVersion() const { return m_romImage->graphicsVersion; }
+
+	// Getter per snapshot della RAM di lavoro (0x4800-0x4FFF)
+	const uint8_t *GetRam() const { return m_ram.data(); }
+	static constexpr size_t RAM_SIZE = 0x0800;
 	
 	// Getter per VideoController
 	const uint8_t *GetGraphicsTiles() const;
 	const uint8_t *GetGraphicsPalette() const;
 	const uint8_t *GetGraphicsPaletteLookup() const;
 
+	// Getter per il generatore di suono
+	const uint8_t *GetSoundWaveforms() const { return m_romImage->soundWaveforms.data(); }
+	const uint8_t *GetSoundRegisters() const { return m_soundRegs.data(); }
+	bool IsSoundEnabled() const { return m_soundEnabled; }
+
 	bool IsIrqEnabled() const { return m_irqEnabled; }
+
+	// Porte di input (IN0, IN1, DIP switch)
+	void SetInputs(const InputState &inputs);
+	InputState GetInputs() const { return { m_in0, m_in1, m_dipSwitches }; }
+
+	// Ritorna true se il watchdog e' stato resettato dall'ultima chiamata
+	bool ConsumeWatchdogKick()
+	{
+		bool kicked = m_watchdogKicked;
+		m_watchdogKicked = false;
+		return kicked;
+	}
+
+	// Save state: RAM, VRAM, Color RAM, registri sprite e latch di I/O (le ROM no)
+	static constexpr size_t STATE_SIZE = 0x400 + 0x400 + 0x800 + 0x100 + 16 + 16 + 0x20 + 6;
+	void SaveState(StateWriter &writer) const;
+	void LoadState(StateReader &reader);
+
+	// Celle della tilemap modificate dall'ultimo rendering (offset VRAM 0x000-0x3FF)
+	bool IsTileDirty(uint16_t offset) const { return m_tileDirty[offset]; }
+	void ClearTileDirty(uint16_t offset) { m_tileDirty.reset(offset); }
+	void MarkAllTilesDirty() { m_tileDirty.set(); }
+	const std::bitset<0x400> &GetTileDirty() const { return m_tileDirty; }
+	void SetTileDirty(const std::bitset<0x400> &dirty) { m_tileDirty = dirty; }
 };
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+#include<cstdint>
+#include<array>
+
+// Dati read-only caricati da MemoryBus::LoadRom.
+// Sono separati dal resto della memoria per poter essere condivisi
+// tra piu' istanze dell'emulatore (vedi BatchRunner).
+struct RomImage {
+	std::array<uint8_t, 0X4000> rom{};				// Rom CPU
+	std::array<uint8_t, 0x2000> graphicsTiles{};
+	std::array<uint8_t, 0x100> graphicsPalette{};
+	std::array<uint8_t, 0x100> paletteLookup{};
+	std::array<uint8_t, 0x100> soundWaveforms{};	// PROM 82s126.1m: 8 forme d'onda da 32 campioni
+
+	// Incrementato ad ogni caricamento di tile o palette: chi mantiene
+	// dati derivati (es. TileAtlas) lo usa per capire quando ricostruirli
+	uint32_t graphicsVersion = 0;
+};
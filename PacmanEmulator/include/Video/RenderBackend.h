@@ -5,7 +5,22 @@ enum class KeyCode {
 	UP, DOWN, LEFT, RIGHT,
 	SPACE, ENTER,
 	P, // Pause
-	ESC // Quit
+	ESC, // Quit
+	R, // Reset
+	C, // Moneta
+	NUM1, NUM2, // Start 1P/2P
+	BACKSPACE, // Rewind
+	UNKNOWN
+};
+
+/// Evento della finestra consegnato al frontend
+struct BackendEvent {
+	enum class Type {
+		CLOSED,		// Richiesta di chiusura della finestra
+		KEY_PRESSED	// Tasto premuto (campo key)
+	};
+	Type type = Type::CLOSED;
+	KeyCode key = KeyCode::UNKNOWN;
 };
 
 class RenderBackend {
@@ -34,6 +49,15 @@ public:
 	/// Presenta il frame a schermo (swapchain)
 	virtual void Present() = 0;
 
+	/// Sincronizza Present() con il refresh del display
+	/// @param enabled true per attendere il vsync a ogni Present()
+	virtual void SetVSync(bool enabled) = 0;
+
+	/// Preleva il prossimo evento in coda (chiusura, tasti premuti)
+	/// @param event Evento letto, valido solo se ritorna true
+	/// @return false quando la coda e' vuota
+	virtual bool PollEvent(BackendEvent &event) = 0;
+
 	/// Verifica se un tasto  attualmente premuto
 	/// @param key Il tasto da controllare
 	/// @return true se il tasto  premuto, false altrimenti
@@ -2,6 +2,7 @@
 #include "RenderBackend.h"
 #include <SFML/Graphics.hpp>
 #include <memory>
+#include <vector>
 
 class SFMLBackend :public RenderBackend {
 public:
@@ -19,15 +20,19 @@ public:
 		unsigned int width, unsigned int height,
 		int offsetX = 0, int offsetY = 0) override;
 	void Present() override;
+	void SetVSync(bool enabled) override;
+	bool PollEvent(BackendEvent &event) override;
 	bool IsKeyPressed(KeyCode key) override;
 	void Shutdown() override;
 	std::pair<int, int> GetWindowSize() const override;
 	std::string GetBackendName() const override;
+
 private:
 
 	std::unique_ptr<sf::RenderWindow> m_window;
 	std::unique_ptr<sf::Texture> m_frameTexture;
 	std::unique_ptr<sf::Sprite> m_frameSprite;
+	std::vector<uint32_t> m_swizzleBuffer;	// Solo per host big-endian
 	std::string m_win_title;
 	unsigned int m_width, m_height;
 	unsigned int m_scale;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Memory/MemoryBus.h"
+
+// Tutti gli sprite 16x16 gia' decodificati e ruotati, per ogni combinazione
+// di flip X/Y e per ogni palette: in RGBA e come indici colore (0 = trasparente).
+// Come TileAtlas e' immutabile dopo la costruzione e puo' essere condiviso tra
+// piu' VideoController.
+class SpriteAtlas {
+public:
+	static constexpr int SPRITE_COUNT = 64;
+	static constexpr int FLIP_COUNT = 4;		// bit 0 = flip X, bit 1 = flip Y (come l'attributo hardware)
+	static constexpr int PALETTE_COUNT = 32;	// Attributo colore a 5 bit
+	static constexpr int SPRITE_SIZE = 16;
+	static constexpr int SPRITE_PIXELS = SPRITE_SIZE * SPRITE_SIZE;
+
+	explicit SpriteAtlas(const MemoryBus &memory);
+
+	// Pixel 16x16 dello sprite; alpha 0 = trasparente
+	const uint32_t *GetSprite(uint8_t sprite_code, uint8_t flip, uint8_t palette_offset) const
+	{
+		size_t index = ((size_t)(palette_offset & (PALETTE_COUNT - 1)) * FLIP_COUNT + (flip & (FLIP_COUNT - 1))) * SPRITE_COUNT
+			+ (sprite_code & (SPRITE_COUNT - 1));
+		return &m_pixels[index * SPRITE_PIXELS];
+	}
+
+	// Stesso sprite come indici colore; 0 = trasparente
+	const uint8_t *GetSpriteIndices(uint8_t sprite_code, uint8_t flip, uint8_t palette_offset) const
+	{
+		size_t index = ((size_t)(palette_offset & (PALETTE_COUNT - 1)) * FLIP_COUNT + (flip & (FLIP_COUNT - 1))) * SPRITE_COUNT
+			+ (sprite_code & (SPRITE_COUNT - 1));
+		return &m_indices[index * SPRITE_PIXELS];
+	}
+
+	// Versione grafica delle ROM da cui e' stato costruito
+	uint32_t GetGraphicsVersion() const { return m_graphicsVersion; }
+
+private:
+	std::vector<uint32_t> m_pixels;
+	std::vector<uint8_t> m_indices;
+	uint32_t m_graphicsVersion;
+};
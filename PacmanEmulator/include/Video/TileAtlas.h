@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "Memory/MemoryBus.h"
+#include "Video/TileDecoder.h"
+
+// Tutti i tile gia' decodificati e ruotati, per ogni palette: in RGBA e come
+// indici colore a 8 bit (framebuffer indicizzato), piu' la tabella dei 16 colori.
+// Costruito una volta dopo il caricamento delle ROM: il rendering di una riga
+// di tile diventa la copia di 8 pixel. L'atlante e' immutabile dopo Build(),
+// quindi puo' essere condiviso tra piu' VideoController.
+class TileAtlas {
+public:
+	static constexpr int TILE_COUNT = 256;
+	static constexpr int PALETTE_COUNT = 64;	// Solo i 6 bit bassi dell'attributo colore contano
+	static constexpr int TILE_PIXELS = 64;
+
+	explicit TileAtlas(const MemoryBus &memory);
+
+	// Pixel 8x8 del tile (riga per riga, gia' ruotati come DecodeTile)
+	const uint32_t *GetTile(uint8_t tile_index, uint8_t palette_offset) const
+	{
+		return &m_pixels[((size_t)(palette_offset & (PALETTE_COUNT - 1)) * TILE_COUNT + tile_index) * TILE_PIXELS];
+	}
+
+	// Stesso tile come indici colore 0-15 (vedi GetColors)
+	const uint8_t *GetTileIndices(uint8_t tile_index, uint8_t palette_offset) const
+	{
+		return &m_indices[((size_t)(palette_offset & (PALETTE_COUNT - 1)) * TILE_COUNT + tile_index) * TILE_PIXELS];
+	}
+
+	// RGBA di ogni indice colore (PROM 82s123.7f)
+	const uint32_t *GetColors() const { return m_colors.data(); }
+
+	// Versione grafica delle ROM da cui e' stato costruito
+	uint32_t GetGraphicsVersion() const { return m_graphicsVersion; }
+
+private:
+	std::vector<uint32_t> m_pixels;
+	std::vector<uint8_t> m_indices;
+	std::array<uint32_t, TileDecoder::COLOR_COUNT> m_colors;
+	uint32_t m_graphicsVersion;
+};
@@ -5,11 +5,33 @@
 
 class TileDecoder {
 public:
+	// Colori della PROM 82s123.7f indirizzabili dalla lookup 82s126.4a (4 bit)
+	static constexpr int COLOR_COUNT = 16;
+
 	TileDecoder(const MemoryBus &memory);
 
+	// Tile 8x8 ruotato di 90 gradi in RGBA: percorso SSE2 se disponibile, altrimenti scalare
 	std::array<uint32_t, 64> DecodeTile(uint8_t tile_index, uint8_t palette_offset);
+
+	// Decoder scalare bit per bit: fallback e riferimento per la verifica del percorso SIMD
+	std::array<uint32_t, 64> DecodeTileScalar(uint8_t tile_index, uint8_t palette_offset);
+
+	// true se DecodeTile usa SSE2 (host x86/x86-64 senza TILEDECODER_NO_SIMD)
+	static bool IsSimdSupported();
+
+	// Sprite 16x16 gia' ruotato come i tile; i pixel trasparenti hanno alpha 0
+	std::array<uint32_t, 256> DecodeSprite(uint8_t sprite_code, uint8_t palette_offset, bool flip_x, bool flip_y);
+
+	// Come DecodeTile/DecodeSprite ma con l'indice colore (0-15) invece del pixel RGBA;
+	// negli sprite l'indice 0 e' trasparente
+	std::array<uint8_t, 64> DecodeTileIndices(uint8_t tile_index, uint8_t palette_offset);
+	std::array<uint8_t, 256> DecodeSpriteIndices(uint8_t sprite_code, uint8_t palette_offset, bool flip_x, bool flip_y);
+
+	// RGBA dei 16 colori: converte gli indici in pixel identici a quelli di DecodeTile
+	std::array<uint32_t, COLOR_COUNT> BuildColorTable();
 private:
 	const MemoryBus &m_memory;
 	uint32_t ConvertPaletteByteToRGBA(uint8_t palette_byte);
+	std::array<uint32_t, 4> BuildTileColors(uint8_t palette_offset);
 	std::array<uint32_t, 8> DecodeRow(uint8_t plane0, uint8_t plane1, uint8_t palette_offset);
 };
\ No newline at end of file
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "Memory/MemoryBus.h"
+#include <memory>
+#include <vector>
 #include "Video/TileDecoder.h"
+#include "Video/TileAtlas.h"
+#include "Video/SpriteAtlas.h"
 
 static constexpr int SCREEN_WIDTH = 224;
 static constexpr int SCREEN_HEIGHT = 288;
@@ -9,19 +13,61 @@ static constexpr int TILE_FOR_ROW = 28;
 static constexpr int TILE_FOR_COL = 36;
 static constexpr int SCREEN_SIZE = SCREEN_WIDTH * SCREEN_HEIGHT;
 
+// Formato del framebuffer: RGBA a 32 bit oppure indici colore a 8 bit (PROM
+// 82s126.4a/82s123.7f), convertiti in RGBA solo quando servono
+enum class FrameBufferFormat {
+	RGBA,
+	INDEXED
+};
+
 class VideoController {
 public:
 	VideoController(MemoryBus &memory);
 	void RenderScanline(int scanline_y);
-	void RenderFrame();
+	// Frame intero: sfondo (solo i tile sporchi, o tutti con full_redraw) e sprite
+	void RenderFrame(bool full_redraw = false);
+	void RenderSprites();
 	bool SaveFramebufferPPM(const std::string &filename) const;
-	const uint32_t* GetFrameBuffer() const;
 	std::pair<int, int> GetFrameBufferSize() const;
+	// Forza il ridisegno di tutti i tile alla prossima scanline/frame
+	void MarkAllTilesForRedraw();
+
+	// Cambiare formato libera l'altro buffer e forza il ridisegno del frame successivo
+	void SetFrameBufferFormat(FrameBufferFormat format);
+	FrameBufferFormat GetFrameBufferFormat() const { return m_format; }
+
+	// Pixel RGBA (nullptr in modalita' INDEXED) e indici colore (nullptr in modalita' RGBA)
+	const uint32_t* GetFrameBuffer() const;
+	const uint8_t* GetIndexedFrameBuffer() const;
+
+	// Copia il frame in RGBA (SCREEN_SIZE pixel) in entrambi i formati
+	void ConvertFrameBufferToRGBA(uint32_t *dest) const;
+
+	// Atlanti di tile e sprite pre-decodificati (ricostruiti se cambiano tile o palette)
+	void RebuildTileAtlas();
+	void ShareTileAtlas(std::shared_ptr<const TileAtlas> atlas);
+	std::shared_ptr<const TileAtlas> GetTileAtlas() const { return m_tileAtlas; }
+	void RebuildSpriteAtlas();
+	void ShareSpriteAtlas(std::shared_ptr<const SpriteAtlas> atlas);
+	std::shared_ptr<const SpriteAtlas> GetSpriteAtlas() const { return m_spriteAtlas; }
 
 private:
 	MemoryBus &m_memory;
-	TileDecoder m_tileDecoder;
-	std::array<uint32_t, SCREEN_SIZE> m_frameBuffer;
-	void RenderTile(int tile_x, int tile_y);
+	std::shared_ptr<const TileAtlas> m_tileAtlas;
+	std::shared_ptr<const SpriteAtlas> m_spriteAtlas;
+
+	// Solo il buffer del formato attivo e' allocato: 1 byte per pixel in INDEXED
+	FrameBufferFormat m_format;
+	std::vector<uint32_t> m_frameBuffer;
+	std::vector<uint8_t> m_indexedFrameBuffer;
+
+	// Tile da ridisegnare indipendentemente dalla VRAM (sprite del frame
+	// precedente, cambio di atlante) e stato della riga di tile corrente
+	std::array<std::array<bool, TILE_FOR_ROW>, TILE_FOR_COL> m_forceRedraw;
+	std::array<bool, TILE_FOR_ROW> m_rowRedraw;
 	uint16_t GetVramOffset(int x, int y);
+	void EnsureTileAtlas();
+	void EnsureSpriteAtlas();
+	template <typename Pixel>
+	void DrawSprite(const Pixel *sprite_pixels, Pixel *frame_buffer, int screen_x, int screen_y);
 };
@@ -0,0 +1,56 @@
+#include "Audio/AudioRingBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+AudioRingBuffer::AudioRingBuffer(size_t capacity)
+	: m_writeIndex(0), m_readIndex(0), m_dropped(0)
+{
+	size_t size = 1;
+	while (size < capacity) size <<= 1;
+
+	m_buffer = std::make_unique<int16_t[]>(size);
+	m_mask = size - 1;
+}
+
+size_t AudioRingBuffer::Push(const int16_t *samples, size_t count)
+{
+	const size_t write = m_writeIndex.load(std::memory_order_relaxed);
+	const size_t read = m_readIndex.load(std::memory_order_acquire);
+
+	size_t space = GetCapacity() - (write - read);
+	size_t toWrite = std::min(count, space);
+
+	// Al massimo due copie: fino alla fine del buffer e dall'inizio
+	size_t start = write & m_mask;
+	size_t first = std::min(toWrite, GetCapacity() - start);
+	std::memcpy(&m_buffer[start], samples, first * sizeof(int16_t));
+	std::memcpy(&m_buffer[0], samples + first, (toWrite - first) * sizeof(int16_t));
+
+	m_writeIndex.store(write + toWrite, std::memory_order_release);
+
+	if (toWrite < count) {
+		m_dropped.fetch_add(count - toWrite, std::memory_order_relaxed);
+	}
+	return toWrite;
+}
+
+size_t AudioRingBuffer::Pop(int16_t *samples, size_t count)
+{
+	const size_t read = m_readIndex.load(std::memory_order_relaxed);
+	const size_t write = m_writeIndex.load(std::memory_order_acquire);
+
+	size_t toRead = std::min(count, write - read);
+
+	size_t start = read & m_mask;
+	size_t first = std::min(toRead, GetCapacity() - start);
+	std::memcpy(samples, &m_buffer[start], first * sizeof(int16_t));
+	std::memcpy(samples + first, &m_buffer[0], (toRead - first) * sizeof(int16_t));
+
+	m_readIndex.store(read + toRead, std::memory_order_release);
+	return toRead;
+}
+
+size_t AudioRingBuffer::GetAvailable() const
+{
+	return m_writeIndex.load(std::memory_order_acquire) - m_readIndex.load(std::memory_order_acquire);
+}
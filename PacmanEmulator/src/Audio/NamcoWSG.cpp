@@ -0,0 +1,74 @@
+#include "Audio/NamcoWSG.h"
+
+namespace {
+	// Offset dei registri per ogni voce (vedi NamcoWSG.h)
+	constexpr int WAVEFORM_REG[NamcoWSG::VOICE_COUNT] = { 0x05, 0x0A, 0x0F };
+	constexpr int FREQUENCY_REG[NamcoWSG::VOICE_COUNT] = { 0x10, 0x15, 0x1A };	// Nibble 0 (solo voce 0), 1-4 da +1
+	constexpr int VOLUME_REG[NamcoWSG::VOICE_COUNT] = { 0x15, 0x1A, 0x1F };
+
+	// Il campione della forma d'onda e' l'indice (bit 15-19) dell'accumulatore
+	constexpr int PHASE_SHIFT = 15;
+
+	// Tre voci da -8..7 x volume 0..15: moltiplicatore per arrivare vicino al fondo scala a 16 bit
+	constexpr int OUTPUT_GAIN = 64;
+}
+
+NamcoWSG::NamcoWSG()
+{
+	Reset();
+}
+
+void NamcoWSG::Reset()
+{
+	m_accumulators.fill(0);
+}
+
+void NamcoWSG::Render(const uint8_t *registers, const uint8_t *waveforms, bool enabled, int16_t *out, size_t count)
+{
+	// Decodifica dei registri una volta per blocco: le scritture della CPU
+	// vengono viste con la granularita' del blocco (una scanline)
+	uint32_t frequency[VOICE_COUNT];
+	const uint8_t *wave[VOICE_COUNT];
+	int volume[VOICE_COUNT];
+
+	for (int v = 0; v < VOICE_COUNT; v++) {
+		int base = FREQUENCY_REG[v];
+		frequency[v] = (v == 0) ? registers[base] : 0;
+		frequency[v] |= registers[base + 1] << 4;
+		frequency[v] |= registers[base + 2] << 8;
+		frequency[v] |= registers[base + 3] << 12;
+		frequency[v] |= registers[base + 4] << 16;
+
+		wave[v] = waveforms + ((registers[WAVEFORM_REG[v]] & 0x07) << 5);
+		volume[v] = enabled ? registers[VOLUME_REG[v]] : 0;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		int mix = 0;
+
+		for (int step = 0; step < OUTPUT_DECIMATION; step++) {
+			for (int v = 0; v < VOICE_COUNT; v++) {
+				// La fase avanza anche a volume zero, come nel chip
+				int sample = (wave[v][(m_accumulators[v] >> PHASE_SHIFT) & 0x1F] & 0x0F) - 8;
+				mix += sample * volume[v];
+				m_accumulators[v] = (m_accumulators[v] + frequency[v]) & 0xFFFFF;
+			}
+		}
+
+		out[i] = static_cast<int16_t>(mix * OUTPUT_GAIN / OUTPUT_DECIMATION);
+	}
+}
+
+void NamcoWSG::SaveState(StateWriter &writer) const
+{
+	for (uint32_t accumulator : m_accumulators) {
+		writer.Write32(accumulator);
+	}
+}
+
+void NamcoWSG::LoadState(StateReader &reader)
+{
+	for (uint32_t &accumulator : m_accumulators) {
+		accumulator = reader.Read32() & 0xFFFFF;
+	}
+}
@@ -0,0 +1,52 @@
+#include "Audio/SFMLAudioStream.h"
+#include <algorithm>
+#include <cmath>
+
+SFMLAudioStream::SFMLAudioStream(AudioRingBuffer &ring, unsigned int sampleRate)
+	: m_ring(ring), m_rateRatio(1.0), m_underrunSamples(0),
+	m_input(CHUNK_SAMPLES * 2 + 2, 0), m_chunk(CHUNK_SAMPLES, 0), m_lastSample(0), m_phase(0.0)
+{
+	initialize(1, sampleRate, { sf::SoundChannel::Mono });
+}
+
+bool SFMLAudioStream::onGetData(Chunk &data)
+{
+	const double step = std::clamp(m_rateRatio.load(std::memory_order_relaxed), 0.5, 2.0);
+
+	// m_input[0] e' l'ultimo campione del blocco precedente, poi quelli nuovi:
+	// per CHUNK_SAMPLES uscite servono ceil(fase + CHUNK_SAMPLES * step) ingressi
+	size_t needed = static_cast<size_t>(std::ceil(m_phase + CHUNK_SAMPLES * step));
+	m_input[0] = m_lastSample;
+	size_t read = m_ring.Pop(&m_input[1], needed);
+
+	// Coda vuota: ripeti l'ultimo campione (niente click) e continua a suonare
+	if (read < needed) {
+		int16_t hold = m_input[read];
+		std::fill(m_input.begin() + 1 + read, m_input.begin() + 1 + needed, hold);
+		m_underrunSamples.fetch_add(needed - read, std::memory_order_relaxed);
+	}
+
+	// Interpolazione lineare
+	double position = m_phase;
+	for (size_t i = 0; i < CHUNK_SAMPLES; i++) {
+		size_t index = static_cast<size_t>(position);
+		double frac = position - static_cast<double>(index);
+		double a = m_input[index];
+		double b = m_input[index + 1];
+		m_chunk[i] = static_cast<int16_t>(a + (b - a) * frac);
+		position += step;
+	}
+
+	size_t consumed = static_cast<size_t>(position);
+	m_lastSample = m_input[consumed];
+	m_phase = position - static_cast<double>(consumed);
+
+	data.samples = m_chunk.data();
+	data.sampleCount = m_chunk.size();
+	return true;
+}
+
+void SFMLAudioStream::onSeek(sf::Time timeOffset)
+{
+	// Stream in tempo reale: non c'e' posizione da cercare
+}
@@ -1,10 +1,16 @@
 ﻿#include "CPU/Z80.h"
+#include "CPU/Z80Jit.h"
+#include "CPU/Z80Tables.h"
 #include <stdexcept>
 #include <algorithm>
 #include <iostream>
 #include <iomanip>
+#include <utility>
 
-Z80::Z80(MemoryBus *memory) : m_memory(memory) {
+// Tabelle dei flag condivise dai core di dispatch (vedi Z80Tables.h)
+const Z80FlagTables g_z80Flags;
+
+Z80::Z80(MemoryBus *memory) : m_memory(memory), m_blockCacheEnabled(true) {
     if (!memory) {
         throw std::invalid_argument("Memory pointer cannot be null!");
     }
@@ -12,395 +18,914 @@ Z80::Z80(MemoryBus *memory) : m_memory(memory) {
     m_interruptMode = 1;
     m_interruptsEnabled = false;
 
-    // inizializza register map
-    m_registerMap[0] = &BC.high; // B
-    m_registerMap[1] = &BC.low;  // C
-    m_registerMap[2] = &DE.high; // D
-    m_registerMap[3] = &DE.low;  // E
-    m_registerMap[4] = &HL.high; // H
-    m_registerMap[5] = &HL.low;  // L
-    m_registerMap[6] = nullptr;  // (HL) - non usato direttamente
-    m_registerMap[7] = &A;       // A
+    InvalidateBlockCache();
+}
+
+Z80::~Z80() = default;
 
-    // inizializza register map 16 bit
-    m_register16Map[0] = &BC.pair;
-    m_register16Map[1] = &DE.pair;
-    m_register16Map[2] = &HL.pair;
-    m_register16Map[3] = &SP;
+void Z80::OP_NotImplemented() {
+    // Ottieni l'opcode dell'istruzione precedente
+    uint8_t opcode = m_memory->Read(PC - 1);
+
+    std::cerr << "\nFATAL: Opcode non implementato: 0x"
+        << std::hex << std::setfill('0') << std::setw(2)
+        << (int)opcode << std::dec
+        << " at PC=0x" << std::hex << (PC - 1) << std::dec << "\n";
+    std::cerr << "Registri:\n";
+    std::cerr << "  A=0x" << std::hex << (int)A << std::dec << "\n";
+    std::cerr << "  BC=0x" << std::hex << BC.pair << std::dec << "\n";
+    std::cerr << "  DE=0x" << std::hex << DE.pair << std::dec << "\n";
+    std::cerr << "  HL=0x" << std::hex << HL.pair << std::dec << "\n";
+    std::cerr << "  SP=0x" << std::hex << SP << std::dec << "\n";
 
-    InitOpcodeTable();
+    //throw std::runtime_error("Unimplemented opcode encountered!");
 }
 
-void Z80::InitOpcodeTable() {
-    // Riempi tutto con "non implementato"
-    for (int i = 0; i < 256; i++) {
-        m_opcodeTable[i] = &Z80::OP_NotImplemented;
+void Z80::OP_NOP() {
+    // Non fa nulla
+    m_cyclesLastInstruction = 4;
+}
+
+// ========== Handler generati da template ==========
+// Gli indici dei registri sono quelli della codifica degli opcode, risolti a
+// compile time: ogni specializzazione diventa un accesso diretto al registro.
+
+template<int Index>
+inline uint8_t &Z80::Reg8()
+{
+    static_assert(Index >= 0 && Index < 8 && Index != 6, "(HL) va letto dalla memoria");
+
+    if constexpr (Index == 0) return BC.high;
+    else if constexpr (Index == 1) return BC.low;
+    else if constexpr (Index == 2) return DE.high;
+    else if constexpr (Index == 3) return DE.low;
+    else if constexpr (Index == 4) return HL.high;
+    else if constexpr (Index == 5) return HL.low;
+    else return A;
+}
+
+template<int Dst, int Src>
+void Z80::OP_LD_r_r()
+{
+    if constexpr (Dst == 6 && Src == 6) {
+        // 0x76 (sarebbe LD (HL),(HL)) e' HALT
+        OP_HALT();
+    }
+    else if constexpr (Src == 6) {
+        // Lettura dalla memoria
+        Reg8<Dst>() = m_memory->Read(HL.pair);
+        m_cyclesLastInstruction = 7;
+    }
+    else if constexpr (Dst == 6) {
+        // Scrittura in memoria
+        m_memory->Write(HL.pair, Reg8<Src>());
+        m_cyclesLastInstruction = 7;
     }
+    else {
+        Reg8<Dst>() = Reg8<Src>();
+        m_cyclesLastInstruction = 4;
+    }
+}
 
-    // NOP
-    m_opcodeTable[0x00] = &Z80::OP_NOP;
-    
-    // INC opcodes
-    m_opcodeTable[0x3C] = &Z80::OP_INC_A;
-    m_opcodeTable[0x04] = &Z80::OP_INC_B;
-    m_opcodeTable[0x0C] = &Z80::OP_INC_C;
-    m_opcodeTable[0x14] = &Z80::OP_INC_D;
-    m_opcodeTable[0x1C] = &Z80::OP_INC_E;
-    m_opcodeTable[0x24] = &Z80::OP_INC_H;
-    m_opcodeTable[0x2C] = &Z80::OP_INC_L;
-
-    // DEC opcodes
-    m_opcodeTable[0x3D] = &Z80::OP_DEC_A;
-    m_opcodeTable[0x05] = &Z80::OP_DEC_B;
-    m_opcodeTable[0x0D] = &Z80::OP_DEC_C;
-    m_opcodeTable[0x15] = &Z80::OP_DEC_D;
-    m_opcodeTable[0x1D] = &Z80::OP_DEC_E;
-    m_opcodeTable[0x25] = &Z80::OP_DEC_H;
-    m_opcodeTable[0x2D] = &Z80::OP_DEC_L;
-
-    // LD r,n opcodes
-    m_opcodeTable[0x3E] = &Z80::OP_LD_A_n;
-    m_opcodeTable[0x06] = &Z80::OP_LD_B_n;
-    m_opcodeTable[0x0E] = &Z80::OP_LD_C_n;
-    m_opcodeTable[0x16] = &Z80::OP_LD_D_n;
-    m_opcodeTable[0x1E] = &Z80::OP_LD_E_n;
-    m_opcodeTable[0x26] = &Z80::OP_LD_H_n;
-    m_opcodeTable[0x2E] = &Z80::OP_LD_L_n;
-
-    // ADD A,r opcodes
-    m_opcodeTable[0x80] = &Z80::OP_ADD_A_B;
-    m_opcodeTable[0x81] = &Z80::OP_ADD_A_C;
-    m_opcodeTable[0x82] = &Z80::OP_ADD_A_D;
-    m_opcodeTable[0x83] = &Z80::OP_ADD_A_E;
-    m_opcodeTable[0x84] = &Z80::OP_ADD_A_H;
-    m_opcodeTable[0x85] = &Z80::OP_ADD_A_L;
-    m_opcodeTable[0x86] = &Z80::OP_ADD_A_HL;
-    m_opcodeTable[0x87] = &Z80::OP_ADD_A_A;
-
-    // SUB A,r opcodes
-    m_opcodeTable[0x90] = &Z80::OP_SUB_A_B;
-    m_opcodeTable[0x91] = &Z80::OP_SUB_A_C;
-    m_opcodeTable[0x92] = &Z80::OP_SUB_A_D;
-    m_opcodeTable[0x93] = &Z80::OP_SUB_A_E;
-    m_opcodeTable[0x94] = &Z80::OP_SUB_A_H;
-    m_opcodeTable[0x95] = &Z80::OP_SUB_A_L;
-    m_opcodeTable[0x96] = &Z80::OP_SUB_A_HL;
-    m_opcodeTable[0x97] = &Z80::OP_SUB_A_A;
-
-    // LD r, r
-    for (int i = 0x40; i <= 0x7F; i++) {
-        m_opcodeTable[i] = &Z80::OP_LD_r_r;
-    }
-
-    // AND A,r opcodes
-    m_opcodeTable[0xA0] = &Z80::OP_AND_A_B;
-    m_opcodeTable[0xA1] = &Z80::OP_AND_A_C;
-    m_opcodeTable[0xA2] = &Z80::OP_AND_A_D;
-    m_opcodeTable[0xA3] = &Z80::OP_AND_A_E;
-    m_opcodeTable[0xA4] = &Z80::OP_AND_A_H;
-    m_opcodeTable[0xA5] = &Z80::OP_AND_A_L;
-    m_opcodeTable[0xA6] = &Z80::OP_AND_A_HL;
-    m_opcodeTable[0xA7] = &Z80::OP_AND_A_A;
-
-    // XOR A,r opcodes
-    m_opcodeTable[0xA8] = &Z80::OP_XOR_A_B;
-    m_opcodeTable[0xA9] = &Z80::OP_XOR_A_C;
-    m_opcodeTable[0xAA] = &Z80::OP_XOR_A_D;
-    m_opcodeTable[0xAB] = &Z80::OP_XOR_A_E;
-    m_opcodeTable[0xAC] = &Z80::OP_XOR_A_H;
-    m_opcodeTable[0xAD] = &Z80::OP_XOR_A_L;
-    m_opcodeTable[0xAE] = &Z80::OP_XOR_A_HL;
-    m_opcodeTable[0xAF] = &Z80::OP_XOR_A_A;
-
-    // OR A,r opcodes
-    m_opcodeTable[0xB0] = &Z80::OP_OR_A_B;
-    m_opcodeTable[0xB1] = &Z80::OP_OR_A_C;
-    m_opcodeTable[0xB2] = &Z80::OP_OR_A_D;
-    m_opcodeTable[0xB3] = &Z80::OP_OR_A_E;
-    m_opcodeTable[0xB4] = &Z80::OP_OR_A_H;
-    m_opcodeTable[0xB5] = &Z80::OP_OR_A_L;
-    m_opcodeTable[0xB6] = &Z80::OP_OR_A_HL;
-    m_opcodeTable[0xB7] = &Z80::OP_OR_A_A;
-
-    // CP A,r opcodes
-    m_opcodeTable[0xB8] = &Z80::OP_CP_A_B;
-    m_opcodeTable[0xB9] = &Z80::OP_CP_A_C;
-    m_opcodeTable[0xBA] = &Z80::OP_CP_A_D;
-    m_opcodeTable[0xBB] = &Z80::OP_CP_A_E;
-    m_opcodeTable[0xBC] = &Z80::OP_CP_A_H;
-    m_opcodeTable[0xBD] = &Z80::OP_CP_A_L;
-    m_opcodeTable[0xBE] = &Z80::OP_CP_A_HL;
-    m_opcodeTable[0xBF] = &Z80::OP_CP_A_A;
+template<int Index>
+inline uint16_t &Z80::Reg16()
+{
+    if constexpr (Index == 0) return BC.pair;
+    else if constexpr (Index == 1) return DE.pair;
+    else if constexpr (Index == 2) return HL.pair;
+    else return SP;
+}
 
-    // Jump assoluti
-    m_opcodeTable[0xC3] = &Z80::OP_JP_nn;
-    m_opcodeTable[0xCA] = &Z80::OP_JP_Z_nn;
-    m_opcodeTable[0xC2] = &Z80::OP_JP_NZ_nn;
-    m_opcodeTable[0xDA] = &Z80::OP_JP_C_nn;
-    m_opcodeTable[0xD2] = &Z80::OP_JP_NC_nn;
+template<int Operation>
+inline void Z80::ALU_A(uint8_t value)
+{
+    if constexpr (Operation == 0) ADD_A_r(value);
+    else if constexpr (Operation == 1) ADC_A_r(value);
+    else if constexpr (Operation == 2) SUB_A_r(value);
+    else if constexpr (Operation == 3) SBC_A_r(value);
+    else if constexpr (Operation == 4) AND_A_r(value);
+    else if constexpr (Operation == 5) XOR_A_r(value);
+    else if constexpr (Operation == 6) OR_A_r(value);
+    else CP_A_r(value);
+}
 
-    // Jump relativi
-    m_opcodeTable[0x18] = &Z80::OP_JR_e;
-    m_opcodeTable[0x28] = &Z80::OP_JR_Z_e;
-    m_opcodeTable[0x20] = &Z80::OP_JR_NZ_e;
-    m_opcodeTable[0x38] = &Z80::OP_JR_C_e;
-    m_opcodeTable[0x30] = &Z80::OP_JR_NC_e;
+template<int Operation, int Src>
+void Z80::OP_ALU_r()
+{
+    uint8_t value;
+    if constexpr (Src == 6) {
+        value = m_memory->Read(HL.pair);
+    }
+    else {
+        value = Reg8<Src>();
+    }
 
-    // Call/ret
-    m_opcodeTable[0xCD] = &Z80::OP_CALL_nn;
-    m_opcodeTable[0xCC] = &Z80::OP_CALL_Z_nn;
-    m_opcodeTable[0xC4] = &Z80::OP_CALL_NZ_nn;
-    m_opcodeTable[0xDC] = &Z80::OP_CALL_C_nn;
-    m_opcodeTable[0xD4] = &Z80::OP_CALL_NC_nn;
-    m_opcodeTable[0xC9] = &Z80::OP_RET;
-    m_opcodeTable[0xC8] = &Z80::OP_RET_Z;
-    m_opcodeTable[0xC0] = &Z80::OP_RET_NZ;
-    m_opcodeTable[0xD8] = &Z80::OP_RET_C;
-    m_opcodeTable[0xD0] = &Z80::OP_RET_NC;
+    ALU_A<Operation>(value);
 
-    // Push/Pop
-    m_opcodeTable[0xC5] = &Z80::OP_PUSH_BC;
-    m_opcodeTable[0xD5] = &Z80::OP_PUSH_DE;
-    m_opcodeTable[0xE5] = &Z80::OP_PUSH_HL;
-    m_opcodeTable[0xF5] = &Z80::OP_PUSH_AF;
-    m_opcodeTable[0xC1] = &Z80::OP_POP_BC;
-    m_opcodeTable[0xD1] = &Z80::OP_POP_DE;
-    m_opcodeTable[0xE1] = &Z80::OP_POP_HL;
-    m_opcodeTable[0xF1] = &Z80::OP_POP_AF;
+    m_cyclesLastInstruction = (Src == 6) ? 7 : 4;
+}
 
-    // LD rr,nn
-    m_opcodeTable[0x01] = &Z80::OP_LD_BC_nn;
-    m_opcodeTable[0x11] = &Z80::OP_LD_DE_nn;
-    m_opcodeTable[0x21] = &Z80::OP_LD_HL_nn;
-    m_opcodeTable[0x31] = &Z80::OP_LD_SP_nn;
+template<int Reg>
+void Z80::OP_INC_r()
+{
+    if constexpr (Reg == 6) {
+        INC_Memory(HL.pair);
+        m_cyclesLastInstruction = 11;
+    }
+    else {
+        INC_r(Reg8<Reg>());
+    }
+}
 
-    // INC rr
-    m_opcodeTable[0x03] = &Z80::OP_INC_BC;
-    m_opcodeTable[0x13] = &Z80::OP_INC_DE;
-    m_opcodeTable[0x23] = &Z80::OP_INC_HL;
-    m_opcodeTable[0x33] = &Z80::OP_INC_SP;
+template<int Reg>
+void Z80::OP_DEC_r()
+{
+    if constexpr (Reg == 6) {
+        DEC_Memory(HL.pair);
+        m_cyclesLastInstruction = 11;
+    }
+    else {
+        DEC_r(Reg8<Reg>());
+    }
+}
 
-    // DEC rr
-    m_opcodeTable[0x0B] = &Z80::OP_DEC_BC;
-    m_opcodeTable[0x1B] = &Z80::OP_DEC_DE;
-    m_opcodeTable[0x2B] = &Z80::OP_DEC_HL;
-    m_opcodeTable[0x3B] = &Z80::OP_DEC_SP;
+template<int Reg>
+void Z80::OP_LD_r_n()
+{
+    LD_r_n(Reg8<Reg>());
+}
 
-    // ADD hL, rr
-    m_opcodeTable[0x09] = &Z80::OP_ADD_HL_BC;
-    m_opcodeTable[0x19] = &Z80::OP_ADD_HL_DE;
-    m_opcodeTable[0x29] = &Z80::OP_ADD_HL_HL;
-    m_opcodeTable[0x39] = &Z80::OP_ADD_HL_SP;
+template<int Operation>
+inline void Z80::RotateShift(uint8_t &value)
+{
+    if constexpr (Operation == 0) CB_RLC(value);
+    else if constexpr (Operation == 1) CB_RRC(value);
+    else if constexpr (Operation == 2) CB_RL(value);
+    else if constexpr (Operation == 3) CB_RR(value);
+    else if constexpr (Operation == 4) CB_SLA(value);
+    else if constexpr (Operation == 5) CB_SRA(value);
+    else if constexpr (Operation == 6) CB_SLL(value);
+    else CB_SRL(value);
+}
 
-    // LD Special
-    m_opcodeTable[0x0A] = &Z80::OP_LD_A_BC;
-    m_opcodeTable[0x1A] = &Z80::OP_LD_A_DE;
-    m_opcodeTable[0x02] = &Z80::OP_LD_BC_A;
-    m_opcodeTable[0x12] = &Z80::OP_LD_DE_A;
-    m_opcodeTable[0x3A] = &Z80::OP_LD_A_nn;
-    m_opcodeTable[0x32] = &Z80::OP_LD_nn_A;
+template<int Bit>
+inline void Z80::BIT_n(uint8_t value)
+{
+    bool bitValue = (value & (1 << Bit)) != 0;
 
-    // Operation Immediate
-    m_opcodeTable[0xC6] = &Z80::OP_ADD_n;
-    m_opcodeTable[0xD6] = &Z80::OP_SUB_n;
-    m_opcodeTable[0xE6] = &Z80::OP_AND_n;
-    m_opcodeTable[0xEE] = &Z80::OP_XOR_n;
-    m_opcodeTable[0xF6] = &Z80::OP_OR_n;
-    m_opcodeTable[0xFE] = &Z80::OP_CP_n;
-    m_opcodeTable[0x36] = &Z80::OP_LD_HL_n;
-
-    // ADC A,r
-    m_opcodeTable[0x88] = &Z80::OP_ADC_A_B;
-    m_opcodeTable[0x89] = &Z80::OP_ADC_A_C;
-    m_opcodeTable[0x8A] = &Z80::OP_ADC_A_D;
-    m_opcodeTable[0x8B] = &Z80::OP_ADC_A_E;
-    m_opcodeTable[0x8C] = &Z80::OP_ADC_A_H;
-    m_opcodeTable[0x8D] = &Z80::OP_ADC_A_L;
-    m_opcodeTable[0x8E] = &Z80::OP_ADC_A_HL;
-    m_opcodeTable[0x8F] = &Z80::OP_ADC_A_A;
-    m_opcodeTable[0xCE] = &Z80::OP_ADC_A_n;
-
-    // SBC A,r
-    m_opcodeTable[0x98] = &Z80::OP_SBC_A_B;
-    m_opcodeTable[0x99] = &Z80::OP_SBC_A_C;
-    m_opcodeTable[0x9A] = &Z80::OP_SBC_A_D;
-    m_opcodeTable[0x9B] = &Z80::OP_SBC_A_E;
-    m_opcodeTable[0x9C] = &Z80::OP_SBC_A_H;
-    m_opcodeTable[0x9D] = &Z80::OP_SBC_A_L;
-    m_opcodeTable[0x9E] = &Z80::OP_SBC_A_HL;
-    m_opcodeTable[0x9F] = &Z80::OP_SBC_A_A;
-    m_opcodeTable[0xDE] = &Z80::OP_SBC_A_n;
+    // Z e P/V = bit negato, H = 1, N = 0; S solo per BIT 7. C non cambia
+    F = (F & ~(FLAG_S | FLAG_Z | FLAG_PV | FLAG_N)) | FLAG_H;
+    if (!bitValue) F |= FLAG_Z | FLAG_PV;
+    if (Bit == 7 && bitValue) F |= FLAG_S;
+}
 
-    // LD 16-bit
-    m_opcodeTable[0x2A] = &Z80::OP_LD_HL_pnn;
-    m_opcodeTable[0x22] = &Z80::OP_LD_pnn_HL;
-    m_opcodeTable[0xF9] = &Z80::OP_LD_SP_HL;
+template<int Operation, int Reg>
+void Z80::OP_CB_Rotate()
+{
+    uint8_t value;
+    if constexpr (Reg == 6) {
+        value = m_memory->Read(HL.pair);
+    }
+    else {
+        value = Reg8<Reg>();
+    }
 
-    // CB
-    m_opcodeTable[0xCB] = &Z80::OP_CB_Prefix;
+    RotateShift<Operation>(value);
 
-    // ED
-    m_opcodeTable[0xED] = &Z80::OP_ED_Prefix;
+    if constexpr (Reg == 6) {
+        m_memory->Write(HL.pair, value);
+        m_cyclesLastInstruction = 15;
+    }
+    else {
+        Reg8<Reg>() = value;
+        m_cyclesLastInstruction = 8;
+    }
+}
 
-    // DD
-    m_opcodeTable[0xDD] = &Z80::OP_DD_Prefix;
+template<int Bit, int Reg>
+void Z80::OP_CB_BIT()
+{
+    uint8_t value;
+    if constexpr (Reg == 6) {
+        value = m_memory->Read(HL.pair);
+    }
+    else {
+        value = Reg8<Reg>();
+    }
+    BIT_n<Bit>(value);
 
-    // FD
-    m_opcodeTable[0xFD] = &Z80::OP_FD_Prefix;
+    m_cyclesLastInstruction = (Reg == 6) ? 12 : 8;
+}
 
-    // RST
-    m_opcodeTable[0xC7] = &Z80::OP_RST_00;  
-    m_opcodeTable[0xCF] = &Z80::OP_RST_08;  
-    m_opcodeTable[0xD7] = &Z80::OP_RST_10;  
-    m_opcodeTable[0xDF] = &Z80::OP_RST_18;  
-    m_opcodeTable[0xE7] = &Z80::OP_RST_20;  
-    m_opcodeTable[0xEF] = &Z80::OP_RST_28;  
-    m_opcodeTable[0xF7] = &Z80::OP_RST_30;  
-    m_opcodeTable[0xFF] = &Z80::OP_RST_38;  
-
-    m_opcodeTable[0xEB] = &Z80::OP_EX_DE_HL;
-    m_opcodeTable[0xE9] = &Z80::OP_JP_HL;
-
-    m_opcodeTable[0xF3] = &Z80::OP_DI;
-    m_opcodeTable[0x10] = &Z80::OP_DJNZ;
-
-    m_opcodeTable[0xD3] = &Z80::OP_OUT_n_A;
-    m_opcodeTable[0xDB] = &Z80::OP_IN_A_n;
-    m_opcodeTable[0xFB] = &Z80::OP_EI;
-    m_opcodeTable[0xFA] = &Z80::OP_JP_M_nn;
-    m_opcodeTable[0x0F] = &Z80::OP_RRCA;
-    m_opcodeTable[0xD9] = &Z80::OP_EXX;
-    m_opcodeTable[0x2F] = &Z80::OP_CPL;
-    m_opcodeTable[0x07] = &Z80::OP_RLCA;
-    m_opcodeTable[0x17] = &Z80::OP_RLA;
-    m_opcodeTable[0x1F] = &Z80::OP_RRA;
-    m_opcodeTable[0x34] = &Z80::OP_INC_pHL;
-    m_opcodeTable[0x35] = &Z80::OP_DEC_pHL;
-    m_opcodeTable[0x3F] = &Z80::OP_CCF;
-    m_opcodeTable[0x37] = &Z80::OP_SCF;
-}
-
-bool Z80::CalculateParity(uint8_t value)
-{
-    int count = 0;
-    while (value) {
-        if (value & 0x01) {
-            count++;
-        }
-        value >>= 1;
+template<int Bit, int Reg>
+void Z80::OP_CB_RES()
+{
+    if constexpr (Reg == 6) {
+        m_memory->Write(HL.pair, m_memory->Read(HL.pair) & ~(1 << Bit));
+        m_cyclesLastInstruction = 15;
+    }
+    else {
+        Reg8<Reg>() &= ~(1 << Bit);
+        m_cyclesLastInstruction = 8;
     }
-    return (count % 2) == 0;
 }
 
-void Z80::OP_NotImplemented() {
-    // Ottieni l'opcode dell'istruzione precedente
-    uint8_t opcode = m_memory->Read(PC - 1);
+template<int Bit, int Reg>
+void Z80::OP_CB_SET()
+{
+    if constexpr (Reg == 6) {
+        m_memory->Write(HL.pair, m_memory->Read(HL.pair) | (1 << Bit));
+        m_cyclesLastInstruction = 15;
+    }
+    else {
+        Reg8<Reg>() |= (1 << Bit);
+        m_cyclesLastInstruction = 8;
+    }
+}
 
-    std::cerr << "\nFATAL: Opcode non implementato: 0x"
-        << std::hex << std::setfill('0') << std::setw(2)
-        << (int)opcode << std::dec
-        << " at PC=0x" << std::hex << (PC - 1) << std::dec << "\n";
-    std::cerr << "Registri:\n";
-    std::cerr << "  A=0x" << std::hex << (int)A << std::dec << "\n";
-    std::cerr << "  BC=0x" << std::hex << BC.pair << std::dec << "\n";
-    std::cerr << "  DE=0x" << std::hex << DE.pair << std::dec << "\n";
-    std::cerr << "  HL=0x" << std::hex << HL.pair << std::dec << "\n";
-    std::cerr << "  SP=0x" << std::hex << SP << std::dec << "\n";
+// ========== Prefissi DD/FD: handler condivisi da IX e IY ==========
+// XY e' il registro indice (&Z80::IX o &Z80::IY). Con il prefisso (HL)
+// diventa (XY+d) e H/L diventano le meta' alta e bassa di XY, tranne quando
+// l'altro operando e' (XY+d): LD H,(IX+d) scrive il vero H.
 
-    //throw std::runtime_error("Unimplemented opcode encountered!");
+template<uint16_t Z80::*XY, int Index>
+inline uint8_t &Z80::RegXY8()
+{
+    // Stessa disposizione little-endian di RegisterPair
+    if constexpr (Index == 4) return reinterpret_cast<uint8_t *>(&(this->*XY))[1];
+    else if constexpr (Index == 5) return reinterpret_cast<uint8_t *>(&(this->*XY))[0];
+    else return Reg8<Index>();
 }
 
-void Z80::OP_NOP() {
-    // Non fa nulla
+template<uint16_t Z80::*XY>
+inline uint16_t Z80::IndexAddress()
+{
+    int8_t offset = (int8_t)FetchByte();
+    return (uint16_t)(this->*XY + offset);
+}
+
+void Z80::OP_XY_Ignored()
+{
+    // L'istruzione che segue non usa HL: il prefisso costa 4 cicli come un NOP
+    // e l'opcode viene eseguito dal dispatch principale come istruzione a se'
+    PC--;
     m_cyclesLastInstruction = 4;
 }
 
-// INC opcodes
-void Z80::OP_INC_A() { INC_r(A); }
-void Z80::OP_INC_B() { INC_r(BC.high); }
-void Z80::OP_INC_C() { INC_r(BC.low); }
-void Z80::OP_INC_D() { INC_r(DE.high); }
-void Z80::OP_INC_E() { INC_r(DE.low); }
-void Z80::OP_INC_H() { INC_r(HL.high); }
-void Z80::OP_INC_L() { INC_r(HL.low); }
-
-// DEC opcodes
-void Z80::OP_DEC_A() { DEC_r(A); }
-void Z80::OP_DEC_B() { DEC_r(BC.high); }
-void Z80::OP_DEC_C() { DEC_r(BC.low); }
-void Z80::OP_DEC_D() { DEC_r(DE.high); }
-void Z80::OP_DEC_E() { DEC_r(DE.low); }
-void Z80::OP_DEC_H() { DEC_r(HL.high); }
-void Z80::OP_DEC_L() { DEC_r(HL.low); }
-
-// LD R,n opcodes
-void Z80::OP_LD_A_n() { LD_r_n(A); }
-void Z80::OP_LD_B_n() { LD_r_n(BC.high); }
-void Z80::OP_LD_C_n() { LD_r_n(BC.low); }
-void Z80::OP_LD_D_n() { LD_r_n(DE.high); }
-void Z80::OP_LD_E_n() { LD_r_n(DE.low); }
-void Z80::OP_LD_H_n() { LD_r_n(HL.high); }
-void Z80::OP_LD_L_n() { LD_r_n(HL.low); }
-
-// ADD A, r opcodes
-void Z80::OP_ADD_A_A() { ADD_A_r(A); }
-void Z80::OP_ADD_A_B() { ADD_A_r(BC.high); }
-void Z80::OP_ADD_A_C() { ADD_A_r(BC.low); }
-void Z80::OP_ADD_A_D() { ADD_A_r(DE.high); }
-void Z80::OP_ADD_A_E() { ADD_A_r(DE.low); }
-void Z80::OP_ADD_A_H() { ADD_A_r(HL.high); }
-void Z80::OP_ADD_A_L() { ADD_A_r(HL.low); }
-void Z80::OP_ADD_A_HL()
-{
-    ADD_A_r(m_memory->Read(HL.pair));
-    m_cyclesLastInstruction = 7;
+template<uint16_t Z80::*XY, int Dst, int Src>
+void Z80::OP_XY_LD_r_r()
+{
+    if constexpr (Dst == 6 && Src == 6) {
+        // 0x76: HALT con prefisso ignorato
+        OP_XY_Ignored();
+    }
+    else if constexpr (Src == 6) {
+        Reg8<Dst>() = m_memory->Read(IndexAddress<XY>());
+        m_cyclesLastInstruction = 19;
+    }
+    else if constexpr (Dst == 6) {
+        m_memory->Write(IndexAddress<XY>(), Reg8<Src>());
+        m_cyclesLastInstruction = 19;
+    }
+    else {
+        RegXY8<XY, Dst>() = RegXY8<XY, Src>();
+        m_cyclesLastInstruction = 8;
+    }
 }
 
-// SUB A, r opcodes
-void Z80::OP_SUB_A_A() { SUB_A_r(A); }
-void Z80::OP_SUB_A_B() { SUB_A_r(BC.high); }
-void Z80::OP_SUB_A_C() { SUB_A_r(BC.low); }
-void Z80::OP_SUB_A_D() { SUB_A_r(DE.high); }
-void Z80::OP_SUB_A_E() { SUB_A_r(DE.low); }
-void Z80::OP_SUB_A_H() { SUB_A_r(HL.high); }
-void Z80::OP_SUB_A_L() { SUB_A_r(HL.low); }
-void Z80::OP_SUB_A_HL()
+template<uint16_t Z80::*XY, int Operation, int Src>
+void Z80::OP_XY_ALU_r()
 {
-    SUB_A_r(m_memory->Read(HL.pair));
-    m_cyclesLastInstruction = 7;
+    if constexpr (Src == 6) {
+        ALU_A<Operation>(m_memory->Read(IndexAddress<XY>()));
+        m_cyclesLastInstruction = 19;
+    }
+    else {
+        ALU_A<Operation>(RegXY8<XY, Src>());
+        m_cyclesLastInstruction = 8;
+    }
+}
+
+template<uint16_t Z80::*XY, int Reg>
+void Z80::OP_XY_INC_r()
+{
+    if constexpr (Reg == 6) {
+        INC_Memory(IndexAddress<XY>());
+        m_cyclesLastInstruction = 23;
+    }
+    else {
+        INC_r(RegXY8<XY, Reg>());
+        m_cyclesLastInstruction = 8;
+    }
+}
+
+template<uint16_t Z80::*XY, int Reg>
+void Z80::OP_XY_DEC_r()
+{
+    if constexpr (Reg == 6) {
+        DEC_Memory(IndexAddress<XY>());
+        m_cyclesLastInstruction = 23;
+    }
+    else {
+        DEC_r(RegXY8<XY, Reg>());
+        m_cyclesLastInstruction = 8;
+    }
+}
+
+template<uint16_t Z80::*XY, int Reg>
+void Z80::OP_XY_LD_r_n()
+{
+    if constexpr (Reg == 6) {
+        // Lo spiazzamento precede il valore immediato
+        uint16_t address = IndexAddress<XY>();
+        m_memory->Write(address, FetchByte());
+        m_cyclesLastInstruction = 19;
+    }
+    else {
+        LD_r_n(RegXY8<XY, Reg>());
+        m_cyclesLastInstruction = 11;
+    }
+}
+
+template<uint16_t Z80::*XY, int Src>
+void Z80::OP_XY_ADD_rr()
+{
+    // Coppie BC, DE, XY, SP
+    if constexpr (Src == 2) {
+        ADD_XY_rr(this->*XY, this->*XY);
+    }
+    else {
+        ADD_XY_rr(this->*XY, Reg16<Src>());
+    }
+}
+
+template<uint16_t Z80::*XY>
+void Z80::OP_XY_LD_nn()
+{
+    LD_rr_nn(this->*XY);
+    m_cyclesLastInstruction = 14;
+}
+
+template<uint16_t Z80::*XY>
+void Z80::OP_XY_LD_pnn_XY() { LD_pnn_rr(&(this->*XY)); }
+
+template<uint16_t Z80::*XY>
+void Z80::OP_XY_LD_XY_pnn() { LD_rr_pnn(&(this->*XY)); }
+
+template<uint16_t Z80::*XY>
+void Z80::OP_XY_INC()
+{
+    INC_rr(this->*XY);
+    m_cyclesLastInstruction = 10;
+}
+
+template<uint16_t Z80::*XY>
+void Z80::OP_XY_DEC()
+{
+    DEC_rr(this->*XY);
+    m_cyclesLastInstruction = 10;
+}
+
+template<uint16_t Z80::*XY>
+void Z80::OP_XY_PUSH()
+{
+    PUSH_16bit(this->*XY);
+    m_cyclesLastInstruction = 15;
+}
+
+template<uint16_t Z80::*XY>
+void Z80::OP_XY_POP()
+{
+    this->*XY = POP_16bit();
+    m_cyclesLastInstruction = 14;
+}
+
+template<uint16_t Z80::*XY>
+void Z80::OP_XY_EX_pSP()
+{
+    uint16_t value = POP_16bit();
+    PUSH_16bit(this->*XY);
+    this->*XY = value;
+    m_cyclesLastInstruction = 23;
+}
+
+template<uint16_t Z80::*XY>
+void Z80::OP_XY_JP()
+{
+    PC = this->*XY;
+    m_cyclesLastInstruction = 8;
+}
+
+template<uint16_t Z80::*XY>
+void Z80::OP_XY_LD_SP()
+{
+    SP = this->*XY;
+    m_cyclesLastInstruction = 10;
+}
+
+template<uint16_t Z80::*XY>
+void Z80::OP_XY_CB_Prefix()
+{
+    // DD CB d op: lo spiazzamento viene prima dell'opcode
+    uint16_t address = IndexAddress<XY>();
+    uint8_t cb_opcode = FetchByte();
+    (this->*s_indexCBTable[cb_opcode])(address);
+}
+
+// ========== DDCB/FDCB: operazioni CB su (IX+d)/(IY+d) ==========
+// L'indirizzo lo calcola il prefisso, quindi una sola tabella serve IX e IY.
+// Se il campo registro non e' (HL) il risultato finisce anche nel registro
+// (comportamento non documentato ma stabile).
+
+template<int Operation, int Reg>
+void Z80::OP_XYCB_Rotate(uint16_t address)
+{
+    uint8_t value = m_memory->Read(address);
+    RotateShift<Operation>(value);
+    m_memory->Write(address, value);
+    if constexpr (Reg != 6) Reg8<Reg>() = value;
+
+    m_cyclesLastInstruction = 23;
+}
+
+template<int Bit>
+void Z80::OP_XYCB_BIT(uint16_t address)
+{
+    BIT_n<Bit>(m_memory->Read(address));
+    m_cyclesLastInstruction = 20;
+}
+
+template<int Bit, int Reg>
+void Z80::OP_XYCB_RES(uint16_t address)
+{
+    uint8_t value = m_memory->Read(address) & ~(1 << Bit);
+    m_memory->Write(address, value);
+    if constexpr (Reg != 6) Reg8<Reg>() = value;
+
+    m_cyclesLastInstruction = 23;
+}
+
+template<int Bit, int Reg>
+void Z80::OP_XYCB_SET(uint16_t address)
+{
+    uint8_t value = m_memory->Read(address) | (1 << Bit);
+    m_memory->Write(address, value);
+    if constexpr (Reg != 6) Reg8<Reg>() = value;
+
+    m_cyclesLastInstruction = 23;
+}
+
+// ========== Prefisso ED ==========
+
+void Z80::OP_ED_NOP()
+{
+    // Opcode ED non definiti: NOP da 8 cicli
+    m_cyclesLastInstruction = 8;
+}
+
+template<int Reg>
+void Z80::OP_ED_IN_r_C()
+{
+    uint8_t value = ReadPort(BC.low);
+
+    // 0x70 (IN F,(C)) aggiorna solo i flag
+    if constexpr (Reg != 6) Reg8<Reg>() = value;
+    F = (F & FLAG_C) | g_z80Flags.szp[value];
+
+    m_cyclesLastInstruction = 12;
+}
+
+template<int Reg>
+void Z80::OP_ED_OUT_C_r()
+{
+    // 0x71 scrive 0
+    if constexpr (Reg == 6) WritePort(BC.low, 0);
+    else WritePort(BC.low, Reg8<Reg>());
+
+    m_cyclesLastInstruction = 12;
 }
 
-void Z80::OP_LD_r_r()
-{
-    uint8_t opcode = m_memory->Read(PC - 1);
-    if (opcode == 0x76) {
-        OP_HALT();
-        return;
-    }
+template<int Reg>
+void Z80::OP_ED_SBC_HL() { SBC_HL(&Reg16<Reg>()); }
+
+template<int Reg>
+void Z80::OP_ED_ADC_HL() { ADC_HL(&Reg16<Reg>()); }
+
+template<int Reg>
+void Z80::OP_ED_LD_pnn_rr() { LD_pnn_rr(&Reg16<Reg>()); }
+
+template<int Reg>
+void Z80::OP_ED_LD_rr_pnn() { LD_rr_pnn(&Reg16<Reg>()); }
+
+template<int Mode>
+void Z80::OP_ED_IM()
+{
+    m_interruptMode = Mode;
+    m_cyclesLastInstruction = 8;
+}
+
+void Z80::OP_ED_LD_I_A()
+{
+    I = A;
+    m_cyclesLastInstruction = 9;
+}
+
+void Z80::OP_ED_LD_R_A()
+{
+    R = A;
+    m_cyclesLastInstruction = 9;
+}
+
+void Z80::OP_ED_LD_A_I()
+{
+    // P/V = IFF2, che qui coincide con lo stato degli interrupt
+    A = I;
+    F = (F & FLAG_C) | (g_z80Flags.szp[A] & ~FLAG_PV) | (m_interruptsEnabled ? FLAG_PV : 0);
+    m_cyclesLastInstruction = 9;
+}
+
+void Z80::OP_ED_LD_A_R()
+{
+    A = R;
+    F = (F & FLAG_C) | (g_z80Flags.szp[A] & ~FLAG_PV) | (m_interruptsEnabled ? FLAG_PV : 0);
+    m_cyclesLastInstruction = 9;
+}
+
+void Z80::OP_ED_RRD()
+{
+    // Rotazione a destra di 4 bit tra il nibble basso di A e (HL)
+    uint8_t value = m_memory->Read(HL.pair);
+    m_memory->Write(HL.pair, (uint8_t)((A << 4) | (value >> 4)));
+    A = (A & 0xF0) | (value & 0x0F);
+    F = (F & FLAG_C) | g_z80Flags.szp[A];
+
+    m_cyclesLastInstruction = 18;
+}
+
+void Z80::OP_ED_RLD()
+{
+    uint8_t value = m_memory->Read(HL.pair);
+    m_memory->Write(HL.pair, (uint8_t)((value << 4) | (A & 0x0F)));
+    A = (A & 0xF0) | (value >> 4);
+    F = (F & FLAG_C) | g_z80Flags.szp[A];
+
+    m_cyclesLastInstruction = 18;
+}
+
+template<int Step, bool Repeat>
+void Z80::OP_ED_BlockIn()
+{
+    // INI/IND/INIR/INDR: Z se B arriva a 0, N = 1 (gli altri flag non sono documentati)
+    m_memory->Write(HL.pair, ReadPort(BC.low));
+    HL.pair += Step;
+    BC.high--;
+    F = (F & FLAG_C) | (g_z80Flags.szp[BC.high] & ~FLAG_PV) | FLAG_N;
+
+    if (Repeat && BC.high != 0) {
+        PC -= 2;
+        m_cyclesLastInstruction = 21;
+    }
+    else {
+        m_cyclesLastInstruction = 16;
+    }
+}
+
+template<int Step, bool Repeat>
+void Z80::OP_ED_BlockOut()
+{
+    // OUTI/OUTD/OTIR/OTDR: B viene decrementato prima della scrittura
+    uint8_t value = m_memory->Read(HL.pair);
+    BC.high--;
+    WritePort(BC.low, value);
+    HL.pair += Step;
+    F = (F & FLAG_C) | (g_z80Flags.szp[BC.high] & ~FLAG_PV) | FLAG_N;
+
+    if (Repeat && BC.high != 0) {
+        PC -= 2;
+        m_cyclesLastInstruction = 21;
+    }
+    else {
+        m_cyclesLastInstruction = 16;
+    }
+}
+
+// ========== Tabelle di dispatch ==========
+// Costruite a compile time: nessuna inizializzazione nel costruttore e
+// nessuna decodifica a runtime dei campi registro/operazione.
+
+constexpr std::array<Z80::OpcodeFunction, 256> Z80::BuildOpcodeTable()
+{
+    std::array<OpcodeFunction, 256> table{};
+
+    // Riempi tutto con "non implementato"
+    for (auto &entry : table) {
+        entry = &Z80::OP_NotImplemented;
+    }
+
+    // NOP
+    table[0x00] = &Z80::OP_NOP;
+
+    // INC r, DEC r, LD r,n: registro nei bit 3-5 (6 = (HL))
+    [&]<int... R>(std::integer_sequence<int, R...>) {
+        ((table[(R << 3) | 0x04] = &Z80::OP_INC_r<R>), ...);
+        ((table[(R << 3) | 0x05] = &Z80::OP_DEC_r<R>), ...);
+    }(std::make_integer_sequence<int, 8>{});
+    [&]<int... R>(std::integer_sequence<int, R...>) {
+        ((table[(R << 3) | 0x06] = &Z80::OP_LD_r_n<R>), ...);
+    }(std::integer_sequence<int, 0, 1, 2, 3, 4, 5, 7>{});
+    table[0x36] = &Z80::OP_LD_HL_n;
+
+    // LD r,r' (0x40-0x7F) e ALU A,r (0x80-0xBF): destinazione o operazione
+    // nei bit 3-5, sorgente nei bit 0-2
+    [&]<int... I>(std::integer_sequence<int, I...>) {
+        ((table[0x40 + I] = &Z80::OP_LD_r_r<(I >> 3), (I & 7)>), ...);
+        ((table[0x80 + I] = &Z80::OP_ALU_r<(I >> 3), (I & 7)>), ...);
+    }(std::make_integer_sequence<int, 64>{});
+
+    // Jump assoluti
+    table[0xC3] = &Z80::OP_JP_nn;
+    table[0xCA] = &Z80::OP_JP_Z_nn;
+    table[0xC2] = &Z80::OP_JP_NZ_nn;
+    table[0xDA] = &Z80::OP_JP_C_nn;
+    table[0xD2] = &Z80::OP_JP_NC_nn;
+    table[0xE2] = &Z80::OP_JP_PO_nn;
+    table[0xEA] = &Z80::OP_JP_PE_nn;
+    table[0xF2] = &Z80::OP_JP_P_nn;
+
+    // Jump relativi
+    table[0x18] = &Z80::OP_JR_e;
+    table[0x28] = &Z80::OP_JR_Z_e;
+    table[0x20] = &Z80::OP_JR_NZ_e;
+    table[0x38] = &Z80::OP_JR_C_e;
+    table[0x30] = &Z80::OP_JR_NC_e;
+
+    // Call/ret
+    table[0xCD] = &Z80::OP_CALL_nn;
+    table[0xCC] = &Z80::OP_CALL_Z_nn;
+    table[0xC4] = &Z80::OP_CALL_NZ_nn;
+    table[0xDC] = &Z80::OP_CALL_C_nn;
+    table[0xD4] = &Z80::OP_CALL_NC_nn;
+    table[0xE4] = &Z80::OP_CALL_PO_nn;
+    table[0xEC] = &Z80::OP_CALL_PE_nn;
+    table[0xF4] = &Z80::OP_CALL_P_nn;
+    table[0xFC] = &Z80::OP_CALL_M_nn;
+    table[0xC9] = &Z80::OP_RET;
+    table[0xC8] = &Z80::OP_RET_Z;
+    table[0xC0] = &Z80::OP_RET_NZ;
+    table[0xD8] = &Z80::OP_RET_C;
+    table[0xD0] = &Z80::OP_RET_NC;
+    table[0xE0] = &Z80::OP_RET_PO;
+    table[0xE8] = &Z80::OP_RET_PE;
+    table[0xF0] = &Z80::OP_RET_P;
+    table[0xF8] = &Z80::OP_RET_M;
+
+    // Push/Pop
+    table[0xC5] = &Z80::OP_PUSH_BC;
+    table[0xD5] = &Z80::OP_PUSH_DE;
+    table[0xE5] = &Z80::OP_PUSH_HL;
+    table[0xF5] = &Z80::OP_PUSH_AF;
+    table[0xC1] = &Z80::OP_POP_BC;
+    table[0xD1] = &Z80::OP_POP_DE;
+    table[0xE1] = &Z80::OP_POP_HL;
+    table[0xF1] = &Z80::OP_POP_AF;
+
+    // LD rr,nn
+    table[0x01] = &Z80::OP_LD_BC_nn;
+    table[0x11] = &Z80::OP_LD_DE_nn;
+    table[0x21] = &Z80::OP_LD_HL_nn;
+    table[0x31] = &Z80::OP_LD_SP_nn;
+
+    // INC rr
+    table[0x03] = &Z80::OP_INC_BC;
+    table[0x13] = &Z80::OP_INC_DE;
+    table[0x23] = &Z80::OP_INC_HL;
+    table[0x33] = &Z80::OP_INC_SP;
+
+    // DEC rr
+    table[0x0B] = &Z80::OP_DEC_BC;
+    table[0x1B] = &Z80::OP_DEC_DE;
+    table[0x2B] = &Z80::OP_DEC_HL;
+    table[0x3B] = &Z80::OP_DEC_SP;
+
+    // ADD hL, rr
+    table[0x09] = &Z80::OP_ADD_HL_BC;
+    table[0x19] = &Z80::OP_ADD_HL_DE;
+    table[0x29] = &Z80::OP_ADD_HL_HL;
+    table[0x39] = &Z80::OP_ADD_HL_SP;
+
+    // LD Special
+    table[0x0A] = &Z80::OP_LD_A_BC;
+    table[0x1A] = &Z80::OP_LD_A_DE;
+    table[0x02] = &Z80::OP_LD_BC_A;
+    table[0x12] = &Z80::OP_LD_DE_A;
+    table[0x3A] = &Z80::OP_LD_A_nn;
+    table[0x32] = &Z80::OP_LD_nn_A;
+
+    // Operation Immediate
+    table[0xC6] = &Z80::OP_ADD_n;
+    table[0xD6] = &Z80::OP_SUB_n;
+    table[0xE6] = &Z80::OP_AND_n;
+    table[0xEE] = &Z80::OP_XOR_n;
+    table[0xF6] = &Z80::OP_OR_n;
+    table[0xFE] = &Z80::OP_CP_n;
+
+    table[0xCE] = &Z80::OP_ADC_A_n;
+    table[0xDE] = &Z80::OP_SBC_A_n;
+
+    // LD 16-bit
+    table[0x2A] = &Z80::OP_LD_HL_pnn;
+    table[0x22] = &Z80::OP_LD_pnn_HL;
+    table[0xF9] = &Z80::OP_LD_SP_HL;
+
+    // CB
+    table[0xCB] = &Z80::OP_CB_Prefix;
+
+    // ED
+    table[0xED] = &Z80::OP_ED_Prefix;
+
+    // DD
+    table[0xDD] = &Z80::OP_DD_Prefix;
 
-    uint8_t dest = (opcode & 0x38) >> 3;
-    uint8_t src = opcode & 0x07;
+    // FD
+    table[0xFD] = &Z80::OP_FD_Prefix;
 
-    if (src == 6) {
-        // Lettura dalla memoria
-        *m_registerMap[dest] = m_memory->Read(HL.pair);
-        m_cyclesLastInstruction = 7;
-    }
-    else if (dest == 6) {
-        // Scrittura in memoria
-        m_memory->Write(HL.pair, *m_registerMap[src]);
-        m_cyclesLastInstruction = 7;
-    }
-    else {
-        // Entrambi registri normali
-        *m_registerMap[dest] = *m_registerMap[src];
-        m_cyclesLastInstruction = 4;
-    }
-  }
+    // RST
+    table[0xC7] = &Z80::OP_RST_00;
+    table[0xCF] = &Z80::OP_RST_08;
+    table[0xD7] = &Z80::OP_RST_10;
+    table[0xDF] = &Z80::OP_RST_18;
+    table[0xE7] = &Z80::OP_RST_20;
+    table[0xEF] = &Z80::OP_RST_28;
+    table[0xF7] = &Z80::OP_RST_30;
+    table[0xFF] = &Z80::OP_RST_38;
+
+    table[0xEB] = &Z80::OP_EX_DE_HL;
+    table[0x08] = &Z80::OP_EX_AF_AF;
+    table[0xE3] = &Z80::OP_EX_pSP_HL;
+    table[0x27] = &Z80::OP_DAA;
+    table[0xE9] = &Z80::OP_JP_HL;
+
+    table[0xF3] = &Z80::OP_DI;
+    table[0x10] = &Z80::OP_DJNZ;
+
+    table[0xD3] = &Z80::OP_OUT_n_A;
+    table[0xDB] = &Z80::OP_IN_A_n;
+    table[0xFB] = &Z80::OP_EI;
+    table[0xFA] = &Z80::OP_JP_M_nn;
+    table[0x0F] = &Z80::OP_RRCA;
+    table[0xD9] = &Z80::OP_EXX;
+    table[0x2F] = &Z80::OP_CPL;
+    table[0x07] = &Z80::OP_RLCA;
+    table[0x17] = &Z80::OP_RLA;
+    table[0x1F] = &Z80::OP_RRA;
+    table[0x3F] = &Z80::OP_CCF;
+    table[0x37] = &Z80::OP_SCF;
+
+    return table;
+}
+
+constexpr std::array<Z80::OpcodeFunction, 256> Z80::BuildCBTable()
+{
+    std::array<OpcodeFunction, 256> table{};
+
+    // 0x00-0x3F rotazioni e shift, 0x40-0xFF BIT/RES/SET: operazione o bit
+    // nei bit 3-5, registro nei bit 0-2
+    [&]<int... I>(std::integer_sequence<int, I...>) {
+        ((table[0x00 + I] = &Z80::OP_CB_Rotate<(I >> 3), (I & 7)>), ...);
+        ((table[0x40 + I] = &Z80::OP_CB_BIT<(I >> 3), (I & 7)>), ...);
+        ((table[0x80 + I] = &Z80::OP_CB_RES<(I >> 3), (I & 7)>), ...);
+        ((table[0xC0 + I] = &Z80::OP_CB_SET<(I >> 3), (I & 7)>), ...);
+    }(std::make_integer_sequence<int, 64>{});
+
+    return table;
+}
+
+constexpr std::array<Z80::OpcodeFunction, 256> Z80::BuildEDTable()
+{
+    std::array<OpcodeFunction, 256> table{};
+    table.fill(&Z80::OP_ED_NOP);
+
+    // 0x40-0x7F: registro a 8 bit nei bit 3-5, coppia a 16 bit nei bit 4-5
+    [&]<int... R>(std::integer_sequence<int, R...>) {
+        ((table[0x40 + (R << 3)] = &Z80::OP_ED_IN_r_C<R>), ...);
+        ((table[0x41 + (R << 3)] = &Z80::OP_ED_OUT_C_r<R>), ...);
+        ((table[0x44 + (R << 3)] = &Z80::NEG), ...);
+    }(std::make_integer_sequence<int, 8>{});
+
+    [&]<int... P>(std::integer_sequence<int, P...>) {
+        ((table[0x42 + (P << 4)] = &Z80::OP_ED_SBC_HL<P>), ...);
+        ((table[0x43 + (P << 4)] = &Z80::OP_ED_LD_pnn_rr<P>), ...);
+        ((table[0x4A + (P << 4)] = &Z80::OP_ED_ADC_HL<P>), ...);
+        ((table[0x4B + (P << 4)] = &Z80::OP_ED_LD_rr_pnn<P>), ...);
+        // RETN e RETI: senza NMI (IFF2 non e' modellato) coincidono
+        ((table[0x45 + (P << 4)] = &Z80::OP_RETI), ...);
+        ((table[0x4D + (P << 4)] = &Z80::OP_RETI), ...);
+    }(std::make_integer_sequence<int, 4>{});
+
+    table[0x46] = &Z80::OP_ED_IM<0>;
+    table[0x4E] = &Z80::OP_ED_IM<0>;
+    table[0x66] = &Z80::OP_ED_IM<0>;
+    table[0x6E] = &Z80::OP_ED_IM<0>;
+    table[0x56] = &Z80::OP_ED_IM<1>;
+    table[0x76] = &Z80::OP_ED_IM<1>;
+    table[0x5E] = &Z80::OP_ED_IM<2>;
+    table[0x7E] = &Z80::OP_ED_IM<2>;
+
+    table[0x47] = &Z80::OP_ED_LD_I_A;
+    table[0x4F] = &Z80::OP_ED_LD_R_A;
+    table[0x57] = &Z80::OP_ED_LD_A_I;
+    table[0x5F] = &Z80::OP_ED_LD_A_R;
+    table[0x67] = &Z80::OP_ED_RRD;
+    table[0x6F] = &Z80::OP_ED_RLD;
+
+    // Istruzioni a blocchi
+    table[0xA0] = &Z80::LDI;
+    table[0xA1] = &Z80::CPI;
+    table[0xA2] = &Z80::OP_ED_BlockIn<1, false>;
+    table[0xA3] = &Z80::OP_ED_BlockOut<1, false>;
+    table[0xA8] = &Z80::LDD;
+    table[0xA9] = &Z80::CPD;
+    table[0xAA] = &Z80::OP_ED_BlockIn<-1, false>;
+    table[0xAB] = &Z80::OP_ED_BlockOut<-1, false>;
+    table[0xB0] = &Z80::LDIR;
+    table[0xB1] = &Z80::CPIR;
+    table[0xB2] = &Z80::OP_ED_BlockIn<1, true>;
+    table[0xB3] = &Z80::OP_ED_BlockOut<1, true>;
+    table[0xB8] = &Z80::LDDR;
+    table[0xB9] = &Z80::CPDR;
+    table[0xBA] = &Z80::OP_ED_BlockIn<-1, true>;
+    table[0xBB] = &Z80::OP_ED_BlockOut<-1, true>;
+
+    return table;
+}
+
+template<uint16_t Z80::*XY>
+constexpr std::array<Z80::OpcodeFunction, 256> Z80::BuildIndexTable()
+{
+    std::array<OpcodeFunction, 256> table{};
+
+    // Tutto cio' che non tocca HL esegue l'istruzione senza prefisso
+    table.fill(&Z80::OP_XY_Ignored);
+
+    [&]<int... I>(std::integer_sequence<int, I...>) {
+        ((table[0x40 + I] = &Z80::OP_XY_LD_r_r<XY, (I >> 3), (I & 7)>), ...);
+        ((table[0x80 + I] = &Z80::OP_XY_ALU_r<XY, (I >> 3), (I & 7)>), ...);
+    }(std::make_integer_sequence<int, 64>{});
+
+    [&]<int... P>(std::integer_sequence<int, P...>) {
+        ((table[0x09 + (P << 4)] = &Z80::OP_XY_ADD_rr<XY, P>), ...);
+    }(std::make_integer_sequence<int, 4>{});
+
+    // H, L e (HL) nelle istruzioni con il registro nei bit 3-5
+    table[0x24] = &Z80::OP_XY_INC_r<XY, 4>;
+    table[0x2C] = &Z80::OP_XY_INC_r<XY, 5>;
+    table[0x34] = &Z80::OP_XY_INC_r<XY, 6>;
+    table[0x25] = &Z80::OP_XY_DEC_r<XY, 4>;
+    table[0x2D] = &Z80::OP_XY_DEC_r<XY, 5>;
+    table[0x35] = &Z80::OP_XY_DEC_r<XY, 6>;
+    table[0x26] = &Z80::OP_XY_LD_r_n<XY, 4>;
+    table[0x2E] = &Z80::OP_XY_LD_r_n<XY, 5>;
+    table[0x36] = &Z80::OP_XY_LD_r_n<XY, 6>;
+
+    table[0x21] = &Z80::OP_XY_LD_nn<XY>;
+    table[0x22] = &Z80::OP_XY_LD_pnn_XY<XY>;
+    table[0x2A] = &Z80::OP_XY_LD_XY_pnn<XY>;
+    table[0x23] = &Z80::OP_XY_INC<XY>;
+    table[0x2B] = &Z80::OP_XY_DEC<XY>;
+    table[0xCB] = &Z80::OP_XY_CB_Prefix<XY>;
+    table[0xE1] = &Z80::OP_XY_POP<XY>;
+    table[0xE3] = &Z80::OP_XY_EX_pSP<XY>;
+    table[0xE5] = &Z80::OP_XY_PUSH<XY>;
+    table[0xE9] = &Z80::OP_XY_JP<XY>;
+    table[0xF9] = &Z80::OP_XY_LD_SP<XY>;
+
+    return table;
+}
+
+constexpr std::array<Z80::IndexedCBFunction, 256> Z80::BuildIndexCBTable()
+{
+    std::array<IndexedCBFunction, 256> table{};
+
+    // Stessa codifica della tabella CB; BIT non scrive, il registro e' ignorato
+    [&]<int... I>(std::integer_sequence<int, I...>) {
+        ((table[0x00 + I] = &Z80::OP_XYCB_Rotate<(I >> 3), (I & 7)>), ...);
+        ((table[0x40 + I] = &Z80::OP_XYCB_BIT<(I >> 3)>), ...);
+        ((table[0x80 + I] = &Z80::OP_XYCB_RES<(I >> 3), (I & 7)>), ...);
+        ((table[0xC0 + I] = &Z80::OP_XYCB_SET<(I >> 3), (I & 7)>), ...);
+    }(std::make_integer_sequence<int, 64>{});
+
+    return table;
+}
+
+constinit const std::array<Z80::OpcodeFunction, 256> Z80::s_opcodeTable = Z80::BuildOpcodeTable();
+constinit const std::array<Z80::OpcodeFunction, 256> Z80::s_cbTable = Z80::BuildCBTable();
+constinit const std::array<Z80::OpcodeFunction, 256> Z80::s_edTable = Z80::BuildEDTable();
+constinit const std::array<Z80::OpcodeFunction, 256> Z80::s_ddTable = Z80::BuildIndexTable<&Z80::IX>();
+constinit const std::array<Z80::OpcodeFunction, 256> Z80::s_fdTable = Z80::BuildIndexTable<&Z80::IY>();
+constinit const std::array<Z80::IndexedCBFunction, 256> Z80::s_indexCBTable = Z80::BuildIndexCBTable();
 
 void Z80::OP_HALT()
 {
-    printf("Esecuzione opcode HALT");
     m_halted = true;
     m_cyclesLastInstruction = 4;
 }
@@ -408,8 +933,8 @@ void Z80::OP_HALT()
 void Z80::OP_JP_nn()
 {
     // Leggi dalla memoria l'indirizzo della call
-    uint8_t low = m_memory->Read(PC++);
-    uint8_t high = m_memory->Read(PC++);
+    uint8_t low = FetchByte();
+    uint8_t high = FetchByte();
 
     PC = (high << 8) | low;
 
@@ -424,9 +949,15 @@ void Z80::OP_JP_C_nn() { JP_nn_conditional(FLAG_C, true); }
 
 void Z80::OP_JP_NC_nn() { JP_nn_conditional(FLAG_C, false); }
 
+void Z80::OP_JP_PO_nn() { JP_nn_conditional(FLAG_PV, false); }
+
+void Z80::OP_JP_PE_nn() { JP_nn_conditional(FLAG_PV, true); }
+
+void Z80::OP_JP_P_nn() { JP_nn_conditional(FLAG_S, false); }
+
 void Z80::OP_JR_e()
 {
-    uint8_t offset_unsigned = m_memory->Read(PC++);
+    uint8_t offset_unsigned = FetchByte();
     int8_t offset = static_cast<int8_t>(offset_unsigned);
 
     PC += offset;
@@ -442,67 +973,11 @@ void Z80::OP_JR_C_e() { JR_conditional(FLAG_C, true); }
 
 void Z80::OP_JR_NC_e() { JR_conditional(FLAG_C, false); }
 
-// ========== AND A,r opcodes ==========
-void Z80::OP_AND_A_A() { AND_A_r(A); }
-void Z80::OP_AND_A_B() { AND_A_r(BC.high); }
-void Z80::OP_AND_A_C() { AND_A_r(BC.low); }
-void Z80::OP_AND_A_D() { AND_A_r(DE.high); }
-void Z80::OP_AND_A_E() { AND_A_r(DE.low); }
-void Z80::OP_AND_A_H() { AND_A_r(HL.high); }
-void Z80::OP_AND_A_L() { AND_A_r(HL.low); }
-void Z80::OP_AND_A_HL()
-{
-    AND_A_r(m_memory->Read(HL.pair));
-    m_cyclesLastInstruction = 7;
-}
-
-// ========== XOR A,r opcodes ==========
-void Z80::OP_XOR_A_A() { XOR_A_r(A); }
-void Z80::OP_XOR_A_B() { XOR_A_r(BC.high); }
-void Z80::OP_XOR_A_C() { XOR_A_r(BC.low); }
-void Z80::OP_XOR_A_D() { XOR_A_r(DE.high); }
-void Z80::OP_XOR_A_E() { XOR_A_r(DE.low); }
-void Z80::OP_XOR_A_H() { XOR_A_r(HL.high); }
-void Z80::OP_XOR_A_L() { XOR_A_r(HL.low); }
-void Z80::OP_XOR_A_HL()
-{
-    XOR_A_r(m_memory->Read(HL.pair));
-    m_cyclesLastInstruction = 7;
-}
-
-// ========== OR A,r opcodes ==========
-void Z80::OP_OR_A_A() { OR_A_r(A); }
-void Z80::OP_OR_A_B() { OR_A_r(BC.high); }
-void Z80::OP_OR_A_C() { OR_A_r(BC.low); }
-void Z80::OP_OR_A_D() { OR_A_r(DE.high); }
-void Z80::OP_OR_A_E() { OR_A_r(DE.low); }
-void Z80::OP_OR_A_H() { OR_A_r(HL.high); }
-void Z80::OP_OR_A_L() { OR_A_r(HL.low); }
-void Z80::OP_OR_A_HL()
-{
-    OR_A_r(m_memory->Read(HL.pair));
-    m_cyclesLastInstruction = 7;
-}
-
-// ========== CP A,r opcodes ==========
-void Z80::OP_CP_A_A() { CP_A_r(A); }
-void Z80::OP_CP_A_B() { CP_A_r(BC.high); }
-void Z80::OP_CP_A_C() { CP_A_r(BC.low); }
-void Z80::OP_CP_A_D() { CP_A_r(DE.high); }
-void Z80::OP_CP_A_E() { CP_A_r(DE.low); }
-void Z80::OP_CP_A_H() { CP_A_r(HL.high); }
-void Z80::OP_CP_A_L() { CP_A_r(HL.low); }
-void Z80::OP_CP_A_HL()
-{
-    CP_A_r(m_memory->Read(HL.pair));
-    m_cyclesLastInstruction = 7;
-}
-
 void Z80::OP_CALL_nn()
 {
     // Leggi dalla memoria l'indirizzo della call
-    uint8_t low = m_memory->Read(PC++);
-    uint8_t high = m_memory->Read(PC++);
+    uint8_t low = FetchByte();
+    uint8_t high = FetchByte();
 
     // Salvo sullo stack il valore attuale di PC
     PUSH_16bit(PC);
@@ -521,6 +996,14 @@ void Z80::OP_CALL_C_nn() { CALL_conditional(FLAG_C, true); }
 
 void Z80::OP_CALL_NC_nn() { CALL_conditional(FLAG_C, false); }
 
+void Z80::OP_CALL_PO_nn() { CALL_conditional(FLAG_PV, false); }
+
+void Z80::OP_CALL_PE_nn() { CALL_conditional(FLAG_PV, true); }
+
+void Z80::OP_CALL_P_nn() { CALL_conditional(FLAG_S, false); }
+
+void Z80::OP_CALL_M_nn() { CALL_conditional(FLAG_S, true); }
+
 void Z80::OP_RET()
 {
     PC = POP_16bit();
@@ -536,6 +1019,14 @@ void Z80::OP_RET_C() { RET_conditional(FLAG_C, true); }
 
 void Z80::OP_RET_NC() { RET_conditional(FLAG_C, false); }
 
+void Z80::OP_RET_PO() { RET_conditional(FLAG_PV, false); }
+
+void Z80::OP_RET_PE() { RET_conditional(FLAG_PV, true); }
+
+void Z80::OP_RET_P() { RET_conditional(FLAG_S, false); }
+
+void Z80::OP_RET_M() { RET_conditional(FLAG_S, true); }
+
 void Z80::OP_PUSH_BC() { PUSH_rr(&BC); }
 
 void Z80::OP_PUSH_DE() { PUSH_rr(&DE); }
@@ -612,58 +1103,34 @@ void Z80::OP_LD_nn_A() { LD_addr_A(); }
 
 void Z80::OP_ADD_n()
 {
-    uint8_t n = m_memory->Read(PC++);
+    uint8_t n = FetchByte();
     ADD_A_r(n);
     m_cyclesLastInstruction = 7;
 }
 
 void Z80::OP_SUB_n()
 {
-    uint8_t n = m_memory->Read(PC++);
+    uint8_t n = FetchByte();
     SUB_A_r(n);
     m_cyclesLastInstruction = 7;
 }
 
-void Z80::OP_ADC_A_B() { ADC_A_r(BC.high); }
-void Z80::OP_ADC_A_C() { ADC_A_r(BC.low); }
-void Z80::OP_ADC_A_D() { ADC_A_r(DE.high); }
-void Z80::OP_ADC_A_E() { ADC_A_r(DE.low); }
-void Z80::OP_ADC_A_H() { ADC_A_r(HL.high); }
-void Z80::OP_ADC_A_L() { ADC_A_r(HL.low); }
-void Z80::OP_ADC_A_HL() 
-{ 
-    ADC_A_r(m_memory->Read(HL.pair));
-    m_cyclesLastInstruction = 7; 
-}
-void Z80::OP_ADC_A_A() { ADC_A_r(A); }
 void Z80::OP_ADC_A_n() 
 { 
-    ADC_A_r(m_memory->Read(PC++));
+    ADC_A_r(FetchByte());
     m_cyclesLastInstruction = 7;
 }
 
-void Z80::OP_SBC_A_B() { SBC_A_r(BC.high); }
-void Z80::OP_SBC_A_C() { SBC_A_r(BC.low); }
-void Z80::OP_SBC_A_D() { SBC_A_r(DE.high); }
-void Z80::OP_SBC_A_E() { SBC_A_r(DE.low); }
-void Z80::OP_SBC_A_H() { SBC_A_r(HL.high); }
-void Z80::OP_SBC_A_L() { SBC_A_r(HL.low); }
-void Z80::OP_SBC_A_HL() 
-{
-    SBC_A_r(m_memory->Read(HL.pair));
-    m_cyclesLastInstruction = 7;
-}
-void Z80::OP_SBC_A_A() { SBC_A_r(A); }
 void Z80::OP_SBC_A_n()
 {
-    SBC_A_r(m_memory->Read(PC++));
+    SBC_A_r(FetchByte());
     m_cyclesLastInstruction = 7;
 }
 
 void Z80::OP_LD_HL_pnn()
 {
-    uint8_t add_low = m_memory->Read(PC++);
-    uint8_t add_high = m_memory->Read(PC++);
+    uint8_t add_low = FetchByte();
+    uint8_t add_high = FetchByte();
 
     uint16_t address = ((add_high << 8) | add_low);
 
@@ -677,8 +1144,8 @@ void Z80::OP_LD_HL_pnn()
 
 void Z80::OP_LD_pnn_HL()
 {
-    uint8_t add_low = m_memory->Read(PC++);
-    uint8_t add_high = m_memory->Read(PC++);
+    uint8_t add_low = FetchByte();
+    uint8_t add_high = FetchByte();
 
     uint16_t address = ((add_high << 8) | add_low);
 
@@ -697,658 +1164,26 @@ void Z80::OP_LD_SP_HL()
 
 void Z80::OP_CB_Prefix()
 {
-    uint8_t cb_opcode = m_memory->Read(PC++);
-
-    // decode using bit pattern
-    uint8_t reg = cb_opcode & 0x07;     // bit 0-2 registro
-    uint8_t operation = cb_opcode >> 3; // bit 3-7: operazione
-
-    // Dispatch basato su operation
-    if (cb_opcode < 0x40) {
-        // 0x00 -0x3F: Rotate shift operation
-        HandleRotateShift(operation, reg);
-    }
-    else if (cb_opcode < 0x80) {
-        // 0x40-0x7F: Bit operations
-        HandleBit(operation, reg);
-    }
-    else if (cb_opcode < 0xC0) {
-        // 0x80-0xBF: RES operation
-        HandleRes(operation, reg);
-    }
-    else {
-        // oxC0-0xFF: Set operation
-        HandleSet(operation, reg);
-    }
-}
-
-void Z80::OP_ED_Prefix() 
-{
-    uint8_t ed_opcode = m_memory->Read(PC++);
-
-    // IM 0 = 0xED 0x46
-    if (ed_opcode == 0x46) {
-        m_interruptMode = 0;
-        m_cyclesLastInstruction = 8;
-        return;
-    }
-
-    if (ed_opcode == 0x47) {
-        // LD I, A
-        I = A;
-        //printf(">>> LD I, A: I = 0x%02X\n", I);
-        m_cyclesLastInstruction = 9;
-        return;
-    }
-
-    // IM 1 = 0xED 0x56
-    if (ed_opcode == 0x56) {
-        m_interruptMode = 1;
-        m_cyclesLastInstruction = 8;
-        return;
-    }
-
-    // IM 2 = 0xED 0x5E
-    if (ed_opcode == 0x5E) {
-        m_interruptMode = 2;
-        //printf(">>> IM 2 set! I register will be: 0x%02X\n", I);
-        m_cyclesLastInstruction = 8;
-        return;
-    }
-
-    // RETI = 0xED 0x4D
-    if (ed_opcode == 0x4D) {
-        OP_RETI();
-        return;
-    }
-
-    // Caso speciale per NEG (0x44)
-    if (ed_opcode == 0x44) {
-        NEG();
-        return;
-    }
-
-    // Block operation
-    if (ed_opcode == 0xA0) { LDI(); return; }
-    if (ed_opcode == 0xB0) { LDIR(); return; }
-    if (ed_opcode == 0xA8) { LDD(); return; }
-    if (ed_opcode == 0xB8) { LDDR(); return; }
-
-    // Block operations - Compare
-    if (ed_opcode == 0xA1) { CPI(); return; }
-    if (ed_opcode == 0xB1) { CPIR(); return; }
-    if (ed_opcode == 0xA9) { CPD(); return; }
-    if (ed_opcode == 0xB9) { CPDR(); return; }
-
-    // decode using bit pattern
-    uint8_t reg_index = (ed_opcode >> 4) & 0x03;     // bit 4-5 registro
-    uint8_t operation = ed_opcode & 0x0F;            // bit 0-3: operazione
-
-    // Verifica che reg_index sia valido
-    if (reg_index >= 4) return;
-
-    uint16_t *reg = m_register16Map[reg_index];
-
-    switch (operation)
-    {
-    case 0x02: { SBC_HL(reg); break; }
-    case 0x03: { LD_pnn_rr(reg); break; }
-    case 0x0A: { ADC_HL(reg); break; }
-    case 0x0B: { LD_rr_pnn(reg); break; }
-    }
-}
-
-void Z80::OP_DD_Prefix()
-{
-    uint8_t dd_opcode = m_memory->Read(PC++);
-
-    switch (dd_opcode) {
-    case 0x21: {
-        // LD IX, nn
-        LD_rr_nn(IX);
-        m_cyclesLastInstruction = 14;
-        break;
-    }
-    case 0x7E: {
-        // LD A, (IX+d)
-        LD_r_pIXOffset(A);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0x77: {
-        // LD (IX+d), A
-        LD_pIXOffset_r(A);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0x34: {
-        // INC (IX + d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint16_t address = IX + offset;
-        INC_Memory(address);
-
-        m_cyclesLastInstruction = 23;
-        break;
-    }
-    case 0x35: {
-        // DEC (IX + d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint16_t address = IX + offset;
-        DEC_Memory(address);
-
-        m_cyclesLastInstruction = 23;
-        break;
-    }
-    case 0x23: {
-        // INC IX
-        INC_rr(IX);
-
-        m_cyclesLastInstruction = 10;
-        break;
-    }
-    case 0x2B: {
-        // DEC IX
-        DEC_rr(IX);
-
-        m_cyclesLastInstruction = 10;
-        break;
-    }
-    case 0x09: {
-        // ADD IX,BC
-        ADD_IX_rr(BC.pair);
-
-        m_cyclesLastInstruction = 15;
-        break;
-    }
-    case 0x19: {
-        // ADD IX, DE
-        ADD_IX_rr(DE.pair);
-
-        m_cyclesLastInstruction = 15;
-        break;
-    }
-    case 0x29: {
-        // ADD IX, IX
-        ADD_IX_rr(IX);
-
-        m_cyclesLastInstruction = 15;
-        break;
-    }
-    case 0x39: {
-        // ADD IX, SP
-        ADD_IX_rr(SP);
-
-        m_cyclesLastInstruction = 15;
-        break;
-    }
-    case 0x6E: {
-        // LD L, (IX+d)
-        LD_r_pIXOffset(HL.low);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0x75: {
-        // LD (IX+d), L
-        LD_pIXOffset_r(HL.low);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0xA6: {
-        // AND A, (IX+d)
-        AND_r_pIXOffset(A);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0xE5: {
-        // PUSH IX
-        PUSH_16bit(IX);
-        m_cyclesLastInstruction = 15;
-        break;
-    }
-    case 0xE1: {
-        // POP IX
-        IX = POP_16bit();
-        m_cyclesLastInstruction = 14;
-        break;
-    }
-    case 0x73: {
-        // LD (IX+d), E
-        LD_pIXOffset_r(DE.low);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0x70: {
-        // LD (IX+d), B
-        LD_pIXOffset_r(BC.high);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0x36: {
-        // LD (IX+d), n
-        LD_pIXOffset_n();
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0x86: {
-        // ADD A, (IX+d)
-        ADD_r_pIXOffset();
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x66: {
-        // LD H, (IX+d)
-        // Usa la funzione helper che hai già definito per questo scopo
-        LD_r_pIXOffset(HL.high);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x46: {
-        // LD B, (IX+d)
-        LD_r_pIXOffset(BC.high);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x4E: {
-        // LD C, (IX+d)
-        LD_r_pIXOffset(BC.low);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0xCB: {
-        // DD 0xCB [offset] [cb_opcode]
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t cb_opcode = m_memory->Read(PC++);
-
-        uint8_t operation = (cb_opcode >> 3) & 0x07;  // bit 3-7: operazione
-
-        // Dispatch basato su operation (come CB normale)
-        if (cb_opcode < 0x40) {
-            // 0x00-0x3F: Rotate/Shift su (IX+d)
-            HandleRotateShift_pIXOffset(operation, offset);
-        }
-        else if (cb_opcode < 0x80) {
-            // 0x40-0x7F: BIT su (IX+d)
-            HandleBit_pIXOffset(operation, offset);
-        }
-        else if (cb_opcode < 0xC0) {
-            // 0x80-0xBF: RES su (IX+d)
-            HandleRes_pIXOffset(operation, offset);
-        }
-        else {
-            // 0xC0-0xFF: SET su (IX+d)
-            HandleSet_pIXOffset(operation, offset);
-        }
-        break;
-    }
-
-    case 0x74: {
-        // LD (IX+d), H
-        LD_pIXOffset_r(HL.high);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x71: {
-        // LD (IX+d), C
-        LD_pIXOffset_r(BC.low);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x72: {
-        // LD (IX+d), D
-        LD_pIXOffset_r(DE.high);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x96: {
-        // SUB (IX+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t value = m_memory->Read(IX + offset);
-        SUB_A_r(value);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0xBE: {
-        // CP (IX+d) - Confronto (Compare)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t value = m_memory->Read(IX + offset);
-        CP_A_r(value);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0xB6: {
-        // OR (IX+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t value = m_memory->Read(IX + offset);
-        OR_A_r(value);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0xAE: {
-        // XOR (IX+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t value = m_memory->Read(IX + offset);
-        XOR_A_r(value);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x8E: {
-        // ADC A, (IX+d) - Add with Carry
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t value = m_memory->Read(IX + offset);
-        ADC_A_r(value);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    default: {
-        std::cerr << "Unimplemented DD opcode: 0x" << std::hex
-            << std::setfill('0') << std::setw(2)
-            << (int)dd_opcode << std::dec
-            << " at PC=0x" << std::hex << (PC - 1) << std::dec << "\n";
-        m_cyclesLastInstruction = 4;
-        break;
-    }
-    }
+    uint8_t cb_opcode = FetchByte();
+    (this->*s_cbTable[cb_opcode])();
 }
 
-void Z80::OP_FD_Prefix()
-{
-    uint8_t fd_opcode = m_memory->Read(PC++);
-
-    switch (fd_opcode) {
-    case 0x21: {
-        // LD IY, nn
-        LD_rr_nn(IY);
-        m_cyclesLastInstruction = 14;
-        break;
-    }
-    case 0x7E: {
-        // LD A, (IY+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint16_t address = IY + offset;
-        A = m_memory->Read(address);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0x77: {
-        // LD (IY+d), A
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint16_t address = IY + offset;
-        m_memory->Write(address, A);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0x34: {
-        // INC (IY + d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint16_t address = IY + offset;
-        INC_Memory(address);
-
-        m_cyclesLastInstruction = 23;
-        break;
-    }
-    case 0x35: {
-        // DEC (IY + d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint16_t address = IY + offset;
-        DEC_Memory(address);
-
-        m_cyclesLastInstruction = 23;
-        break;
-    }
-    case 0x36: {
-        // LD (IX+d), n
-        LD_pIYOffset_n();
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0x23: {
-        // INC IY
-        INC_rr(IY);
-
-        m_cyclesLastInstruction = 10;
-        break;
-    }
-    case 0x2B: {
-        // DEC IY
-        DEC_rr(IY);
-
-        m_cyclesLastInstruction = 10;
-        break;
-    }
-    case 0x09: {
-        // ADD IY,BC
-        ADD_IY_rr(BC.pair);
-
-        m_cyclesLastInstruction = 15;
-        break;
-    }
-    case 0x19: {
-        // ADD IY, DE
-        ADD_IY_rr(DE.pair);
-
-        m_cyclesLastInstruction = 15;
-        break;
-    }
-    case 0x29: {
-        // ADD IY, IX
-        ADD_IY_rr(IY);
-
-        m_cyclesLastInstruction = 15;
-        break;
-    }
-    case 0x39: {
-        // ADD IY, SP
-        ADD_IY_rr(SP);
-
-        m_cyclesLastInstruction = 15;
-        break;
-    }
-    case 0xE5: {
-        // PUSH IY
-        PUSH_16bit(IY);
-        m_cyclesLastInstruction = 15;
-        break;
-    }
-    case 0x74: {
-        // LD (IY+d), H
-        LD_pIYOffset_r(HL.high);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0x75: {
-        // LD (IY+d), L
-        LD_pIYOffset_r(HL.low);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-    case 0xE1: {
-        // POP IY
-        IY = POP_16bit();
-        m_cyclesLastInstruction = 14;
-        break;
-    }
-    case 0xE9: {
-        // JP (IY) - Salta all'indirizzo contenuto in IY
-        PC = IY;
-        m_cyclesLastInstruction = 8;
-        break;
-    }
-
-    case 0xBE: {
-        // CP (IY+d) - Confronta A con memoria a (IY+offset)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t value = m_memory->Read(IY + offset);
-        CP_A_r(value);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x86: {
-        // ADD A, (IY+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t value = m_memory->Read(IY + offset);
-        ADD_A_r(value);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x96: {
-        // SUB (IY+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t value = m_memory->Read(IY + offset);
-        SUB_A_r(value);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0xA6: {
-        // AND (IY+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t value = m_memory->Read(IY + offset);
-        AND_A_r(value);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0xB6: {
-        // OR (IY+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t value = m_memory->Read(IY + offset);
-        OR_A_r(value);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0xAE: {
-        // XOR (IY+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t value = m_memory->Read(IY + offset);
-        XOR_A_r(value);
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x6E: {
-        // LD L, (IY+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint16_t address = IY + offset;
-        HL.low = m_memory->Read(address); // Scrive in L
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x66: {
-        // LD H, (IY+d)  <-- Aggiungi anche questo preventivamente!
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint16_t address = IY + offset;
-        HL.high = m_memory->Read(address); // Scrive in H
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x46: {
-        // LD B, (IY+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint16_t address = IY + offset;
-        BC.high = m_memory->Read(address); // Scrive in B
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x4E: {
-        // LD C, (IY+d)  <-- Aggiungilo preventivamente!
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint16_t address = IY + offset;
-        BC.low = m_memory->Read(address); // Scrive in C
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x5E: {
-        // LD E, (IY+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint16_t address = IY + offset;
-        DE.low = m_memory->Read(address); // Scrive in E
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    case 0x56: {
-        // LD D, (IY+d)
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint16_t address = IY + offset;
-        DE.high = m_memory->Read(address); // Scrive in D
-        m_cyclesLastInstruction = 19;
-        break;
-    }
-
-    // Gestione bit (CB) su IY - Molto importante!
-    case 0xCB: {
-        int8_t offset = (int8_t)m_memory->Read(PC++);
-        uint8_t cb_opcode = m_memory->Read(PC++);
-
-        uint8_t operation = (cb_opcode >> 3) & 0x07;
-        uint8_t bit = (cb_opcode >> 3) & 0x07; // riuso var per chiarezza bit ops
+void Z80::OP_ED_Prefix()
+{
+    uint8_t ed_opcode = FetchByte();
+    (this->*s_edTable[ed_opcode])();
+}
 
-        // Usa le funzioni helper esistenti ma adattate per IY
-        // Nota: Nel tuo codice originale usavi funzioni hardcodate su IX o variabili locali.
-        // Qui replichiamo la logica base per IY.
+void Z80::OP_DD_Prefix()
+{
+    uint8_t dd_opcode = FetchByte();
+    (this->*s_ddTable[dd_opcode])();
+}
 
-        if (cb_opcode < 0x40) {
-            // Rotate/Shift
-             // TODO: Implementare se serve (raro in PacMan su IY)
-             // HandleRotateShift_pIYOffset(operation, offset); 
-            m_cyclesLastInstruction = 23;
-        }
-        else if (cb_opcode < 0x80) {
-            // BIT b, (IY+d)
-            uint8_t val = m_memory->Read(IY + offset);
-            bool bit_val = (val & (1 << bit)) != 0;
-
-            SetFlag(FLAG_Z, !bit_val);
-            SetFlag(FLAG_H, true);
-            SetFlag(FLAG_N, false);
-            SetFlag(FLAG_PV, !bit_val);
-            SetFlag(FLAG_S, (bit == 7) && bit_val);
-
-            m_cyclesLastInstruction = 20;
-        }
-        else if (cb_opcode < 0xC0) {
-            // RES b, (IY+d)
-            uint8_t val = m_memory->Read(IY + offset);
-            val &= ~(1 << bit);
-            m_memory->Write(IY + offset, val);
-            m_cyclesLastInstruction = 23;
-        }
-        else {
-            // SET b, (IY+d)
-            uint8_t val = m_memory->Read(IY + offset);
-            val |= (1 << bit);
-            m_memory->Write(IY + offset, val);
-            m_cyclesLastInstruction = 23;
-        }
-        break;
-    }
-    default: {
-        std::cerr << "Unimplemented FD opcode: 0x" << std::hex
-            << std::setfill('0') << std::setw(2)
-            << (int)fd_opcode << std::dec
-            << " at PC=0x" << std::hex << (PC - 1) << std::dec << "\n";
-        m_cyclesLastInstruction = 4;
-        break;
-    }
-    }
+void Z80::OP_FD_Prefix()
+{
+    uint8_t fd_opcode = FetchByte();
+    (this->*s_fdTable[fd_opcode])();
 }
 
 void Z80::OP_RST_00()
@@ -1415,6 +1250,42 @@ void Z80::OP_EX_DE_HL()
     m_cyclesLastInstruction = 4;
 }
 
+void Z80::OP_EX_AF_AF()
+{
+    ExchangeAF();
+    m_cyclesLastInstruction = 4;
+}
+
+void Z80::OP_EX_pSP_HL()
+{
+    uint16_t value = POP_16bit();
+    PUSH_16bit(HL.pair);
+    HL.pair = value;
+    m_cyclesLastInstruction = 19;
+}
+
+void Z80::OP_DAA()
+{
+    // Corregge A in BCD dopo una somma (N = 0) o una sottrazione (N = 1)
+    uint8_t correction = 0;
+    bool carry = GetFlag(FLAG_C);
+
+    if (GetFlag(FLAG_H) || (A & 0x0F) > 9) {
+        correction |= 0x06;
+    }
+    if (carry || A > 0x99) {
+        correction |= 0x60;
+        carry = true;
+    }
+
+    bool subtract = GetFlag(FLAG_N);
+    bool halfCarry = subtract ? (GetFlag(FLAG_H) && (A & 0x0F) < 6) : ((A & 0x0F) > 9);
+    A = subtract ? A - correction : A + correction;
+
+    F = g_z80Flags.szp[A] | (subtract ? FLAG_N : 0) | (halfCarry ? FLAG_H : 0) | (carry ? FLAG_C : 0);
+    m_cyclesLastInstruction = 4;
+}
+
 void Z80::OP_JP_HL()
 {
     PC = HL.pair;
@@ -1433,7 +1304,7 @@ void Z80::OP_DJNZ()
 
     if (BC.high != 0) {
         // Salta: leggi offset relativo e salta
-        int8_t offset = (int8_t)m_memory->Read(PC++);
+        int8_t offset = (int8_t)FetchByte();
         PC += offset;
         m_cyclesLastInstruction = 13;  // Se salta
     }
@@ -1446,37 +1317,40 @@ void Z80::OP_DJNZ()
 
 void Z80::OP_OUT_n_A()
 {
-    uint8_t port = m_memory->Read(PC++);
-
-    if (port == 0x00) {
-        m_interruptVector = A;
-        printf(">>> OUT (0x00), A: Interrupt vector set to 0x%02X\n", A);
-    }
+    uint8_t port = FetchByte();
+    WritePort(port, A);
 
     m_cyclesLastInstruction = 11;
 }
 
 void Z80::OP_IN_A_n()
 {
-    int8_t port = m_memory->Read(PC++);
+    uint8_t port = FetchByte();
+    A = ReadPort(port);
+
+    m_cyclesLastInstruction = 11;
+}
 
+uint8_t Z80::ReadPort(uint8_t port)
+{
     // Per Pac-Man, mappa le porte sui registri memory-mapped
     switch (port) {
     case 0x00:
-        A = m_memory->Read(0x5000);  // IN0
-        break;
+        return m_memory->Read(0x5000);  // IN0
     case 0x01:
-        A = m_memory->Read(0x5040);  // IN1
-        break;
+        return m_memory->Read(0x5040);  // IN1
     case 0x02:
-        A = m_memory->Read(0x5080);  // DSW1
-        break;
+        return m_memory->Read(0x5080);  // DSW1
     default:
-        A = 0xFF;
-        break;
+        return 0xFF;
     }
+}
 
-    m_cyclesLastInstruction = 11;
+void Z80::WritePort(uint8_t port, uint8_t value)
+{
+    if (port == 0x00) {
+        m_interruptVector = value;
+    }
 }
 
 void Z80::OP_RLA() {
@@ -1535,8 +1409,8 @@ void Z80::OP_EI()
 
 void Z80::OP_JP_M_nn()
 {
-    uint8_t low = m_memory->Read(PC++);
-    uint8_t high = m_memory->Read(PC++);
+    uint8_t low = FetchByte();
+    uint8_t high = FetchByte();
     uint16_t address = (high << 8) | low;
 
     if (GetFlag(FLAG_S)) {  // Se Sign flag è settato (negativo)
@@ -1568,35 +1442,35 @@ void Z80::OP_CCF()
 
 void Z80::OP_AND_n()
 {
-    uint8_t n = m_memory->Read(PC++);
+    uint8_t n = FetchByte();
     AND_A_r(n);
     m_cyclesLastInstruction = 7;
 }
 
 void Z80::OP_XOR_n()
 {
-    uint8_t n = m_memory->Read(PC++);
+    uint8_t n = FetchByte();
     XOR_A_r(n);
     m_cyclesLastInstruction = 7;
 }
 
 void Z80::OP_OR_n()
 {
-    uint8_t n = m_memory->Read(PC++);
+    uint8_t n = FetchByte();
     OR_A_r(n);
     m_cyclesLastInstruction = 7;
 }
 
 void Z80::OP_CP_n()
 {
-    uint8_t n = m_memory->Read(PC++);
+    uint8_t n = FetchByte();
     CP_A_r(n);
     m_cyclesLastInstruction = 7;
 }
 
 void Z80::OP_LD_HL_n()
 {
-    uint8_t n = m_memory->Read(PC++);
+    uint8_t n = FetchByte();
     m_memory->Write(HL.pair, n);
 
     m_cyclesLastInstruction = 12;
@@ -1657,106 +1531,42 @@ void Z80::OP_RLCA()
     m_cyclesLastInstruction = 4;
 }
 
-void Z80::OP_INC_pHL() 
-{
-    INC_Memory(HL.pair);
-
-    m_cyclesLastInstruction = 11;
-}
-
-void Z80::OP_DEC_pHL()
-{
-    DEC_Memory(HL.pair);
-
-    m_cyclesLastInstruction = 11;
-}
-
 void Z80::INC_r(uint8_t &reg) {
-    // Salva il valore originale per calcolare i flag
-    uint8_t oldValue = reg;
-
     // Esegui l'incremento
     reg++;
 
-    // Calcola i flag
-    SetFlag(FLAG_Z, reg == 0x00);                   // Zero
-    SetFlag(FLAG_S, (reg & 0x80) != 0);             // Sign
-    SetFlag(FLAG_H, (oldValue & 0x0F) == 0x0F);     // Half-Carry
-    SetFlag(FLAG_PV, oldValue == 0x7F);             // Overflow
-    SetFlag(FLAG_N, false);                         // N sempre 0 per addizioni
-                                                    // FLAG_C non viene modificato
+    // Z, S, H, PV, N dalla tabella; FLAG_C non viene modificato
+    F = (F & FLAG_C) | g_z80Flags.inc[reg];
 
     m_cyclesLastInstruction = 4;
 }
 
 void Z80::DEC_r(uint8_t &reg)
 {
-    uint8_t oldValue = reg;
     reg--;
 
-    SetFlag(FLAG_Z, reg == 0x00);
-    SetFlag(FLAG_S, reg & 0x80);
-    SetFlag(FLAG_H, (oldValue & 0x0F) == 0x00);
-    SetFlag(FLAG_PV, oldValue == 0x80);
-    SetFlag(FLAG_N, true);
+    F = (F & FLAG_C) | g_z80Flags.dec[reg];
 
     m_cyclesLastInstruction = 4;
 }
 
 void Z80::LD_r_n(uint8_t &reg) {
-    uint8_t n = m_memory->Read(PC++);
+    uint8_t n = FetchByte();
     reg = n;
     m_cyclesLastInstruction = 7;
 }
 
-void Z80::LD_r_r(uint8_t &dest, uint8_t src) {
-    dest = src;
-    m_cyclesLastInstruction = 4;
-}
-
 void Z80::ADD_A_r(uint8_t value) {
-    uint8_t oldA = A;
-    uint16_t result = A + value;  // ? Usa 16-bit per catturare carry!
-
-    A = result & 0xFF;
-
-    // Flag Carry: set se risultato > 255
-    SetFlag(FLAG_C, result > 0xFF);
-
-    // Flag Zero: set se A è 0
-    SetFlag(FLAG_Z, A == 0x00);
-
-    // Flag Sign: set se bit 7 è 1
-    SetFlag(FLAG_S, (A & 0x80) != 0);
-
-    // Half-Carry: carry dal bit 3 al bit 4
-    SetFlag(FLAG_H, ((oldA & 0x0F) + (value & 0x0F)) > 0x0F);
-
-    // Overflow: cambio segno inaspettato
-    // Se entrambi positivi ? risultato negativo: overflow
-    // Se entrambi negativi ? risultato positivo: overflow
-    bool overflow = ((oldA ^ result) & (value ^ result) & 0x80) != 0;
-    SetFlag(FLAG_PV, overflow);
-
-    // N flag: reset (è addizione)
-    SetFlag(FLAG_N, false);
+    // C, Z, S, H, PV (overflow), N = 0 in un solo accesso
+    F = g_z80Flags.add[0][A][value];
+    A += value;
 
     m_cyclesLastInstruction = 4;
 }
 
 void Z80::SUB_A_r(uint8_t value) {
-    uint8_t oldValue = A;
-    uint16_t result = A - value;
-    A = result & 0xFF;
-
-    bool overflow = ((oldValue ^ value) & (oldValue ^ result) & 0x80) != 0;
-
-    SetFlag(FLAG_C, oldValue < value);
-    SetFlag(FLAG_Z, A == 0x00);
-    SetFlag(FLAG_S, (A & 0x80) != 0);
-    SetFlag(FLAG_H, (oldValue & 0x0F) < (value & 0x0F));
-    SetFlag(FLAG_PV, overflow);
-    SetFlag(FLAG_N, true);
+    F = g_z80Flags.sub[0][A][value];
+    A -= value;
 
     m_cyclesLastInstruction = 4;
 }
@@ -1765,12 +1575,8 @@ void Z80::AND_A_r(uint8_t value)
 {
     A &= value;
 
-    SetFlag(FLAG_Z, A == 0x00);
-    SetFlag(FLAG_S, (A & 0x80) != 0);
-    SetFlag(FLAG_PV, CalculateParity(A));
-    SetFlag(FLAG_H, true);
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_C, false);
+    // Z, S, PV (parita'); H sempre 1, N e C sempre 0
+    F = g_z80Flags.szp[A] | FLAG_H;
 
     m_cyclesLastInstruction = 4;
 }
@@ -1779,12 +1585,7 @@ void Z80::OR_A_r(uint8_t value)
 {
     A |= value;
 
-    SetFlag(FLAG_Z, A == 0x00);
-    SetFlag(FLAG_S, (A & 0x80) != 0);
-    SetFlag(FLAG_PV, CalculateParity(A));
-    SetFlag(FLAG_H, false);
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_C, false);
+    F = g_z80Flags.szp[A];
 
     m_cyclesLastInstruction = 4;
 }
@@ -1793,21 +1594,15 @@ void Z80::XOR_A_r(uint8_t value)
 {
     A ^= value;
 
-    SetFlag(FLAG_Z, A == 0x00);
-    SetFlag(FLAG_S, (A & 0x80) != 0);
-    SetFlag(FLAG_PV, CalculateParity(A));
-    SetFlag(FLAG_H, false);
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_C, false);
+    F = g_z80Flags.szp[A];
     
     m_cyclesLastInstruction = 4;
 }
 
 void Z80::CP_A_r(uint8_t value)
 {
-    uint8_t oldA = A;
-    SUB_A_r(value);
-    A = oldA;
+    // Come SUB senza salvare il risultato; X e Y arrivano dall'operando
+    F = (g_z80Flags.sub[0][A][value] & ~(FLAG_X | FLAG_Y)) | (value & (FLAG_X | FLAG_Y));
 
     m_cyclesLastInstruction = 4;
 }
@@ -1830,8 +1625,8 @@ void Z80::CALL_conditional(uint8_t flag, bool condition)
     bool flagValue = GetFlag(flag);
 
     // Leggi dalla memoria l'indirizzo della call
-    uint8_t low = m_memory->Read(PC++);
-    uint8_t high = m_memory->Read(PC++);
+    uint8_t low = FetchByte();
+    uint8_t high = FetchByte();
     
     if (flagValue == condition) {
         // Salvo sullo stack il valore attuale di PC
@@ -1852,8 +1647,8 @@ void Z80::JP_nn_conditional(uint8_t flag, bool condition)
     bool flagValue = GetFlag(flag);
 
     // Leggi dalla memoria l'indirizzo della call
-    uint8_t low = m_memory->Read(PC++);
-    uint8_t high = m_memory->Read(PC++);
+    uint8_t low = FetchByte();
+    uint8_t high = FetchByte();
 
     if (flagValue == condition) {
         PC = (high << 8) | low;
@@ -1866,7 +1661,7 @@ void Z80::JR_conditional(uint8_t flag, bool condition)
 {
     bool flagValue = GetFlag(flag);
 
-    uint8_t offset_unsigned = m_memory->Read(PC++);
+    uint8_t offset_unsigned = FetchByte();
     int8_t offset = static_cast<int8_t>(offset_unsigned);
 
     if (flagValue == condition) {
@@ -1894,8 +1689,8 @@ void Z80::POP_rr(RegisterPair *reg)
 
 void Z80::LD_rr_nn(uint16_t &reg)
 {
-    uint8_t low = m_memory->Read(PC++);
-    uint8_t high = m_memory->Read(PC++);
+    uint8_t low = FetchByte();
+    uint8_t high = FetchByte();
     
     reg = (high << 8) | low;
 
@@ -1931,31 +1726,16 @@ void Z80::ADD_HL_rr(uint16_t reg)
     m_cyclesLastInstruction = 11;
 }
 
-void Z80::ADD_IX_rr(uint16_t reg)
-{
-    uint16_t oldIX = IX;
-
-    uint32_t result = (IX + reg);
-
-    IX = result & 0xFFFF;
-
-    SetFlag(FLAG_C, result > 0xFFFF);
-    SetFlag(FLAG_H, ((oldIX & 0x0FFF) + (reg & 0x0FFF)) > 0x0FFF);
-    SetFlag(FLAG_N, false);
-
-    m_cyclesLastInstruction = 15;
-}
-
-void Z80::ADD_IY_rr(uint16_t reg)
+void Z80::ADD_XY_rr(uint16_t &xy, uint16_t reg)
 {
-    uint16_t oldIY = IY;
+    uint16_t oldXY = xy;
 
-    uint32_t result = (IY + reg);
+    uint32_t result = (xy + reg);
 
-    IY = result & 0xFFFF;
+    xy = result & 0xFFFF;
 
     SetFlag(FLAG_C, result > 0xFFFF);
-    SetFlag(FLAG_H, ((oldIY & 0x0FFF) + (reg & 0x0FFF)) > 0x0FFF);
+    SetFlag(FLAG_H, ((oldXY & 0x0FFF) + (reg & 0x0FFF)) > 0x0FFF);
     SetFlag(FLAG_N, false);
 
     m_cyclesLastInstruction = 15;
@@ -1991,8 +1771,8 @@ void Z80::LD_indirect_A(uint16_t address)
 
 void Z80::LD_A_addr()
 {
-    uint8_t low = m_memory->Read(PC++);
-    uint8_t high = m_memory->Read(PC++);
+    uint8_t low = FetchByte();
+    uint8_t high = FetchByte();
 
     A = m_memory->Read((high << 8) | low);
 
@@ -2001,8 +1781,8 @@ void Z80::LD_A_addr()
 
 void Z80::LD_addr_A()
 {
-    uint8_t low = m_memory->Read(PC++);
-    uint8_t high = m_memory->Read(PC++);
+    uint8_t low = FetchByte();
+    uint8_t high = FetchByte();
 
     m_memory->Write((high << 8) | low, A);
 
@@ -2011,223 +1791,29 @@ void Z80::LD_addr_A()
 
 void Z80::ADC_A_r(uint8_t value)
 {
-    uint8_t oldA = A;
-    uint8_t carry = GetFlag(FLAG_C) ? 1 : 0;
-    uint16_t result = A + value + carry;
-
-    A = result & 0xFF;
-
-    SetFlag(FLAG_C, result > 0xFF);
-    SetFlag(FLAG_Z, result == 0x00);
-    SetFlag(FLAG_S, (A & 0x80) != 0);
-
-    // Half-carry: considera anche il carry
-    SetFlag(FLAG_H, ((oldA & 0x0F) + (value & 0x0F) + carry) > 0x0F);
-
-    // Overflow: cambio di segno inaspettato
-    bool overflow = ((oldA ^ result) & (value ^ result) & 0x80) != 0;
-    SetFlag(FLAG_PV, overflow);
-
-    SetFlag(FLAG_N, false);
+    // La tabella e' indicizzata anche dal carry in ingresso
+    uint8_t carry = F & FLAG_C;
+    F = g_z80Flags.add[carry][A][value];
+    A = A + value + carry;
 
     m_cyclesLastInstruction = 4;
 }
 
 void Z80::SBC_A_r(uint8_t value)
 {
-    uint8_t oldA = A;
-    uint8_t carry = GetFlag(FLAG_C) ? 1 : 0;
-    uint16_t result = A - value - carry;
-
-    A = result & 0xFF;
-    SetFlag(FLAG_C, oldA < (value + carry));
-    SetFlag(FLAG_Z, result == 0);
-    SetFlag(FLAG_S, (A & 0x80) != 0);
-
-    // Half-carry: considera anche il carry
-    SetFlag(FLAG_H, (oldA & 0x0F) < (value & 0x0F) + carry);
-    
-    // Overflow: cambio di segno inaspettato
-    bool overflow = ((oldA ^ value) & (oldA ^ result) & 0x80) != 0;
-    SetFlag(FLAG_PV, overflow);
-
-    SetFlag(FLAG_N, true);
+    uint8_t carry = F & FLAG_C;
+    F = g_z80Flags.sub[carry][A][value];
+    A = A - value - carry;
 
     m_cyclesLastInstruction = 4;
 }
 
-void Z80::HandleRotateShift(uint8_t operation, uint8_t reg)
-{
-    uint8_t *p_reg = m_registerMap[reg];
-
-    // gestisci HL separatamente
-    if (reg == 6) {
-        uint8_t value = m_memory->Read(HL.pair);
-
-        switch (operation) {
-        case 0: CB_RLC(value); break;
-        case 1: CB_RRC(value); break;
-        case 2: CB_RL(value); break;
-        case 3: CB_RR(value); break;
-        case 4: CB_SLA(value); break;
-        case 5: CB_SRA(value); break;
-        case 6: CB_SWAP(value); break;
-        case 7: CB_SRL(value); break;
-        }
-        
-        m_memory->Write(HL.pair, value);
-
-        m_cyclesLastInstruction = 15;
-    }
-    else {
-        switch (operation) {
-        case 0: CB_RLC(*p_reg); break;
-        case 1: CB_RRC(*p_reg); break;
-        case 2: CB_RL(*p_reg); break;
-        case 3: CB_RR(*p_reg); break;
-        case 4: CB_SLA(*p_reg); break;
-        case 5: CB_SRA(*p_reg); break;
-        case 6: CB_SWAP(*p_reg); break;
-        case 7: CB_SRL(*p_reg); break;
-        }
-
-        m_cyclesLastInstruction = 8;
-    }
-}
-
-void Z80::HandleBit(uint8_t bit_number, uint8_t reg)
-{
-    uint8_t *p_reg = m_registerMap[reg];
-    if (reg == 6) {
-        uint8_t value = m_memory->Read(HL.pair);
-        bool bit_value = (value & (1 << bit_number)) != 0;
-
-        SetFlag(FLAG_Z, !bit_value);
-        SetFlag(FLAG_H, true);
-        SetFlag(FLAG_N, false);
-        SetFlag(FLAG_PV, !bit_value);  // Stesso di Z
-        
-        // Flag S: Solo per BIT 7, altrimenti 0
-        if (bit_number == 7) {
-            SetFlag(FLAG_S, bit_value);  // S = valore bit 7
-        }
-        else {
-            SetFlag(FLAG_S, false);  // S = 0 per altri bit
-        }
-
-        m_cyclesLastInstruction = 12;
-    }
-    else {
-        bool bit_value = (*p_reg & (1 << bit_number)) != 0;
-
-        SetFlag(FLAG_Z, !bit_value);
-        SetFlag(FLAG_H, true);
-        SetFlag(FLAG_N, false);
-        SetFlag(FLAG_PV, !bit_value);  // Stesso di Z
-        
-        // Flag S: Solo per BIT 7, altrimenti 0
-        if (bit_number == 7) {
-            SetFlag(FLAG_S, bit_value);  // S = valore bit 7
-        }
-        else {
-            SetFlag(FLAG_S, false);  // S = 0 per altri bit
-        }
-
-        m_cyclesLastInstruction = 8;
-    }
-}
-
-void Z80::HandleRes(uint8_t bit_number, uint8_t reg)
-{
-    uint8_t *p_reg = m_registerMap[reg];
-    if (reg == 6) {
-        uint8_t value = m_memory->Read(HL.pair);
-        value &= ~(1 << bit_number); // clear bit
-        m_memory->Write(HL.pair, value);
-
-        m_cyclesLastInstruction = 15;
-    }
-    else {
-        *p_reg &= ~(1 << bit_number); // clear bit
-
-        m_cyclesLastInstruction = 8;
-    }
-}
-
-void Z80::HandleSet(uint8_t bit_number, uint8_t reg)
-{
-    uint8_t *p_reg = m_registerMap[reg];
-    if (reg == 6) {
-        uint8_t value = m_memory->Read(HL.pair);
-        value |= (1 << bit_number); // set bit
-        m_memory->Write(HL.pair, value);
-
-        m_cyclesLastInstruction = 15;
-    }
-    else {
-        *p_reg |= (1 << bit_number); // set bit
-
-        m_cyclesLastInstruction = 8;
-    }
-}
-
-void Z80::HandleRotateShift_pIXOffset(uint8_t operation, int8_t offset)
-{
-    std::cerr << "HandleRotateShift_pIXOffset called: operation=0x"
-        << std::hex << (int)operation << " offset=" << (int)offset << std::dec << "\n";
-    // TODO: Implementare rotate/shift su (IX+d)
-    m_cyclesLastInstruction = 23;
-}
-
-void Z80::HandleBit_pIXOffset(uint8_t bit_number, int8_t offset)
-{
-    uint16_t address = IX + offset;
-    uint8_t value = m_memory->Read(address);
-
-    bool bit_value = (value & (1 << bit_number)) != 0;
-
-    SetFlag(FLAG_Z, !bit_value);
-    SetFlag(FLAG_H, true);
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_PV, !bit_value);
-
-    if (bit_number == 7) {
-        SetFlag(FLAG_S, bit_value);
-    }
-    else {
-        SetFlag(FLAG_S, false);
-    }
-
-    m_cyclesLastInstruction = 20;  // Operazioni memoria costano più cicli
-}
-
-void Z80::HandleRes_pIXOffset(uint8_t operation, int8_t offset)
-{
-    std::cerr << "HandleRes_pIXOffset called: operation=0x"
-        << std::hex << (int)operation << " offset=" << (int)offset << std::dec << "\n";
-    // TODO: Implementare RES su (IX+d)
-    m_cyclesLastInstruction = 23;
-}
-
-void Z80::HandleSet_pIXOffset(uint8_t operation, int8_t offset)
-{
-    std::cerr << "HandleSet_pIXOffset called: operation=0x"
-        << std::hex << (int)operation << " offset=" << (int)offset << std::dec << "\n";
-    // TODO: Implementare SET su (IX+d)
-    m_cyclesLastInstruction = 23;
-}
-
 void Z80::CB_RLC(uint8_t &reg)
 {
     uint8_t bit7 = (reg & 0x80) >> 7;
     reg = (reg << 1) | bit7;
 
-    SetFlag(FLAG_Z, reg == 0);
-    SetFlag(FLAG_S, (reg & 0x80) != 0);
-    SetFlag(FLAG_H, false);
-    SetFlag(FLAG_PV, CalculateParity(reg));
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_C, bit7 != 0);
+    F = g_z80Flags.szp[reg] | (bit7 ? FLAG_C : 0);
 }
 
 void Z80::CB_RRC(uint8_t &reg)
@@ -2235,12 +1821,7 @@ void Z80::CB_RRC(uint8_t &reg)
     uint8_t bit0 = reg & 0x01;
     reg = (bit0 << 7) | (reg >> 1);
 
-    SetFlag(FLAG_Z, reg == 0);
-    SetFlag(FLAG_S, (reg & 0x80) != 0);
-    SetFlag(FLAG_H, false);
-    SetFlag(FLAG_PV, CalculateParity(reg));
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_C, bit0 != 0);
+    F = g_z80Flags.szp[reg] | (bit0 ? FLAG_C : 0);
 }
 
 void Z80::CB_RL(uint8_t &reg)
@@ -2249,12 +1830,7 @@ void Z80::CB_RL(uint8_t &reg)
     uint8_t bit7 = (reg & 0x80) >> 7;
     reg = (reg << 1) | old_carry;
 
-    SetFlag(FLAG_Z, reg == 0);
-    SetFlag(FLAG_S, (reg & 0x80) != 0);
-    SetFlag(FLAG_H, false);
-    SetFlag(FLAG_PV, CalculateParity(reg));
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_C, bit7 != 0);
+    F = g_z80Flags.szp[reg] | (bit7 ? FLAG_C : 0);
 }
 
 void Z80::CB_RR(uint8_t &reg)
@@ -2263,12 +1839,7 @@ void Z80::CB_RR(uint8_t &reg)
     uint8_t bit0 = reg & 0x01;
     reg = (reg >> 1) | (old_carry << 7);
 
-    SetFlag(FLAG_Z, reg == 0);
-    SetFlag(FLAG_S, (reg & 0x80) != 0);
-    SetFlag(FLAG_H, false);
-    SetFlag(FLAG_PV, CalculateParity(reg));
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_C, bit0 != 0);
+    F = g_z80Flags.szp[reg] | (bit0 ? FLAG_C : 0);
 }
 
 void Z80::CB_SLA(uint8_t &reg)
@@ -2276,12 +1847,7 @@ void Z80::CB_SLA(uint8_t &reg)
     uint8_t bit7 = (reg & 0x80) >> 7;
     reg <<= 1;
 
-    SetFlag(FLAG_Z, reg == 0);
-    SetFlag(FLAG_S, (reg & 0x80) != 0);
-    SetFlag(FLAG_H, false);
-    SetFlag(FLAG_PV, CalculateParity(reg));
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_C, bit7 != 0);
+    F = g_z80Flags.szp[reg] | (bit7 ? FLAG_C : 0);
 }
 
 void Z80::CB_SRA(uint8_t &reg)
@@ -2290,24 +1856,16 @@ void Z80::CB_SRA(uint8_t &reg)
     uint8_t bit7 = reg & 0x80;
     reg = (reg >> 1) | bit7;
 
-    SetFlag(FLAG_Z, reg == 0);
-    SetFlag(FLAG_S, (reg & 0x80) != 0);
-    SetFlag(FLAG_H, false);
-    SetFlag(FLAG_PV, CalculateParity(reg));
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_C, bit0 != 0);
+    F = g_z80Flags.szp[reg] | (bit0 ? FLAG_C : 0);
 }
 
-void Z80::CB_SWAP(uint8_t &reg)
+void Z80::CB_SLL(uint8_t &reg)
 {
-    reg = ((reg & 0x0F) << 4) | ((reg & 0xF0) >> 4);
+    // Non documentata: come SLA ma il bit 0 entra a 1
+    uint8_t bit7 = (reg & 0x80) >> 7;
+    reg = (reg << 1) | 0x01;
 
-    SetFlag(FLAG_Z, reg == 0);
-    SetFlag(FLAG_S, (reg & 0x80) != 0);
-    SetFlag(FLAG_H, false);
-    SetFlag(FLAG_PV, CalculateParity(reg));
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_C, false);
+    F = g_z80Flags.szp[reg] | (bit7 ? FLAG_C : 0);
 }
 
 void Z80::CB_SRL(uint8_t &reg)
@@ -2315,28 +1873,24 @@ void Z80::CB_SRL(uint8_t &reg)
     uint8_t bit0 = reg & 0x01;
     reg = reg >> 1;
 
-    SetFlag(FLAG_Z, reg == 0);
-    SetFlag(FLAG_S, (reg & 0x80) != 0);
-    SetFlag(FLAG_H, false);
-    SetFlag(FLAG_PV, CalculateParity(reg));
-    SetFlag(FLAG_N, false);
-    SetFlag(FLAG_C, bit0 != 0);
+    F = g_z80Flags.szp[reg] | (bit0 ? FLAG_C : 0);
 }
 
 void Z80::SBC_HL(const uint16_t *reg)
 {
     uint8_t oldCarry = GetFlag(FLAG_C) ? 1 : 0;
     uint16_t oldHL = HL.pair;
+    uint16_t value = *reg;   // Copia: con SBC HL,HL reg punta a HL
 
-    int32_t result = (int32_t)HL.pair - (int32_t)*reg - oldCarry;
+    int32_t result = (int32_t)HL.pair - (int32_t)value - oldCarry;
 
     HL.pair = result & 0xFFFF;
 
     SetFlag(FLAG_Z, HL.pair == 0x0000);
     SetFlag(FLAG_S, (HL.pair & 0x8000) != 0);
-    SetFlag(FLAG_H, ((oldHL & 0x0FFF) - (*reg & 0x0FFF) - oldCarry) < 0);
+    SetFlag(FLAG_H, ((oldHL & 0x0FFF) - (value & 0x0FFF) - oldCarry) < 0);
 
-    bool overflow = ((oldHL & 0x8000) != (*reg & 0x8000)) &&
+    bool overflow = ((oldHL & 0x8000) != (value & 0x8000)) &&
                     ((oldHL & 0x8000) != (HL.pair & 0x8000));
     SetFlag(FLAG_PV, overflow);
     SetFlag(FLAG_N, true);
@@ -2348,8 +1902,8 @@ void Z80::SBC_HL(const uint16_t *reg)
 void Z80::LD_pnn_rr(const uint16_t *reg)
 {
     // Leggi indirizzo in memoria
-    uint8_t nn_low = m_memory->Read(PC++);
-    uint8_t nn_high = m_memory->Read(PC++);
+    uint8_t nn_low = FetchByte();
+    uint8_t nn_high = FetchByte();
 
     // compongo l'address
     uint16_t address = nn_high << 8 | nn_low;
@@ -2366,15 +1920,16 @@ void Z80::ADC_HL(const uint16_t *reg)
     uint8_t oldCarry = GetFlag(FLAG_C) ? 1 : 0;
 
     uint16_t oldHL = HL.pair;
-    uint32_t result = HL.pair + *reg + oldCarry;
+    uint16_t value = *reg;   // Copia: con ADC HL,HL reg punta a HL
+    uint32_t result = HL.pair + value + oldCarry;
 
     HL.pair = result & 0xFFFF;
 
     SetFlag(FLAG_Z, HL.pair == 0x0000);
     SetFlag(FLAG_S, (HL.pair & 0x8000) != 0);
-    SetFlag(FLAG_H, ((oldHL & 0x0FFF) + (*reg & 0x0FFF) + oldCarry) > 0x0FFF);
+    SetFlag(FLAG_H, ((oldHL & 0x0FFF) + (value & 0x0FFF) + oldCarry) > 0x0FFF);
 
-    bool overflow = ((oldHL & 0x8000) == (*reg & 0x8000)) && 
+    bool overflow = ((oldHL & 0x8000) == (value & 0x8000)) && 
                     ((oldHL & 0x8000) != (HL.pair & 0x8000));
     SetFlag(FLAG_PV, overflow);
     SetFlag(FLAG_N, false);
@@ -2386,8 +1941,8 @@ void Z80::ADC_HL(const uint16_t *reg)
 void Z80::LD_rr_pnn(uint16_t *reg)
 {
     // Leggi indirizzo in memoria
-    uint8_t nn_low = m_memory->Read(PC++);
-    uint8_t nn_high = m_memory->Read(PC++);
+    uint8_t nn_low = FetchByte();
+    uint8_t nn_high = FetchByte();
 
     // compongo l'address
     uint16_t address = nn_high << 8 | nn_low;
@@ -2404,24 +1959,10 @@ void Z80::LD_rr_pnn(uint16_t *reg)
 
 void Z80::NEG()
 {
-    uint8_t oldA = A;
-    int8_t result = 0 - (int8_t)oldA;
-    A = (uint8_t)result;
-
-    SetFlag(FLAG_Z, A == 0);
-    SetFlag(FLAG_S, (A & 0x80) != 0);
-
-    // H=1 se A aveva bit bassi (0x0F)
-    bool h_borrow = (oldA & 0x0F) != 0;
-    SetFlag(FLAG_H, h_borrow);
-
-    // Overflow solo se A = 0x80 (-128)
-    bool overflow = (oldA == 0x80);
-    SetFlag(FLAG_PV, overflow);
-    SetFlag(FLAG_N, true);
-
-    // C = 1 sw A non era 0 (c'era un prestito)
-    SetFlag(FLAG_C, oldA != 0);
+    // NEG equivale a 0 - A: H se A aveva bit bassi, PV solo per A = 0x80,
+    // C se A non era 0 (c'era un prestito)
+    F = g_z80Flags.sub[0][0][A];
+    A = 0 - A;
 
     m_cyclesLastInstruction = 8;
 }
@@ -2562,65 +2103,6 @@ void Z80::CPDR() {
     }
 }
 
-void Z80::LD_r_pIXOffset(uint8_t &reg)
-{
-    int8_t offset = (int8_t)m_memory->Read(PC++);
-    uint16_t address = IX + offset;
-    reg = m_memory->Read(address);
-}
-
-void Z80::LD_pIXOffset_r(const uint8_t reg)
-{
-    int8_t offset = (int8_t)m_memory->Read(PC++);
-    uint16_t address = IX + offset;
-    m_memory->Write(address, reg);
-}
-
-void Z80::LD_pIYOffset_r(const uint8_t reg)
-{
-    int8_t offset = (int8_t)m_memory->Read(PC++);
-    uint16_t address = IY + offset;
-    m_memory->Write(address, reg);
-}
-
-void Z80::LD_pIXOffset_n()
-{
-    int8_t offset = (int8_t)m_memory->Read(PC++);
-    uint8_t value = m_memory->Read(PC++);
-    uint16_t address = IX + offset;
-    m_memory->Write(address, value);
-}
-
-void Z80::LD_pIYOffset_n()
-{
-    int8_t offset = (int8_t)m_memory->Read(PC++);
-    uint8_t value = m_memory->Read(PC++);
-    uint16_t address = IY + offset;
-    m_memory->Write(address, value);
-}
-
-void Z80::AND_r_pIXOffset(uint8_t &reg)
-{
-    int8_t offset = (int8_t)m_memory->Read(PC++);
-    uint16_t address = IX + offset;
-    uint8_t value = m_memory->Read(address);
-    reg &= value;
-    // Aggiorna i flag!
-    SetFlag(FLAG_Z, reg == 0);
-    SetFlag(FLAG_S, (reg & 0x80) != 0);
-    SetFlag(FLAG_H, true);
-    SetFlag(FLAG_PV, CalculateParity(reg));  // Parità
-    SetFlag(FLAG_N, false);
-}
-
-void Z80::ADD_r_pIXOffset()
-{
-    int8_t offset = (int8_t)m_memory->Read(PC++);
-    uint16_t address = IX + offset;
-    uint8_t value = m_memory->Read(address);
-    ADD_A_r(value);
-}
-
 void Z80::PUSH_16bit(uint16_t value)
 {
     uint8_t low = value & 0xFF;
@@ -2659,7 +2141,6 @@ void Z80::Interrupt() {
     }
     else {
         // Mode 1: va a 0x0038
-        std::cout << ">>> INTERRUPT: Saltando a 0x0038" << std::endl;
         PC = 0x0038;
         m_totalCycles += 13;
     }
@@ -2697,6 +2178,76 @@ void Z80::Reset() {
     // Cycles
     m_totalCycles = 0;
     m_cyclesLastInstruction = 0;
+
+    // Stato di esecuzione
+    m_halted = false;
+    m_interruptsEnabled = false;
+    pendingInterrupt = false;
+}
+
+void Z80::SaveState(StateWriter &writer) const
+{
+    // Registri principali e shadow
+    writer.Write8(A);
+    writer.Write8(F);
+    writer.Write16(BC.pair);
+    writer.Write16(DE.pair);
+    writer.Write16(HL.pair);
+    writer.Write8(A_alt);
+    writer.Write8(F_alt);
+    writer.Write16(BC_alt.pair);
+    writer.Write16(DE_alt.pair);
+    writer.Write16(HL_alt.pair);
+
+    // Registri speciali
+    writer.Write16(PC);
+    writer.Write16(SP);
+    writer.Write16(IX);
+    writer.Write16(IY);
+    writer.Write8(I);
+    writer.Write8(R);
+
+    // Cicli
+    writer.Write64(m_totalCycles);
+    writer.Write32(static_cast<uint32_t>(m_cyclesLastInstruction));
+
+    // Interrupt e HALT
+    writer.Write8(m_interruptMode);
+    writer.WriteBool(m_interruptsEnabled);
+    writer.WriteBool(pendingInterrupt);
+    writer.WriteBool(m_halted);
+    writer.Write8(m_interruptVector);
+}
+
+void Z80::LoadState(StateReader &reader)
+{
+    // Stesso ordine di SaveState
+    A = reader.Read8();
+    F = reader.Read8();
+    BC.pair = reader.Read16();
+    DE.pair = reader.Read16();
+    HL.pair = reader.Read16();
+    A_alt = reader.Read8();
+    F_alt = reader.Read8();
+    BC_alt.pair = reader.Read16();
+    DE_alt.pair = reader.Read16();
+    HL_alt.pair = reader.Read16();
+
+    PC = reader.Read16();
+    SP = reader.Read16();
+    IX = reader.Read16();
+    IY = reader.Read16();
+    I = reader.Read8();
+    R = reader.Read8();
+
+    m_totalCycles = reader.Read64();
+    m_cyclesLastInstruction = static_cast<int>(reader.Read32());
+
+    m_interruptMode = reader.Read8();
+    m_interruptsEnabled = reader.ReadBool();
+    pendingInterrupt = reader.ReadBool();
+    m_halted = reader.ReadBool();
+    m_interruptVector = reader.Read8();
 }
 
 void Z80::SetFlag(uint8_t flag, bool value)
@@ -2739,9 +2290,62 @@ int Z80::Step()
         return 4; // Consuma comunque cicli
     }
 
-    uint8_t opcode = m_memory->Read(PC++);
+    uint8_t opcode = FetchByte();
     //printf("DEBUG: Executing opcode 0x%02X at PC 0x%04X\n", opcode, PC - 1);
-    (this->*m_opcodeTable[opcode])();
+    (this->*s_opcodeTable[opcode])();
     m_totalCycles += m_cyclesLastInstruction;
     return m_cyclesLastInstruction;
 }
+
+uint64_t Z80::Run(uint64_t cycleBudget)
+{
+#if defined(Z80_SWITCH_DISPATCH)
+    if (!m_jit) {
+        return RunSwitch(cycleBudget);
+    }
+#endif
+
+    const uint64_t start = m_totalCycles;
+    const uint64_t target = start + cycleBudget;
+
+    // Sul bus piatto da 64 KB (harness CP/M) 0x0000-0x3FFF e' RAM scrivibile:
+    // il codice puo' modificarsi da solo e i blocchi in cache non sarebbero validi
+    const bool useBlockCache = m_blockCacheEnabled && !m_memory->IsFlatMemory();
+
+    while (m_totalCycles < target) {
+        // In HALT la CPU ripete NOP da 4 cicli fino al prossimo interrupt:
+        // nessun interrupt puo' arrivare dentro il budget, quindi salta alla fine
+        if (m_halted) {
+            m_cyclesLastInstruction = 4;
+            m_totalCycles += (target - m_totalCycles + 3) & ~uint64_t(3);
+            break;
+        }
+
+        // Codice in ROM: blocco gia' decodificato se c'e' e sta tutto nel budget,
+        // altrimenti lo si registra mentre lo si interpreta
+        if (useBlockCache && PC < BLOCK_CACHE_LIMIT) {
+            int32_t index = m_blockIndex[PC];
+            if (index == BLOCK_NOT_BUILT) {
+                RecordBlock(target);
+                continue;
+            }
+
+            const CachedBlock &block = m_blocks[index];
+            if (m_totalCycles + block.prefixCycles < target) {
+                if (m_jit) {
+                    m_jit->Execute(static_cast<uint32_t>(index));
+                }
+                else {
+                    ExecuteBlock(block);
+                }
+                continue;
+            }
+        }
+
+        uint8_t opcode = FetchByte();
+        (this->*s_opcodeTable[opcode])();
+        m_totalCycles += m_cyclesLastInstruction;
+    }
+
+    return m_totalCycles - start;
+}
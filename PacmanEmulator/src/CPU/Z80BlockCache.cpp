@@ -0,0 +1,134 @@
+#include "CPU/Z80.h"
+#include "CPU/Z80Jit.h"
+#include <iostream>
+
+// Block cache del codice in ROM: vedi la descrizione in Z80.h.
+// Un blocco viene registrato la prima volta che la CPU passa dal suo indirizzo
+// di partenza, interpretando le istruzioni una alla volta come farebbe Run():
+// handler e cicli vengono presi da quello che succede davvero, cosi' il
+// comportamento del blocco coincide per costruzione con quello dell'interprete.
+
+void Z80::InvalidateBlockCache()
+{
+    m_blockIndex.assign(BLOCK_CACHE_LIMIT, BLOCK_NOT_BUILT);
+    m_blocks.clear();
+    m_blockHandlers.clear();
+    m_blockAddresses.clear();
+
+    if (m_jit) {
+        m_jit->Reset();
+    }
+}
+
+bool Z80::SetJitEnabled(bool enabled)
+{
+    if (!enabled) {
+        m_jit.reset();
+        return true;
+    }
+
+    if (!Z80Jit::IsSupported()) {
+        std::cerr << "Z80: JIT non disponibile su questo host, uso l'interprete" << std::endl;
+        return false;
+    }
+
+    if (!m_jit) {
+        m_jit = std::make_unique<Z80Jit>(*this);
+    }
+    return true;
+}
+
+bool Z80::EndsBlock(uint16_t address, OpcodeFunction handler) const
+{
+    // Senza handler i cicli non vengono aggiornati: mai in mezzo a un blocco
+    if (handler == &Z80::OP_NotImplemented) {
+        return true;
+    }
+
+    uint8_t opcode = m_memory->Read(address);
+    switch (opcode) {
+    // DJNZ, JR, JR cc
+    case 0x10: case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+    // HALT
+    case 0x76:
+    // RET cc, RET, RETI/RETN (prefisso ED)
+    case 0xC0: case 0xC8: case 0xD0: case 0xD8: case 0xE0: case 0xE8: case 0xF0: case 0xF8:
+    case 0xC9:
+    // JP nn, JP cc, JP (HL)
+    case 0xC3: case 0xC2: case 0xCA: case 0xD2: case 0xDA: case 0xE2: case 0xEA: case 0xF2: case 0xFA:
+    case 0xE9:
+    // CALL nn, CALL cc
+    case 0xCD: case 0xC4: case 0xCC: case 0xD4: case 0xDC: case 0xE4: case 0xEC: case 0xF4: case 0xFC:
+    // RST
+    case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+    // ED: RETI/RETN, istruzioni a blocchi ripetute e opcode che non aggiornano i cicli
+    case 0xED:
+        return true;
+
+    case 0xDD:
+    case 0xFD:
+        // JP (IX) / JP (IY)
+        return m_memory->Read(address + 1) == 0xE9;
+
+    default:
+        return false;
+    }
+}
+
+void Z80::RecordBlock(uint64_t target)
+{
+    const uint16_t start = PC;
+    uint32_t prefixCycles = 0;
+    m_recordedHandlers.clear();
+    m_recordedAddresses.clear();
+
+    while (m_totalCycles < target) {
+        const uint16_t address = PC;
+        OpcodeFunction handler = s_opcodeTable[FetchByte()];
+        (this->*handler)();
+        m_totalCycles += m_cyclesLastInstruction;
+        m_recordedHandlers.push_back(handler);
+        m_recordedAddresses.push_back(address);
+
+        // Oltre ai terminatori, chiudi il blocco se il PC non e' avanzato di una
+        // normale lunghezza di istruzione (1-4 byte) o e' uscito dalla ROM
+        bool ends = EndsBlock(address, handler) || m_halted ||
+            PC <= address || PC > address + 4 || PC >= BLOCK_CACHE_LIMIT ||
+            m_recordedHandlers.size() == MAX_BLOCK_INSTRUCTIONS;
+
+        if (ends) {
+            CachedBlock block;
+            block.first = static_cast<uint32_t>(m_blockHandlers.size());
+            block.count = static_cast<uint32_t>(m_recordedHandlers.size());
+            block.prefixCycles = prefixCycles;
+
+            m_blockHandlers.insert(m_blockHandlers.end(), m_recordedHandlers.begin(), m_recordedHandlers.end());
+            m_blockAddresses.insert(m_blockAddresses.end(), m_recordedAddresses.begin(), m_recordedAddresses.end());
+            m_blockIndex[start] = static_cast<int32_t>(m_blocks.size());
+            m_blocks.push_back(block);
+            return;
+        }
+
+        prefixCycles += m_cyclesLastInstruction;
+    }
+
+    // Budget finito a meta' blocco: niente di registrato, si riprova al prossimo passaggio
+}
+
+void Z80::ExecuteBlock(const CachedBlock &block)
+{
+    // Il codice e' lineare: il PC di ogni istruzione e' quello lasciato dalla
+    // precedente, basta saltare l'opcode. Gli operandi li legge l'handler.
+    const OpcodeFunction *handler = &m_blockHandlers[block.first];
+    const OpcodeFunction *last = handler + block.count - 1;
+
+    for (; handler != last; ++handler) {
+        PC++;
+        (this->**handler)();
+    }
+
+    // Il terminatore puo' avere durata variabile (salto preso o no)
+    PC++;
+    (this->**last)();
+    m_totalCycles += block.prefixCycles + m_cyclesLastInstruction;
+}
@@ -0,0 +1,425 @@
+#include "CPU/Z80Jit.h"
+#include "CPU/Z80.h"
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define Z80_JIT_X64 1
+#endif
+
+#if defined(Z80_JIT_X64)
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#endif
+
+namespace {
+#if defined(Z80_JIT_X64)
+    // W^X: l'arena non e' mai scrivibile ed eseguibile insieme. Nasce RW e
+    // passa a RX; Compile rende scrivibili solo le pagine che sta riempiendo.
+    uint8_t *AllocateCode(size_t size)
+    {
+#if defined(_WIN32)
+        return static_cast<uint8_t *>(VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+#else
+        void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return memory == MAP_FAILED ? nullptr : static_cast<uint8_t *>(memory);
+#endif
+    }
+
+    // Protezione delle pagine che contengono [memory, memory + size): RW oppure RX
+    bool ProtectCode(uint8_t *memory, size_t size, bool writable)
+    {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        const uintptr_t pageSize = info.dwPageSize;
+#else
+        const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+#endif
+        uintptr_t begin = reinterpret_cast<uintptr_t>(memory) & ~(pageSize - 1);
+        uintptr_t end = (reinterpret_cast<uintptr_t>(memory) + size + pageSize - 1) & ~(pageSize - 1);
+
+#if defined(_WIN32)
+        DWORD oldProtection;
+        return VirtualProtect(reinterpret_cast<void *>(begin), end - begin,
+            writable ? PAGE_READWRITE : PAGE_EXECUTE_READ, &oldProtection) != 0;
+#else
+        return mprotect(reinterpret_cast<void *>(begin), end - begin,
+            writable ? (PROT_READ | PROT_WRITE) : (PROT_READ | PROT_EXEC)) == 0;
+#endif
+    }
+
+    void FreeCode(uint8_t *memory, size_t size)
+    {
+#if defined(_WIN32)
+        VirtualFree(memory, 0, MEM_RELEASE);
+#else
+        munmap(memory, size);
+#endif
+    }
+#endif
+
+    // Offset di un membro del Z80 rispetto all'inizio dell'oggetto (displacement per [rbx+disp32])
+    template <typename T>
+    uint32_t OffsetOf(const Z80 &cpu, const T *member)
+    {
+        return static_cast<uint32_t>(reinterpret_cast<const uint8_t *>(member) - reinterpret_cast<const uint8_t *>(&cpu));
+    }
+}
+
+Z80Jit::Z80Jit(Z80 &cpu)
+    : m_cpu(cpu), m_codeArena(nullptr), m_codeUsed(0), m_compiledBlocks(0),
+    m_differentialCheck(false), m_mismatches(0)
+{
+#if defined(Z80_JIT_X64)
+    m_codeArena = AllocateCode(CODE_ARENA_SIZE);
+
+    // Un host che vieta la memoria eseguibile anonima fallisce qui, non al primo blocco
+    if (m_codeArena && !ProtectCode(m_codeArena, CODE_ARENA_SIZE, false)) {
+        FreeCode(m_codeArena, CODE_ARENA_SIZE);
+        m_codeArena = nullptr;
+    }
+    if (!m_codeArena) {
+        std::cerr << "Z80Jit: impossibile allocare memoria eseguibile, uso l'interprete" << std::endl;
+    }
+#endif
+}
+
+Z80Jit::~Z80Jit()
+{
+#if defined(Z80_JIT_X64)
+    if (m_codeArena) {
+        FreeCode(m_codeArena, CODE_ARENA_SIZE);
+    }
+#endif
+}
+
+bool Z80Jit::IsSupported()
+{
+#if defined(Z80_JIT_X64)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Z80Jit::Reset()
+{
+    m_blockCode.clear();
+    m_codeUsed = 0;
+    m_compiledBlocks = 0;
+}
+
+void Z80Jit::Execute(uint32_t index)
+{
+    if (index >= m_blockCode.size()) {
+        m_blockCode.resize(m_cpu.m_blocks.size(), BLOCK_PENDING);
+    }
+
+    uintptr_t code = m_blockCode[index];
+    if (code == BLOCK_PENDING) {
+        code = m_blockCode[index] = Compile(index);
+    }
+
+    if (code == BLOCK_INTERPRET) {
+        m_cpu.ExecuteBlock(m_cpu.m_blocks[index]);
+    }
+    else if (m_differentialCheck) {
+        RunChecked(index, reinterpret_cast<BlockFunction>(code));
+    }
+    else {
+        reinterpret_cast<BlockFunction>(code)(&m_cpu);
+    }
+}
+
+uintptr_t Z80Jit::Compile(uint32_t index)
+{
+#if defined(Z80_JIT_X64)
+    if (!m_codeArena) {
+        return BLOCK_INTERPRET;
+    }
+
+    const Z80::CachedBlock &block = m_cpu.m_blocks[index];
+
+    // Registri a 8 e 16 bit nello stesso ordine della codifica degli opcode
+    // (B, C, D, E, H, L, (HL), A e BC, DE, HL, SP); 6 = (HL) non e' un registro
+    const uint8_t *reg8Members[8] = {
+        &m_cpu.BC.high, &m_cpu.BC.low, &m_cpu.DE.high, &m_cpu.DE.low,
+        &m_cpu.HL.high, &m_cpu.HL.low, nullptr, &m_cpu.A
+    };
+    const uint16_t *reg16Members[4] = { &m_cpu.BC.pair, &m_cpu.DE.pair, &m_cpu.HL.pair, &m_cpu.SP };
+
+    uint32_t reg8[8];
+    for (int r = 0; r < 8; r++) {
+        reg8[r] = reg8Members[r] ? OffsetOf(m_cpu, reg8Members[r]) : 0;
+    }
+    uint32_t reg16[4];
+    for (int r = 0; r < 4; r++) {
+        reg16[r] = OffsetOf(m_cpu, reg16Members[r]);
+    }
+    const uint32_t pcOffset = OffsetOf(m_cpu, &m_cpu.PC);
+
+    m_emit.clear();
+
+    // Prologo: rbx = Z80*, 32 byte di shadow space (Win64) mantenendo lo stack allineato a 16
+    Emit8(0x53);                                            // push rbx
+#if defined(_WIN32)
+    Emit8(0x48); Emit8(0x89); Emit8(0xCB);                  // mov rbx, rcx
+#else
+    Emit8(0x48); Emit8(0x89); Emit8(0xFB);                  // mov rbx, rdi
+#endif
+    Emit8(0x48); Emit8(0x83); Emit8(0xEC); Emit8(0x20);     // sub rsp, 32
+
+    uint16_t pendingPC = 0;     // Avanzamento del PC non ancora scritto (istruzioni native)
+    int lastCycles = -1;        // Cicli dell'ultima istruzione nativa (-1 = ultima era una chiamata)
+
+    for (uint32_t i = 0; i < block.count; i++) {
+        Z80::OpcodeFunction handler = m_cpu.m_blockHandlers[block.first + i];
+        uint16_t address = m_cpu.m_blockAddresses[block.first + i];
+        uint8_t opcode = m_cpu.m_memory->Read(address);
+        bool isLast = (i + 1 == block.count);
+
+        // --- Istruzioni tradotte in codice nativo (nessun flag coinvolto) ---
+        if (handler == &Z80::OP_NOP) {
+            pendingPC += 1;
+            lastCycles = 4;
+            continue;
+        }
+
+        if ((opcode & 0xC0) == 0x40 && handler == Z80::s_opcodeTable[opcode] && opcode != 0x76 && (opcode & 0x07) != 6 && ((opcode >> 3) & 0x07) != 6) {
+            // mov al, [rbx+src] ; mov [rbx+dst], al
+            Emit8(0x8A); Emit8(0x83); Emit32(reg8[opcode & 0x07]);
+            Emit8(0x88); Emit8(0x83); Emit32(reg8[(opcode >> 3) & 0x07]);
+            pendingPC += 1;
+            lastCycles = 4;
+            continue;
+        }
+
+        if ((opcode & 0xC7) == 0x06 && opcode != 0x36 &&
+            Z80::s_opcodeTable[opcode] == handler && handler != &Z80::OP_NotImplemented) {
+            // LD r, n: mov byte [rbx+r], n
+            Emit8(0xC6); Emit8(0x83); Emit32(reg8[(opcode >> 3) & 0x07]);
+            Emit8(m_cpu.m_memory->Read(address + 1));
+            pendingPC += 2;
+            lastCycles = 7;
+            continue;
+        }
+
+        if ((opcode & 0xCF) == 0x01 && Z80::s_opcodeTable[opcode] == handler && handler != &Z80::OP_NotImplemented) {
+            // LD rr, nn: mov word [rbx+rr], nn
+            uint16_t value = m_cpu.m_memory->Read(address + 1) | (m_cpu.m_memory->Read(address + 2) << 8);
+            Emit8(0x66); Emit8(0xC7); Emit8(0x83); Emit32(reg16[(opcode >> 4) & 0x03]); Emit16(value);
+            pendingPC += 3;
+            lastCycles = 10;
+            continue;
+        }
+
+        if ((opcode & 0xC7) == 0x03 && Z80::s_opcodeTable[opcode] == handler && handler != &Z80::OP_NotImplemented) {
+            // INC rr / DEC rr: inc/dec word [rbx+rr]
+            Emit8(0x66); Emit8(0xFF); Emit8((opcode & 0x08) ? 0x8B : 0x83); Emit32(reg16[(opcode >> 4) & 0x03]);
+            pendingPC += 1;
+            lastCycles = 6;
+            continue;
+        }
+
+        if (handler == &Z80::OP_JP_nn && isLast) {
+            // JP nn: il PC viene sovrascritto, l'avanzamento accumulato non serve
+            uint16_t target = m_cpu.m_memory->Read(address + 1) | (m_cpu.m_memory->Read(address + 2) << 8);
+            Emit8(0x66); Emit8(0xC7); Emit8(0x83); Emit32(pcOffset); Emit16(target);
+            pendingPC = 0;
+            lastCycles = 10;
+            continue;
+        }
+
+        // --- Chiamata all'handler dell'interprete ---
+        const void *function = nullptr;
+#if defined(_MSC_VER)
+        // MSVC (ereditarieta' singola): il puntatore a membro e' l'indirizzo del codice
+        static_assert(sizeof(handler) == sizeof(function), "layout del puntatore a membro inatteso");
+        std::memcpy(&function, &handler, sizeof(function));
+#else
+        // Itanium ABI: { indirizzo, aggiustamento di this }; bit 0 = funzione virtuale
+        struct { uintptr_t pointer; ptrdiff_t adjustment; } raw;
+        static_assert(sizeof(raw) == sizeof(handler), "layout del puntatore a membro inatteso");
+        std::memcpy(&raw, &handler, sizeof(raw));
+        if ((raw.pointer & 1) != 0 || raw.adjustment != 0) {
+            return BLOCK_INTERPRET;
+        }
+        function = reinterpret_cast<const void *>(raw.pointer);
+#endif
+
+        // L'handler legge gli operandi dal PC: va portato subito dopo l'opcode
+        EmitAddPC(pendingPC + 1);
+        pendingPC = 0;
+
+        // Un terminatore che non aggiorna i cicli lascia quelli dell'istruzione precedente
+        if (isLast && lastCycles >= 0) {
+            EmitStoreCycles(lastCycles);
+        }
+        EmitCall(function);
+        lastCycles = -1;
+    }
+
+    EmitAddPC(pendingPC);
+
+    const uint32_t totalOffset = OffsetOf(m_cpu, &m_cpu.m_totalCycles);
+    if (lastCycles >= 0) {
+        // Ultima istruzione nativa: durata nota in compilazione
+        EmitStoreCycles(lastCycles);
+        Emit8(0x48); Emit8(0x81); Emit8(0x83); Emit32(totalOffset);    // add qword [rbx+total], imm32
+        Emit32(block.prefixCycles + lastCycles);
+    }
+    else {
+        Emit8(0x48); Emit8(0x81); Emit8(0x83); Emit32(totalOffset);    // add qword [rbx+total], imm32
+        Emit32(block.prefixCycles);
+        Emit8(0x48); Emit8(0x63); Emit8(0x83);                          // movsxd rax, dword [rbx+last]
+        Emit32(OffsetOf(m_cpu, &m_cpu.m_cyclesLastInstruction));
+        Emit8(0x48); Emit8(0x01); Emit8(0x83); Emit32(totalOffset);    // add qword [rbx+total], rax
+    }
+
+    // Epilogo
+    Emit8(0x48); Emit8(0x83); Emit8(0xC4); Emit8(0x20);     // add rsp, 32
+    Emit8(0x5B);                                            // pop rbx
+    Emit8(0xC3);                                            // ret
+
+    // Arena piena: da qui in poi i nuovi blocchi restano all'interprete
+    if (m_codeUsed + m_emit.size() > CODE_ARENA_SIZE) {
+        return BLOCK_INTERPRET;
+    }
+
+    // Solo le pagine del nuovo blocco diventano scrivibili, e solo per la copia
+    uint8_t *code = m_codeArena + m_codeUsed;
+    if (!ProtectCode(code, m_emit.size(), true)) {
+        return BLOCK_INTERPRET;
+    }
+    std::memcpy(code, m_emit.data(), m_emit.size());
+    if (!ProtectCode(code, m_emit.size(), false)) {
+        // Pagine rimaste RW: non vanno eseguite, e l'arena non va piu' usata
+        std::cerr << "Z80Jit: impossibile rendere eseguibile il codice, uso l'interprete" << std::endl;
+        FreeCode(m_codeArena, CODE_ARENA_SIZE);
+        m_codeArena = nullptr;
+        m_blockCode.assign(m_blockCode.size(), BLOCK_INTERPRET);
+        return BLOCK_INTERPRET;
+    }
+    m_codeUsed += (m_emit.size() + 15) & ~size_t(15);
+#if defined(_WIN32)
+    FlushInstructionCache(GetCurrentProcess(), code, m_emit.size());
+#endif
+    m_compiledBlocks++;
+    return reinterpret_cast<uintptr_t>(code);
+#else
+    return BLOCK_INTERPRET;
+#endif
+}
+
+void Z80Jit::RunChecked(uint32_t index, BlockFunction code)
+{
+    const Z80::CachedBlock &block = m_cpu.m_blocks[index];
+
+    // LoadState marca sporca tutta la tilemap: i bit vanno ripristinati a mano,
+    // cosi' restano sporche solo le celle scritte dall'interprete
+    const std::bitset<0x400> tileDirty = m_cpu.m_memory->GetTileDirty();
+    CaptureState(m_stateBefore);
+    code(&m_cpu);
+    CaptureState(m_stateJit);
+
+    // Riferimento: lo stesso blocco eseguito dall'interprete, un'istruzione alla volta
+    RestoreState(m_stateBefore);
+    m_cpu.m_memory->SetTileDirty(tileDirty);
+    for (uint32_t i = 0; i < block.count; i++) {
+        uint8_t opcode = m_cpu.FetchByte();
+        (m_cpu.*Z80::s_opcodeTable[opcode])();
+        m_cpu.m_totalCycles += m_cpu.m_cyclesLastInstruction;
+    }
+    CaptureState(m_stateInterpreter);
+
+    if (m_stateJit != m_stateInterpreter) {
+        size_t offset = 0;
+        while (m_stateJit[offset] == m_stateInterpreter[offset]) offset++;
+
+        std::cerr << "Z80Jit: stato diverso dall'interprete nel blocco a 0x" << std::hex << std::setfill('0')
+            << std::setw(4) << m_cpu.m_blockAddresses[block.first] << std::dec
+            << (offset < Z80::STATE_SIZE ? " (registri CPU" : " (memoria")
+            << ", offset " << offset << "), il blocco verra' interpretato" << std::endl;
+
+        // Lo stato corrente e' gia' quello dell'interprete
+        m_mismatches++;
+        m_blockCode[index] = BLOCK_INTERPRET;
+    }
+}
+
+void Z80Jit::CaptureState(std::vector<uint8_t> &buffer)
+{
+    buffer.clear();
+    StateWriter writer(buffer);
+    m_cpu.SaveState(writer);
+    m_cpu.m_memory->SaveState(writer);
+}
+
+void Z80Jit::RestoreState(const std::vector<uint8_t> &buffer)
+{
+    StateReader reader(buffer.data(), buffer.size());
+    m_cpu.LoadState(reader);
+    m_cpu.m_memory->LoadState(reader);
+}
+
+void Z80Jit::Emit8(uint8_t value)
+{
+    m_emit.push_back(value);
+}
+
+void Z80Jit::Emit16(uint16_t value)
+{
+    Emit8(value & 0xFF);
+    Emit8(value >> 8);
+}
+
+void Z80Jit::Emit32(uint32_t value)
+{
+    Emit16(value & 0xFFFF);
+    Emit16(value >> 16);
+}
+
+void Z80Jit::Emit64(uint64_t value)
+{
+    Emit32(static_cast<uint32_t>(value));
+    Emit32(static_cast<uint32_t>(value >> 32));
+}
+
+void Z80Jit::EmitAddPC(uint16_t delta)
+{
+    if (delta == 0) return;
+
+    // add word [rbx+PC], delta
+    Emit8(0x66); Emit8(0x81); Emit8(0x83);
+    Emit32(OffsetOf(m_cpu, &m_cpu.PC));
+    Emit16(delta);
+}
+
+void Z80Jit::EmitStoreCycles(int cycles)
+{
+    // mov dword [rbx+m_cyclesLastInstruction], cycles
+    Emit8(0xC7); Emit8(0x83);
+    Emit32(OffsetOf(m_cpu, &m_cpu.m_cyclesLastInstruction));
+    Emit32(static_cast<uint32_t>(cycles));
+}
+
+void Z80Jit::EmitCall(const void *function)
+{
+    // Primo argomento (this) = rbx, poi call indiretta tramite rax
+#if defined(_WIN32)
+    Emit8(0x48); Emit8(0x89); Emit8(0xD9);                  // mov rcx, rbx
+#else
+    Emit8(0x48); Emit8(0x89); Emit8(0xDF);                  // mov rdi, rbx
+#endif
+    Emit8(0x48); Emit8(0xB8);                               // mov rax, imm64
+    Emit64(reinterpret_cast<uint64_t>(function));
+    Emit8(0xFF); Emit8(0xD0);                               // call rax
+}
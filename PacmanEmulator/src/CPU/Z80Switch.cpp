@@ -0,0 +1,469 @@
+#include "CPU/Z80.h"
+#include "CPU/Z80Tables.h"
+#include <utility>
+
+// Core di dispatch alternativo, scelto a compile time con Z80_SWITCH_DISPATCH.
+// Invece di chiamare un handler tramite puntatore a membro per ogni istruzione,
+// le istruzioni senza prefisso sono espanse in un unico switch (o in codice
+// threaded con computed goto su GCC/Clang) e i registri restano in variabili
+// locali per tutto il Run: il compilatore li tiene nei registri dell'host e non
+// li riscrive in memoria a ogni istruzione. I cicli arrivano da Z80_CYCLES.
+// Le istruzioni rare o con prefisso passano dall'handler della tabella, dopo
+// aver riportato i registri nei membri.
+
+#if defined(Z80_SWITCH_DISPATCH)
+
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(Z80_NO_COMPUTED_GOTO)
+#define Z80_COMPUTED_GOTO 1
+#endif
+
+// Operazioni ALU su A con i flag dalle tabelle, identiche agli helper di Z80.cpp
+#define ALU_ADD(v) { uint8_t value = (v); f = g_z80Flags.add[0][a][value]; a += value; }
+#define ALU_ADC(v) { uint8_t value = (v); uint8_t carry = f & FLAG_C; f = g_z80Flags.add[carry][a][value]; a = a + value + carry; }
+#define ALU_SUB(v) { uint8_t value = (v); f = g_z80Flags.sub[0][a][value]; a -= value; }
+#define ALU_SBC(v) { uint8_t value = (v); uint8_t carry = f & FLAG_C; f = g_z80Flags.sub[carry][a][value]; a = a - value - carry; }
+#define ALU_AND(v) { a &= (v); f = g_z80Flags.szp[a] | FLAG_H; }
+#define ALU_XOR(v) { a ^= (v); f = g_z80Flags.szp[a]; }
+#define ALU_OR(v) { a |= (v); f = g_z80Flags.szp[a]; }
+#define ALU_CP(v) { uint8_t value = (v); f = (g_z80Flags.sub[0][a][value] & ~(FLAG_X | FLAG_Y)) | (value & (FLAG_X | FLAG_Y)); }
+
+#define INC_8(r) { r++; f = (f & FLAG_C) | g_z80Flags.inc[r]; }
+#define DEC_8(r) { r--; f = (f & FLAG_C) | g_z80Flags.dec[r]; }
+
+#define FETCH_16(dst) { uint8_t low = mem->Read(pc++); uint8_t high = mem->Read(pc++); dst = (high << 8) | low; }
+#define PUSH_16(v) { uint16_t value = (v); mem->Write(--sp, value >> 8); mem->Write(--sp, value & 0xFF); }
+#define POP_16(dst) { uint8_t low = mem->Read(sp++); uint8_t high = mem->Read(sp++); dst = (high << 8) | low; }
+
+#define ADD_HL(v) { uint16_t value = (v); uint32_t result = hl.pair + value; \
+    f = (f & ~(FLAG_C | FLAG_H | FLAG_N)) | (result > 0xFFFF ? FLAG_C : 0) | \
+        (((hl.pair & 0x0FFF) + (value & 0x0FFF)) > 0x0FFF ? FLAG_H : 0); \
+    hl.pair = result & 0xFFFF; }
+
+// Salti e chiamate: il costo base (condizione falsa) e' gia' stato contato
+#define JR_IF(cond) { int8_t offset = static_cast<int8_t>(mem->Read(pc++)); if (cond) { pc += offset; cycles += 5; } }
+#define JP_IF(cond) { uint16_t address; FETCH_16(address); if (cond) pc = address; }
+#define CALL_IF(cond) { uint16_t address; FETCH_16(address); if (cond) { PUSH_16(pc); pc = address; cycles += 7; } }
+#define RET_IF(cond) { if (cond) { POP_16(pc); cycles += 6; } }
+#define RST(address) { PUSH_16(pc); pc = address; }
+
+uint64_t Z80::RunSwitch(uint64_t cycleBudget)
+{
+    MemoryBus *mem = m_memory;
+
+    // Registri in locali per tutta la durata del Run
+    uint8_t a = A, f = F;
+    RegisterPair bc = BC, de = DE, hl = HL;
+    uint16_t pc = PC, sp = SP;
+
+    const uint64_t start = m_totalCycles;
+    const uint64_t target = start + cycleBudget;
+    uint64_t cycles = start;
+    // All'ingresso l'istruzione "corrente" e' l'ultima del Run precedente
+    uint64_t instructionStart = start - m_cyclesLastInstruction;
+    uint8_t opcode;
+
+    if (m_halted) goto halted;
+
+#if defined(Z80_COMPUTED_GOTO)
+    // Codice threaded: ogni istruzione salta direttamente alla successiva
+    static const void *const s_dispatch[256] = {
+        &&op_0x00, &&op_0x01, &&op_0x02, &&op_0x03, &&op_0x04, &&op_0x05, &&op_0x06, &&op_0x07,
+        &&op_0x08, &&op_0x09, &&op_0x0A, &&op_0x0B, &&op_0x0C, &&op_0x0D, &&op_0x0E, &&op_0x0F,
+        &&op_0x10, &&op_0x11, &&op_0x12, &&op_0x13, &&op_0x14, &&op_0x15, &&op_0x16, &&op_0x17,
+        &&op_0x18, &&op_0x19, &&op_0x1A, &&op_0x1B, &&op_0x1C, &&op_0x1D, &&op_0x1E, &&op_0x1F,
+        &&op_0x20, &&op_0x21, &&op_0x22, &&op_0x23, &&op_0x24, &&op_0x25, &&op_0x26, &&op_0x27,
+        &&op_0x28, &&op_0x29, &&op_0x2A, &&op_0x2B, &&op_0x2C, &&op_0x2D, &&op_0x2E, &&op_0x2F,
+        &&op_0x30, &&op_0x31, &&op_0x32, &&op_0x33, &&op_0x34, &&op_0x35, &&op_0x36, &&op_0x37,
+        &&op_0x38, &&op_0x39, &&op_0x3A, &&op_0x3B, &&op_0x3C, &&op_0x3D, &&op_0x3E, &&op_0x3F,
+        &&op_0x40, &&op_0x41, &&op_0x42, &&op_0x43, &&op_0x44, &&op_0x45, &&op_0x46, &&op_0x47,
+        &&op_0x48, &&op_0x49, &&op_0x4A, &&op_0x4B, &&op_0x4C, &&op_0x4D, &&op_0x4E, &&op_0x4F,
+        &&op_0x50, &&op_0x51, &&op_0x52, &&op_0x53, &&op_0x54, &&op_0x55, &&op_0x56, &&op_0x57,
+        &&op_0x58, &&op_0x59, &&op_0x5A, &&op_0x5B, &&op_0x5C, &&op_0x5D, &&op_0x5E, &&op_0x5F,
+        &&op_0x60, &&op_0x61, &&op_0x62, &&op_0x63, &&op_0x64, &&op_0x65, &&op_0x66, &&op_0x67,
+        &&op_0x68, &&op_0x69, &&op_0x6A, &&op_0x6B, &&op_0x6C, &&op_0x6D, &&op_0x6E, &&op_0x6F,
+        &&op_0x70, &&op_0x71, &&op_0x72, &&op_0x73, &&op_0x74, &&op_0x75, &&op_0x76, &&op_0x77,
+        &&op_0x78, &&op_0x79, &&op_0x7A, &&op_0x7B, &&op_0x7C, &&op_0x7D, &&op_0x7E, &&op_0x7F,
+        &&op_0x80, &&op_0x81, &&op_0x82, &&op_0x83, &&op_0x84, &&op_0x85, &&op_0x86, &&op_0x87,
+        &&op_0x88, &&op_0x89, &&op_0x8A, &&op_0x8B, &&op_0x8C, &&op_0x8D, &&op_0x8E, &&op_0x8F,
+        &&op_0x90, &&op_0x91, &&op_0x92, &&op_0x93, &&op_0x94, &&op_0x95, &&op_0x96, &&op_0x97,
+        &&op_0x98, &&op_0x99, &&op_0x9A, &&op_0x9B, &&op_0x9C, &&op_0x9D, &&op_0x9E, &&op_0x9F,
+        &&op_0xA0, &&op_0xA1, &&op_0xA2, &&op_0xA3, &&op_0xA4, &&op_0xA5, &&op_0xA6, &&op_0xA7,
+        &&op_0xA8, &&op_0xA9, &&op_0xAA, &&op_0xAB, &&op_0xAC, &&op_0xAD, &&op_0xAE, &&op_0xAF,
+        &&op_0xB0, &&op_0xB1, &&op_0xB2, &&op_0xB3, &&op_0xB4, &&op_0xB5, &&op_0xB6, &&op_0xB7,
+        &&op_0xB8, &&op_0xB9, &&op_0xBA, &&op_0xBB, &&op_0xBC, &&op_0xBD, &&op_0xBE, &&op_0xBF,
+        &&op_0xC0, &&op_0xC1, &&op_0xC2, &&op_0xC3, &&op_0xC4, &&op_0xC5, &&op_0xC6, &&op_0xC7,
+        &&op_0xC8, &&op_0xC9, &&op_0xCA, &&op_0xCB, &&op_0xCC, &&op_0xCD, &&op_0xCE, &&op_0xCF,
+        &&op_0xD0, &&op_0xD1, &&op_0xD2, &&op_0xD3, &&op_0xD4, &&op_0xD5, &&op_0xD6, &&op_0xD7,
+        &&op_0xD8, &&op_0xD9, &&op_0xDA, &&op_0xDB, &&op_0xDC, &&op_0xDD, &&op_0xDE, &&op_0xDF,
+        &&op_0xE0, &&op_0xE1, &&op_0xE2, &&op_0xE3, &&op_0xE4, &&op_0xE5, &&op_0xE6, &&op_0xE7,
+        &&op_0xE8, &&op_0xE9, &&op_0xEA, &&op_0xEB, &&op_0xEC, &&op_0xED, &&op_0xEE, &&op_0xEF,
+        &&op_0xF0, &&op_0xF1, &&op_0xF2, &&op_0xF3, &&op_0xF4, &&op_0xF5, &&op_0xF6, &&op_0xF7,
+        &&op_0xF8, &&op_0xF9, &&op_0xFA, &&op_0xFB, &&op_0xFC, &&op_0xFD, &&op_0xFE, &&op_0xFF,
+    };
+
+#define OPCODE(n) op_##n:
+#define NEXT() \
+    if (cycles >= target) goto done; \
+    instructionStart = cycles; \
+    opcode = mem->Read(pc++); \
+    cycles += Z80_CYCLES[opcode]; \
+    goto *s_dispatch[opcode]
+
+    NEXT();
+    {
+#else
+#define OPCODE(n) case n:
+#define NEXT() break
+
+    while (cycles < target) {
+        instructionStart = cycles;
+        opcode = mem->Read(pc++);
+        cycles += Z80_CYCLES[opcode];
+
+        switch (opcode) {
+#endif
+        OPCODE(0x00) NEXT();
+
+        // LD rr,nn / LD SP,HL
+        OPCODE(0x01) FETCH_16(bc.pair); NEXT();
+        OPCODE(0x11) FETCH_16(de.pair); NEXT();
+        OPCODE(0x21) FETCH_16(hl.pair); NEXT();
+        OPCODE(0x31) FETCH_16(sp); NEXT();
+        OPCODE(0xF9) sp = hl.pair; NEXT();
+
+        // LD indiretti con A e HL
+        OPCODE(0x02) mem->Write(bc.pair, a); NEXT();
+        OPCODE(0x12) mem->Write(de.pair, a); NEXT();
+        OPCODE(0x0A) a = mem->Read(bc.pair); NEXT();
+        OPCODE(0x1A) a = mem->Read(de.pair); NEXT();
+        OPCODE(0x32) { uint16_t address; FETCH_16(address); mem->Write(address, a); } NEXT();
+        OPCODE(0x3A) { uint16_t address; FETCH_16(address); a = mem->Read(address); } NEXT();
+        OPCODE(0x22) { uint16_t address; FETCH_16(address); mem->Write(address, hl.low); mem->Write(address + 1, hl.high); } NEXT();
+        OPCODE(0x2A) { uint16_t address; FETCH_16(address); hl.low = mem->Read(address); hl.high = mem->Read(address + 1); } NEXT();
+
+        // INC/DEC rr
+        OPCODE(0x03) bc.pair++; NEXT();
+        OPCODE(0x13) de.pair++; NEXT();
+        OPCODE(0x23) hl.pair++; NEXT();
+        OPCODE(0x33) sp++; NEXT();
+        OPCODE(0x0B) bc.pair--; NEXT();
+        OPCODE(0x1B) de.pair--; NEXT();
+        OPCODE(0x2B) hl.pair--; NEXT();
+        OPCODE(0x3B) sp--; NEXT();
+
+        // ADD HL,rr
+        OPCODE(0x09) ADD_HL(bc.pair); NEXT();
+        OPCODE(0x19) ADD_HL(de.pair); NEXT();
+        OPCODE(0x29) ADD_HL(hl.pair); NEXT();
+        OPCODE(0x39) ADD_HL(sp); NEXT();
+
+        // INC/DEC r e (HL)
+        OPCODE(0x04) INC_8(bc.high); NEXT();
+        OPCODE(0x0C) INC_8(bc.low); NEXT();
+        OPCODE(0x14) INC_8(de.high); NEXT();
+        OPCODE(0x1C) INC_8(de.low); NEXT();
+        OPCODE(0x24) INC_8(hl.high); NEXT();
+        OPCODE(0x2C) INC_8(hl.low); NEXT();
+        OPCODE(0x3C) INC_8(a); NEXT();
+        OPCODE(0x34) { uint8_t value = mem->Read(hl.pair); INC_8(value); mem->Write(hl.pair, value); } NEXT();
+        OPCODE(0x05) DEC_8(bc.high); NEXT();
+        OPCODE(0x0D) DEC_8(bc.low); NEXT();
+        OPCODE(0x15) DEC_8(de.high); NEXT();
+        OPCODE(0x1D) DEC_8(de.low); NEXT();
+        OPCODE(0x25) DEC_8(hl.high); NEXT();
+        OPCODE(0x2D) DEC_8(hl.low); NEXT();
+        OPCODE(0x3D) DEC_8(a); NEXT();
+        OPCODE(0x35) { uint8_t value = mem->Read(hl.pair); DEC_8(value); mem->Write(hl.pair, value); } NEXT();
+
+        // LD r,n e LD (HL),n
+        OPCODE(0x06) bc.high = mem->Read(pc++); NEXT();
+        OPCODE(0x0E) bc.low = mem->Read(pc++); NEXT();
+        OPCODE(0x16) de.high = mem->Read(pc++); NEXT();
+        OPCODE(0x1E) de.low = mem->Read(pc++); NEXT();
+        OPCODE(0x26) hl.high = mem->Read(pc++); NEXT();
+        OPCODE(0x2E) hl.low = mem->Read(pc++); NEXT();
+        OPCODE(0x3E) a = mem->Read(pc++); NEXT();
+        OPCODE(0x36) { uint8_t value = mem->Read(pc++); mem->Write(hl.pair, value); } NEXT();
+
+        // Rotazioni dell'accumulatore e flag: S, Z e P/V non cambiano
+        OPCODE(0x07) { uint8_t bit7 = a >> 7; a = (a << 1) | bit7; f = (f & ~(FLAG_H | FLAG_N | FLAG_C)) | bit7; } NEXT();
+        OPCODE(0x0F) { uint8_t bit0 = a & 0x01; a = (a >> 1) | (bit0 << 7); f = (f & ~(FLAG_H | FLAG_N | FLAG_C)) | bit0; } NEXT();
+        OPCODE(0x17) { uint8_t bit7 = a >> 7; a = (a << 1) | (f & FLAG_C); f = (f & ~(FLAG_H | FLAG_N | FLAG_C)) | bit7; } NEXT();
+        OPCODE(0x1F) { uint8_t bit0 = a & 0x01; a = (a >> 1) | ((f & FLAG_C) << 7); f = (f & ~(FLAG_H | FLAG_N | FLAG_C)) | bit0; } NEXT();
+        OPCODE(0x2F) a ^= 0xFF; f |= FLAG_H | FLAG_N; NEXT();
+        OPCODE(0x37) f = (f & ~(FLAG_H | FLAG_N)) | FLAG_C; NEXT();
+        OPCODE(0x3F) f = ((f & ~(FLAG_H | FLAG_N)) | ((f & FLAG_C) ? FLAG_H : 0)) ^ FLAG_C; NEXT();
+
+        // Salti relativi
+        OPCODE(0x10) if (--bc.high != 0) { pc += static_cast<int8_t>(mem->Read(pc)) + 1; cycles += 5; } else { pc++; } NEXT();
+        OPCODE(0x18) pc += static_cast<int8_t>(mem->Read(pc)) + 1; NEXT();
+        OPCODE(0x20) JR_IF(!(f & FLAG_Z)); NEXT();
+        OPCODE(0x28) JR_IF(f & FLAG_Z); NEXT();
+        OPCODE(0x30) JR_IF(!(f & FLAG_C)); NEXT();
+        OPCODE(0x38) JR_IF(f & FLAG_C); NEXT();
+
+        // LD r,r' (0x76 e' HALT)
+        OPCODE(0x40) bc.high = bc.high; NEXT();
+        OPCODE(0x41) bc.high = bc.low; NEXT();
+        OPCODE(0x42) bc.high = de.high; NEXT();
+        OPCODE(0x43) bc.high = de.low; NEXT();
+        OPCODE(0x44) bc.high = hl.high; NEXT();
+        OPCODE(0x45) bc.high = hl.low; NEXT();
+        OPCODE(0x46) bc.high = mem->Read(hl.pair); NEXT();
+        OPCODE(0x47) bc.high = a; NEXT();
+
+        OPCODE(0x48) bc.low = bc.high; NEXT();
+        OPCODE(0x49) bc.low = bc.low; NEXT();
+        OPCODE(0x4A) bc.low = de.high; NEXT();
+        OPCODE(0x4B) bc.low = de.low; NEXT();
+        OPCODE(0x4C) bc.low = hl.high; NEXT();
+        OPCODE(0x4D) bc.low = hl.low; NEXT();
+        OPCODE(0x4E) bc.low = mem->Read(hl.pair); NEXT();
+        OPCODE(0x4F) bc.low = a; NEXT();
+
+        OPCODE(0x50) de.high = bc.high; NEXT();
+        OPCODE(0x51) de.high = bc.low; NEXT();
+        OPCODE(0x52) de.high = de.high; NEXT();
+        OPCODE(0x53) de.high = de.low; NEXT();
+        OPCODE(0x54) de.high = hl.high; NEXT();
+        OPCODE(0x55) de.high = hl.low; NEXT();
+        OPCODE(0x56) de.high = mem->Read(hl.pair); NEXT();
+        OPCODE(0x57) de.high = a; NEXT();
+
+        OPCODE(0x58) de.low = bc.high; NEXT();
+        OPCODE(0x59) de.low = bc.low; NEXT();
+        OPCODE(0x5A) de.low = de.high; NEXT();
+        OPCODE(0x5B) de.low = de.low; NEXT();
+        OPCODE(0x5C) de.low = hl.high; NEXT();
+        OPCODE(0x5D) de.low = hl.low; NEXT();
+        OPCODE(0x5E) de.low = mem->Read(hl.pair); NEXT();
+        OPCODE(0x5F) de.low = a; NEXT();
+
+        OPCODE(0x60) hl.high = bc.high; NEXT();
+        OPCODE(0x61) hl.high = bc.low; NEXT();
+        OPCODE(0x62) hl.high = de.high; NEXT();
+        OPCODE(0x63) hl.high = de.low; NEXT();
+        OPCODE(0x64) hl.high = hl.high; NEXT();
+        OPCODE(0x65) hl.high = hl.low; NEXT();
+        OPCODE(0x66) hl.high = mem->Read(hl.pair); NEXT();
+        OPCODE(0x67) hl.high = a; NEXT();
+
+        OPCODE(0x68) hl.low = bc.high; NEXT();
+        OPCODE(0x69) hl.low = bc.low; NEXT();
+        OPCODE(0x6A) hl.low = de.high; NEXT();
+        OPCODE(0x6B) hl.low = de.low; NEXT();
+        OPCODE(0x6C) hl.low = hl.high; NEXT();
+        OPCODE(0x6D) hl.low = hl.low; NEXT();
+        OPCODE(0x6E) hl.low = mem->Read(hl.pair); NEXT();
+        OPCODE(0x6F) hl.low = a; NEXT();
+
+        OPCODE(0x70) mem->Write(hl.pair, bc.high); NEXT();
+        OPCODE(0x71) mem->Write(hl.pair, bc.low); NEXT();
+        OPCODE(0x72) mem->Write(hl.pair, de.high); NEXT();
+        OPCODE(0x73) mem->Write(hl.pair, de.low); NEXT();
+        OPCODE(0x74) mem->Write(hl.pair, hl.high); NEXT();
+        OPCODE(0x75) mem->Write(hl.pair, hl.low); NEXT();
+        OPCODE(0x77) mem->Write(hl.pair, a); NEXT();
+
+        OPCODE(0x78) a = bc.high; NEXT();
+        OPCODE(0x79) a = bc.low; NEXT();
+        OPCODE(0x7A) a = de.high; NEXT();
+        OPCODE(0x7B) a = de.low; NEXT();
+        OPCODE(0x7C) a = hl.high; NEXT();
+        OPCODE(0x7D) a = hl.low; NEXT();
+        OPCODE(0x7E) a = mem->Read(hl.pair); NEXT();
+        OPCODE(0x7F) a = a; NEXT();
+
+        // ALU A,r e A,(HL)
+        OPCODE(0x80) ALU_ADD(bc.high); NEXT();
+        OPCODE(0x81) ALU_ADD(bc.low); NEXT();
+        OPCODE(0x82) ALU_ADD(de.high); NEXT();
+        OPCODE(0x83) ALU_ADD(de.low); NEXT();
+        OPCODE(0x84) ALU_ADD(hl.high); NEXT();
+        OPCODE(0x85) ALU_ADD(hl.low); NEXT();
+        OPCODE(0x86) ALU_ADD(mem->Read(hl.pair)); NEXT();
+        OPCODE(0x87) ALU_ADD(a); NEXT();
+
+        OPCODE(0x88) ALU_ADC(bc.high); NEXT();
+        OPCODE(0x89) ALU_ADC(bc.low); NEXT();
+        OPCODE(0x8A) ALU_ADC(de.high); NEXT();
+        OPCODE(0x8B) ALU_ADC(de.low); NEXT();
+        OPCODE(0x8C) ALU_ADC(hl.high); NEXT();
+        OPCODE(0x8D) ALU_ADC(hl.low); NEXT();
+        OPCODE(0x8E) ALU_ADC(mem->Read(hl.pair)); NEXT();
+        OPCODE(0x8F) ALU_ADC(a); NEXT();
+
+        OPCODE(0x90) ALU_SUB(bc.high); NEXT();
+        OPCODE(0x91) ALU_SUB(bc.low); NEXT();
+        OPCODE(0x92) ALU_SUB(de.high); NEXT();
+        OPCODE(0x93) ALU_SUB(de.low); NEXT();
+        OPCODE(0x94) ALU_SUB(hl.high); NEXT();
+        OPCODE(0x95) ALU_SUB(hl.low); NEXT();
+        OPCODE(0x96) ALU_SUB(mem->Read(hl.pair)); NEXT();
+        OPCODE(0x97) ALU_SUB(a); NEXT();
+
+        OPCODE(0x98) ALU_SBC(bc.high); NEXT();
+        OPCODE(0x99) ALU_SBC(bc.low); NEXT();
+        OPCODE(0x9A) ALU_SBC(de.high); NEXT();
+        OPCODE(0x9B) ALU_SBC(de.low); NEXT();
+        OPCODE(0x9C) ALU_SBC(hl.high); NEXT();
+        OPCODE(0x9D) ALU_SBC(hl.low); NEXT();
+        OPCODE(0x9E) ALU_SBC(mem->Read(hl.pair)); NEXT();
+        OPCODE(0x9F) ALU_SBC(a); NEXT();
+
+        OPCODE(0xA0) ALU_AND(bc.high); NEXT();
+        OPCODE(0xA1) ALU_AND(bc.low); NEXT();
+        OPCODE(0xA2) ALU_AND(de.high); NEXT();
+        OPCODE(0xA3) ALU_AND(de.low); NEXT();
+        OPCODE(0xA4) ALU_AND(hl.high); NEXT();
+        OPCODE(0xA5) ALU_AND(hl.low); NEXT();
+        OPCODE(0xA6) ALU_AND(mem->Read(hl.pair)); NEXT();
+        OPCODE(0xA7) ALU_AND(a); NEXT();
+
+        OPCODE(0xA8) ALU_XOR(bc.high); NEXT();
+        OPCODE(0xA9) ALU_XOR(bc.low); NEXT();
+        OPCODE(0xAA) ALU_XOR(de.high); NEXT();
+        OPCODE(0xAB) ALU_XOR(de.low); NEXT();
+        OPCODE(0xAC) ALU_XOR(hl.high); NEXT();
+        OPCODE(0xAD) ALU_XOR(hl.low); NEXT();
+        OPCODE(0xAE) ALU_XOR(mem->Read(hl.pair)); NEXT();
+        OPCODE(0xAF) ALU_XOR(a); NEXT();
+
+        OPCODE(0xB0) ALU_OR(bc.high); NEXT();
+        OPCODE(0xB1) ALU_OR(bc.low); NEXT();
+        OPCODE(0xB2) ALU_OR(de.high); NEXT();
+        OPCODE(0xB3) ALU_OR(de.low); NEXT();
+        OPCODE(0xB4) ALU_OR(hl.high); NEXT();
+        OPCODE(0xB5) ALU_OR(hl.low); NEXT();
+        OPCODE(0xB6) ALU_OR(mem->Read(hl.pair)); NEXT();
+        OPCODE(0xB7) ALU_OR(a); NEXT();
+
+        OPCODE(0xB8) ALU_CP(bc.high); NEXT();
+        OPCODE(0xB9) ALU_CP(bc.low); NEXT();
+        OPCODE(0xBA) ALU_CP(de.high); NEXT();
+        OPCODE(0xBB) ALU_CP(de.low); NEXT();
+        OPCODE(0xBC) ALU_CP(hl.high); NEXT();
+        OPCODE(0xBD) ALU_CP(hl.low); NEXT();
+        OPCODE(0xBE) ALU_CP(mem->Read(hl.pair)); NEXT();
+        OPCODE(0xBF) ALU_CP(a); NEXT();
+
+        // ALU A,n
+        OPCODE(0xC6) ALU_ADD(mem->Read(pc++)); NEXT();
+        OPCODE(0xCE) ALU_ADC(mem->Read(pc++)); NEXT();
+        OPCODE(0xD6) ALU_SUB(mem->Read(pc++)); NEXT();
+        OPCODE(0xDE) ALU_SBC(mem->Read(pc++)); NEXT();
+        OPCODE(0xE6) ALU_AND(mem->Read(pc++)); NEXT();
+        OPCODE(0xEE) ALU_XOR(mem->Read(pc++)); NEXT();
+        OPCODE(0xF6) ALU_OR(mem->Read(pc++)); NEXT();
+        OPCODE(0xFE) ALU_CP(mem->Read(pc++)); NEXT();
+
+        // Salti assoluti
+        OPCODE(0xC3) FETCH_16(pc); NEXT();
+        OPCODE(0xC2) JP_IF(!(f & FLAG_Z)); NEXT();
+        OPCODE(0xCA) JP_IF(f & FLAG_Z); NEXT();
+        OPCODE(0xD2) JP_IF(!(f & FLAG_C)); NEXT();
+        OPCODE(0xDA) JP_IF(f & FLAG_C); NEXT();
+        OPCODE(0xE2) JP_IF(!(f & FLAG_PV)); NEXT();
+        OPCODE(0xEA) JP_IF(f & FLAG_PV); NEXT();
+        OPCODE(0xF2) JP_IF(!(f & FLAG_S)); NEXT();
+        OPCODE(0xFA) JP_IF(f & FLAG_S); NEXT();
+        OPCODE(0xE9) pc = hl.pair; NEXT();
+
+        // Call, ret, rst
+        OPCODE(0xCD) { uint16_t address; FETCH_16(address); PUSH_16(pc); pc = address; } NEXT();
+        OPCODE(0xC4) CALL_IF(!(f & FLAG_Z)); NEXT();
+        OPCODE(0xCC) CALL_IF(f & FLAG_Z); NEXT();
+        OPCODE(0xD4) CALL_IF(!(f & FLAG_C)); NEXT();
+        OPCODE(0xDC) CALL_IF(f & FLAG_C); NEXT();
+        OPCODE(0xE4) CALL_IF(!(f & FLAG_PV)); NEXT();
+        OPCODE(0xEC) CALL_IF(f & FLAG_PV); NEXT();
+        OPCODE(0xF4) CALL_IF(!(f & FLAG_S)); NEXT();
+        OPCODE(0xFC) CALL_IF(f & FLAG_S); NEXT();
+        OPCODE(0xC9) POP_16(pc); NEXT();
+        OPCODE(0xC0) RET_IF(!(f & FLAG_Z)); NEXT();
+        OPCODE(0xC8) RET_IF(f & FLAG_Z); NEXT();
+        OPCODE(0xD0) RET_IF(!(f & FLAG_C)); NEXT();
+        OPCODE(0xD8) RET_IF(f & FLAG_C); NEXT();
+        OPCODE(0xE0) RET_IF(!(f & FLAG_PV)); NEXT();
+        OPCODE(0xE8) RET_IF(f & FLAG_PV); NEXT();
+        OPCODE(0xF0) RET_IF(!(f & FLAG_S)); NEXT();
+        OPCODE(0xF8) RET_IF(f & FLAG_S); NEXT();
+        OPCODE(0xC7) RST(0x00); NEXT();
+        OPCODE(0xCF) RST(0x08); NEXT();
+        OPCODE(0xD7) RST(0x10); NEXT();
+        OPCODE(0xDF) RST(0x18); NEXT();
+        OPCODE(0xE7) RST(0x20); NEXT();
+        OPCODE(0xEF) RST(0x28); NEXT();
+        OPCODE(0xF7) RST(0x30); NEXT();
+        OPCODE(0xFF) RST(0x38); NEXT();
+
+        // Stack
+        OPCODE(0xC5) PUSH_16(bc.pair); NEXT();
+        OPCODE(0xD5) PUSH_16(de.pair); NEXT();
+        OPCODE(0xE5) PUSH_16(hl.pair); NEXT();
+        OPCODE(0xF5) PUSH_16((a << 8) | f); NEXT();
+        OPCODE(0xC1) POP_16(bc.pair); NEXT();
+        OPCODE(0xD1) POP_16(de.pair); NEXT();
+        OPCODE(0xE1) POP_16(hl.pair); NEXT();
+        OPCODE(0xF1) { uint16_t af; POP_16(af); a = af >> 8; f = af & 0xFF; } NEXT();
+
+        // Scambi
+        OPCODE(0xEB) std::swap(de, hl); NEXT();
+        OPCODE(0x08) std::swap(a, A_alt); std::swap(f, F_alt); NEXT();
+        OPCODE(0xE3) { uint16_t value; POP_16(value); PUSH_16(hl.pair); hl.pair = value; } NEXT();
+
+        // DAA: correzione BCD dopo una somma (N = 0) o una sottrazione (N = 1), come OP_DAA
+        OPCODE(0x27) {
+            uint8_t correction = 0;
+            bool carry = (f & FLAG_C) != 0;
+            if ((f & FLAG_H) || (a & 0x0F) > 9) correction |= 0x06;
+            if (carry || a > 0x99) { correction |= 0x60; carry = true; }
+            bool subtract = (f & FLAG_N) != 0;
+            bool halfCarry = subtract ? ((f & FLAG_H) && (a & 0x0F) < 6) : ((a & 0x0F) > 9);
+            a = subtract ? a - correction : a + correction;
+            f = g_z80Flags.szp[a] | (subtract ? FLAG_N : 0) | (halfCarry ? FLAG_H : 0) | (carry ? FLAG_C : 0);
+        }
+        NEXT();
+
+        // Tutto il resto (prefissi, HALT, I/O, EI/DI, EXX) passa dall'handler
+        // della tabella con i registri riportati nei membri
+        OPCODE(0x76) OPCODE(0xCB) OPCODE(0xD3) OPCODE(0xD9) OPCODE(0xDB)
+        OPCODE(0xDD) OPCODE(0xED) OPCODE(0xF3) OPCODE(0xFB) OPCODE(0xFD)
+        {
+            A = a; F = f; BC = bc; DE = de; HL = hl; PC = pc; SP = sp;
+            m_totalCycles = instructionStart;
+
+            (this->*s_opcodeTable[opcode])();
+            cycles = instructionStart + m_cyclesLastInstruction;
+
+            a = A; f = F; bc = BC; de = DE; hl = HL; pc = PC; sp = SP;
+            if (m_halted) goto halted;
+        }
+        NEXT();
+        }
+#if !defined(Z80_COMPUTED_GOTO)
+    }
+#endif
+    goto done;
+
+halted:
+    // Come in Run(): in HALT nessun interrupt arriva dentro il budget
+    if (cycles < target) {
+        cycles += (target - cycles + 3) & ~uint64_t(3);
+        instructionStart = cycles - 4;
+    }
+
+done:
+    A = a; F = f; BC = bc; DE = de; HL = hl; PC = pc; SP = sp;
+    if (cycles != start) {
+        m_cyclesLastInstruction = static_cast<int>(cycles - instructionStart);
+    }
+    m_totalCycles = cycles;
+
+    return cycles - start;
+}
+
+#undef OPCODE
+#undef NEXT
+
+#endif
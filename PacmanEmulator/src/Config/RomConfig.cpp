@@ -14,4 +14,6 @@ const std::vector<ROMFile> graphicRoms = {
 
 const ROMFile graphicsPaletteFile = { "82s123.7f", 0x0000, 0x0020 };
 
-const ROMFile graphicsPaletteLookupFile = { "82s126.4a", 0x0000, 0x0100 };
\ No newline at end of file
+const ROMFile graphicsPaletteLookupFile = { "82s126.4a", 0x0000, 0x0100 };
+
+const ROMFile soundWaveformFile = { "82s126.1m", 0x0000, 0x0100 };
\ No newline at end of file
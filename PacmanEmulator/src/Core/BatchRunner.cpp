@@ -0,0 +1,167 @@
+#include "Core/BatchRunner.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+BatchRunner::BatchRunner(size_t instanceCount, unsigned int threadCount, uint32_t observations)
+    : m_instanceCount(instanceCount), m_observations(observations),
+    m_machines(std::make_unique<Machine[]>(instanceCount)),
+    m_generation(0), m_pending(0), m_framesToRun(0), m_shutdown(false)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Non ha senso avere piu' thread che istanze
+    threadCount = static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(threadCount, instanceCount)));
+
+    if (m_observations & OBS_FRAMEBUFFER) {
+        m_frameObservations.resize(instanceCount * SCREEN_SIZE, 0);
+    }
+    if (m_observations & OBS_RAM) {
+        m_ramObservations.resize(instanceCount * MemoryBus::RAM_SIZE, 0);
+    }
+
+    // Con le osservazioni indicizzate le macchine rendono a 1 byte per pixel;
+    // un'eventuale osservazione RGBA viene convertita solo alla copia
+    if (m_observations & OBS_FRAMEBUFFER_INDEXED) {
+        m_indexedFrameObservations.resize(instanceCount * SCREEN_SIZE, 0);
+        for (size_t i = 0; i < m_instanceCount; i++) {
+            m_machines[i].GetVideo().SetFrameBufferFormat(FrameBufferFormat::INDEXED);
+        }
+    }
+
+    // Tutte le istanze usano la RomImage della prima
+    for (size_t i = 1; i < m_instanceCount; i++) {
+        m_machines[i].ShareRomImage(m_machines[0].GetMemory().GetRomImage());
+    }
+
+    for (unsigned int w = 1; w < threadCount; w++) {
+        m_workers.emplace_back(&BatchRunner::WorkerLoop, this, w);
+    }
+
+    std::cout << "BatchRunner: " << m_instanceCount << " istanze su "
+        << threadCount << " thread" << std::endl;
+}
+
+BatchRunner::~BatchRunner()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_startCondition.notify_all();
+
+    for (auto &worker : m_workers) {
+        worker.join();
+    }
+}
+
+bool BatchRunner::SetJitEnabled(bool enabled)
+{
+    for (size_t i = 0; i < m_instanceCount; i++) {
+        if (!m_machines[i].GetCPU()->SetJitEnabled(enabled)) return false;
+    }
+    return true;
+}
+
+bool BatchRunner::LoadRomSet(const std::string &romDir)
+{
+    if (m_instanceCount == 0) return false;
+
+    // L'immagine e' condivisa: caricarla nella prima istanza la rende visibile a tutte
+    if (!m_machines[0].LoadRomSet(romDir)) return false;
+
+    // Anche gli atlanti di tile (~4 MB) e sprite (~8 MB) sono uno solo per tutto il batch
+    auto tileAtlas = m_machines[0].GetVideo().GetTileAtlas();
+    auto spriteAtlas = m_machines[0].GetVideo().GetSpriteAtlas();
+    for (size_t i = 1; i < m_instanceCount; i++) {
+        m_machines[i].GetVideo().ShareTileAtlas(tileAtlas);
+        m_machines[i].GetVideo().ShareSpriteAtlas(spriteAtlas);
+    }
+
+    return true;
+}
+
+void BatchRunner::Reset()
+{
+    for (size_t i = 0; i < m_instanceCount; i++) {
+        m_machines[i].Reset();
+    }
+}
+
+void BatchRunner::Step(int frames)
+{
+    if (m_instanceCount == 0 || frames <= 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_framesToRun = frames;
+        m_pending = static_cast<unsigned int>(m_workers.size());
+        m_generation++;
+    }
+    m_startCondition.notify_all();
+
+    // Il thread chiamante esegue la propria fetta
+    RunSlice(0, frames);
+
+    // Lockstep: attendi che tutti i worker abbiano finito
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this] { return m_pending == 0; });
+}
+
+void BatchRunner::WorkerLoop(unsigned int workerIndex)
+{
+    uint64_t seenGeneration = 0;
+
+    while (true) {
+        int frames;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [&] { return m_shutdown || m_generation != seenGeneration; });
+            if (m_shutdown) return;
+            seenGeneration = m_generation;
+            frames = m_framesToRun;
+        }
+
+        RunSlice(workerIndex, frames);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending--;
+        }
+        m_doneCondition.notify_one();
+    }
+}
+
+void BatchRunner::RunSlice(unsigned int workerIndex, int frames)
+{
+    // Partizione statica e contigua: ogni thread lavora su istanze adiacenti in memoria
+    const size_t threadCount = m_workers.size() + 1;
+    const size_t begin = m_instanceCount * workerIndex / threadCount;
+    const size_t end = m_instanceCount * (workerIndex + 1) / threadCount;
+
+    const bool wantRgba = (m_observations & OBS_FRAMEBUFFER) != 0;
+    const bool wantIndexed = (m_observations & OBS_FRAMEBUFFER_INDEXED) != 0;
+    const bool wantFrame = wantRgba || wantIndexed;
+    const bool wantRam = (m_observations & OBS_RAM) != 0;
+
+    for (size_t i = begin; i < end; i++) {
+        Machine &machine = m_machines[i];
+
+        // Il video serve solo se qualcuno osserva il framebuffer, e solo nell'ultimo frame
+        for (int f = 0; f < frames; f++) {
+            machine.RunFrame(wantFrame && f == frames - 1);
+        }
+
+        if (wantRgba) {
+            machine.GetVideo().ConvertFrameBufferToRGBA(&m_frameObservations[i * SCREEN_SIZE]);
+        }
+        if (wantIndexed) {
+            std::memcpy(&m_indexedFrameObservations[i * SCREEN_SIZE], machine.GetIndexedFrameBuffer(), SCREEN_SIZE);
+        }
+        if (wantRam) {
+            std::memcpy(&m_ramObservations[i * MemoryBus::RAM_SIZE], machine.GetMemory().GetRam(),
+                MemoryBus::RAM_SIZE);
+        }
+    }
+}
@@ -0,0 +1,160 @@
+#include "Core/FramePacer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+FramePacer::FramePacer(PacingMode mode, double frameRate)
+    : m_mode(mode), m_frameRate(frameRate),
+    m_period(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / frameRate))),
+    m_ring(nullptr), m_targetFill(0), m_samplesPerFrame(0),
+    m_started(false), m_averageIntervalSeconds(1.0 / frameRate), m_averageFill(0.0),
+    m_rateRatio(1.0), m_periodScale(1.0),
+    m_frames(0), m_meanMs(0.0), m_m2(0.0), m_minMs(0.0), m_maxMs(0.0), m_lateFrames(0),
+    m_rateRatioSum(0.0), m_periodScaleSum(0.0)
+{
+}
+
+void FramePacer::SetAudioSource(const AudioRingBuffer *ring, size_t targetFill, size_t samplesPerFrame)
+{
+    m_ring = ring;
+    m_targetFill = targetFill;
+    m_samplesPerFrame = samplesPerFrame;
+    m_averageFill = static_cast<double>(targetFill);
+}
+
+void FramePacer::Reset()
+{
+    m_started = false;
+}
+
+void FramePacer::EndFrame()
+{
+    if (!m_started) {
+        // Primo frame (o ripresa dopo una pausa): nessun intervallo da misurare
+        m_started = true;
+        m_lastFrameEnd = Clock::now();
+        m_nextDeadline = m_lastFrameEnd + m_period;
+        return;
+    }
+
+    switch (m_mode) {
+    case PacingMode::AUDIO:
+    case PacingMode::TIMER:
+        WaitForDeadline();
+        break;
+
+    case PacingMode::VSYNC:
+        // Present() ha gia' atteso il refresh. Se il driver ignora il vsync (o il display
+        // e' molto piu' veloce della macchina) i frame corrono: limita anche col timer.
+        if (m_averageIntervalSeconds * m_frameRate < 0.9) {
+            WaitForDeadline();
+        }
+        break;
+    }
+
+    Clock::time_point now = Clock::now();
+    double intervalSeconds = std::chrono::duration<double>(now - m_lastFrameEnd).count();
+    m_lastFrameEnd = now;
+
+    UpdateClockAdjust(intervalSeconds);
+    RecordFrame(intervalSeconds);
+}
+
+void FramePacer::WaitForDeadline()
+{
+    Clock::time_point now = Clock::now();
+
+    // Troppo in ritardo (debugger, finestra trascinata): riallinea invece di recuperare a raffica
+    if (now > m_nextDeadline + 2 * m_period) {
+        m_nextDeadline = now;
+    }
+
+    // Sleep fino a ~1.5 ms dalla scadenza (granularita' dello scheduler del SO), poi attesa attiva
+    const auto spinMargin = std::chrono::microseconds(1500);
+    if (m_nextDeadline - now > spinMargin) {
+        std::this_thread::sleep_for(m_nextDeadline - now - spinMargin);
+    }
+    while (Clock::now() < m_nextDeadline) {
+        std::this_thread::yield();
+    }
+
+    if (m_periodScale == 1.0) {
+        m_nextDeadline += m_period;
+    }
+    else {
+        m_nextDeadline += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(m_periodScale / m_frameRate));
+    }
+}
+
+void FramePacer::UpdateClockAdjust(double intervalSeconds)
+{
+    if (!m_ring || m_targetFill == 0) {
+        m_rateRatio = 1.0;
+        m_periodScale = 1.0;
+        return;
+    }
+
+    // Rapporto base: in VSYNC i frame seguono il refresh del display, quindi i campioni
+    // arrivano a refresh / frameRate della velocita' nominale (es. 60 / 60.606 Hz).
+    // In TIMER i frame seguono gia' il tempo reale.
+    double baseRatio = 1.0;
+    if (m_mode == PacingMode::VSYNC) {
+        m_averageIntervalSeconds += 0.02 * (intervalSeconds - m_averageIntervalSeconds);
+        baseRatio = 1.0 / (m_averageIntervalSeconds * m_frameRate);
+    }
+
+    // Correzione proporzionale sul riempimento medio: coda sopra l'obiettivo =
+    // il dispositivo consuma meno di quanto produciamo, sotto = di piu'. Il riferimento
+    // e' a meta' del frame appena accodato, dove la coda si trova in media.
+    m_averageFill += 0.1 * (static_cast<double>(m_ring->GetAvailable()) - m_averageFill);
+    double reference = static_cast<double>(m_targetFill) + m_samplesPerFrame / 2.0;
+    double error = (m_averageFill - reference) / static_cast<double>(m_targetFill);
+    double adjust = std::clamp(error * MAX_RATE_ADJUST, -MAX_RATE_ADJUST, MAX_RATE_ADJUST);
+
+    if (m_mode == PacingMode::AUDIO) {
+        // Audio master: frame piu' lunghi se la coda cresce, piu' corti se si svuota
+        m_rateRatio = 1.0;
+        m_periodScale = 1.0 + adjust;
+    }
+    else {
+        // Display o clock di sistema master: l'audio consuma piu' in fretta se la coda cresce
+        m_rateRatio = baseRatio * (1.0 + adjust);
+        m_periodScale = 1.0;
+    }
+}
+
+void FramePacer::RecordFrame(double intervalSeconds)
+{
+    double ms = intervalSeconds * 1000.0;
+
+    m_frames++;
+    double delta = ms - m_meanMs;
+    m_meanMs += delta / static_cast<double>(m_frames);
+    m_m2 += delta * (ms - m_meanMs);
+
+    m_minMs = (m_frames == 1) ? ms : std::min(m_minMs, ms);
+    m_maxMs = (m_frames == 1) ? ms : std::max(m_maxMs, ms);
+
+    if (intervalSeconds * m_frameRate > 1.5) {
+        m_lateFrames++;
+    }
+    m_rateRatioSum += m_rateRatio;
+    m_periodScaleSum += m_periodScale;
+}
+
+FramePacerStats FramePacer::GetStats() const
+{
+    FramePacerStats stats;
+    stats.frames = m_frames;
+    if (m_frames > 0) {
+        stats.meanFrameMs = m_meanMs;
+        stats.jitterMs = std::sqrt(m_m2 / static_cast<double>(m_frames));
+        stats.minFrameMs = m_minMs;
+        stats.maxFrameMs = m_maxMs;
+        stats.lateFrames = m_lateFrames;
+        stats.meanRateRatio = m_rateRatioSum / static_cast<double>(m_frames);
+        stats.meanPeriodScale = m_periodScaleSum / static_cast<double>(m_frames);
+    }
+    return stats;
+}
@@ -0,0 +1,266 @@
+#include "Core/Machine.h"
+#include "Config/RomConfig.h"
+#include <algorithm>
+#include <iostream>
+
+Machine::Machine()
+    : m_memory(), m_cpu(&m_memory), m_videoController(m_memory),
+    m_scanline(0), m_watchdogFrames(0), m_audioOutput(nullptr), m_audioCycle(0), m_frameAudioCount(0)
+{
+    m_memory.Initialize();
+    m_cpu.Reset();
+    ScheduleFirstFrame();
+}
+
+bool Machine::LoadRomSet(const std::string &romDir)
+{
+    // Caricamento cpu roms
+    for (const auto &rom : cpuRoms) {
+        size_t bytesRead = m_memory.LoadRom(romDir + "/" + rom.filename, MemoryBus::ROMType::CPU, rom.offset);
+
+        if (bytesRead != rom.expectedSize) {
+            std::cerr << "Failed: " << rom.filename << " (read " << bytesRead << " bytes, expected " << rom.expectedSize << ")\n";
+            return false;
+        }
+    }
+
+    // Caricamento graphics roms
+    for (const auto &rom : graphicRoms) {
+        size_t bytesRead = m_memory.LoadRom(romDir + "/" + rom.filename, MemoryBus::ROMType::GRAPHICS_TILES, rom.offset);
+
+        if (bytesRead != rom.expectedSize) {
+            std::cerr << "Failed: " << rom.filename << " (read " << bytesRead << " bytes, expected " << rom.expectedSize << ")\n";
+            return false;
+        }
+    }
+
+    // Caricamento palette rom
+    size_t bytesRead = m_memory.LoadRom(romDir + "/" + graphicsPaletteFile.filename, MemoryBus::ROMType::GRAPHICS_PALETTE, graphicsPaletteFile.offset);
+
+    if (bytesRead != graphicsPaletteFile.expectedSize) {
+        std::cerr << "Failed: " << graphicsPaletteFile.filename << " (read " << bytesRead << " bytes, expected " << graphicsPaletteFile.expectedSize << ")\n";
+        return false;
+    }
+
+    // Caricamento palette lookup rom
+    bytesRead = m_memory.LoadRom(romDir + "/" + graphicsPaletteLookupFile.filename, MemoryBus::ROMType::PALETTE_LOOKUP, graphicsPaletteLookupFile.offset);
+
+    if (bytesRead != graphicsPaletteLookupFile.expectedSize) {
+        std::cerr << "Failed: " << graphicsPaletteLookupFile.filename << " (read " << bytesRead << " bytes, expected " << graphicsPaletteLookupFile.expectedSize << ")\n";
+        return false;
+    }
+
+    // Caricamento forme d'onda del generatore sonoro
+    bytesRead = m_memory.LoadRom(romDir + "/" + soundWaveformFile.filename, MemoryBus::ROMType::SOUND_WAVEFORMS, soundWaveformFile.offset);
+
+    if (bytesRead != soundWaveformFile.expectedSize) {
+        std::cerr << "Failed: " << soundWaveformFile.filename << " (read " << bytesRead << " bytes, expected " << soundWaveformFile.expectedSize << ")\n";
+        return false;
+    }
+
+    // Nuovo codice in ROM: i blocchi decodificati non valgono piu'
+    m_cpu.InvalidateBlockCache();
+
+    // Tile e palette sono definitivi: pre-decodifica gli atlanti una volta sola
+    m_videoController.RebuildTileAtlas();
+    m_videoController.RebuildSpriteAtlas();
+
+    return true;
+}
+
+void Machine::ShareRomImage(std::shared_ptr<RomImage> image)
+{
+    m_memory.ShareRomImage(std::move(image));
+    m_cpu.InvalidateBlockCache();
+}
+
+void Machine::Reset()
+{
+    m_memory.Initialize();
+    m_cpu.Reset();
+    ScheduleFirstFrame();
+}
+
+void Machine::ScheduleFirstFrame()
+{
+    // Il reset della CPU riporta il contatore dei cicli a 0
+    uint64_t now = m_cpu.GetTotalCycles();
+
+    m_scheduler.Reset();
+    m_scheduler.Schedule(Scheduler::EventType::SCANLINE, now + CYCLES_PER_SCANLINE);
+    m_scheduler.Schedule(Scheduler::EventType::VBLANK, now + CYCLES_PER_FRAME);
+    m_scheduler.Schedule(Scheduler::EventType::WATCHDOG, now + CYCLES_PER_FRAME);
+    m_scanline = 0;
+    m_watchdogFrames = 0;
+
+    m_soundGenerator.Reset();
+    m_audioCycle = now;
+    m_frameAudioCount = 0;
+}
+
+void Machine::GenerateAudio(uint64_t upToCycle)
+{
+    // Solo campioni interi: il resto dei cicli passa alla chiamata successiva
+    size_t count = static_cast<size_t>((upToCycle - m_audioCycle) / NamcoWSG::CYCLES_PER_OUTPUT_SAMPLE);
+    m_audioCycle += count * NamcoWSG::CYCLES_PER_OUTPUT_SAMPLE;
+
+    while (count > 0) {
+        size_t block = count < AUDIO_SCRATCH_SAMPLES ? count : AUDIO_SCRATCH_SAMPLES;
+        m_soundGenerator.Render(m_memory.GetSoundRegisters(), m_memory.GetSoundWaveforms(),
+            m_memory.IsSoundEnabled(), m_audioScratch, block);
+
+        // La coda non blocca mai: se il consumatore e' indietro i campioni vengono scartati
+        if (m_audioOutput) {
+            m_audioOutput->Push(m_audioScratch, block);
+        }
+
+        size_t stored = std::min(block, AUDIO_FRAME_SAMPLES - m_frameAudioCount);
+        std::copy_n(m_audioScratch, stored, m_frameAudio + m_frameAudioCount);
+        m_frameAudioCount += stored;
+        count -= block;
+    }
+}
+
+void Machine::SaveState(std::vector<uint8_t> &buffer) const
+{
+    buffer.clear();
+    buffer.reserve(STATE_SIZE);
+    StateWriter writer(buffer);
+
+    writer.Write32(SAVE_STATE_MAGIC);
+    writer.Write32(SAVE_STATE_VERSION);
+
+    // Posizione nel frame
+    m_scheduler.SaveState(writer);
+    writer.Write32(static_cast<uint32_t>(m_scanline));
+    writer.Write32(static_cast<uint32_t>(m_watchdogFrames));
+
+    m_cpu.SaveState(writer);
+    m_memory.SaveState(writer);
+
+    m_soundGenerator.SaveState(writer);
+    writer.Write64(m_audioCycle);
+}
+
+bool Machine::LoadState(const uint8_t *data, size_t size)
+{
+    // Layout fisso: la dimensione esatta e l'header bastano a validare il blob
+    if (!data || size != STATE_SIZE) {
+        std::cerr << "LoadState: dimensione non valida (" << size << " bytes, expected " << STATE_SIZE << ")\n";
+        return false;
+    }
+
+    StateReader reader(data, size);
+    uint32_t magic = reader.Read32();
+    uint32_t version = reader.Read32();
+
+    if (magic != SAVE_STATE_MAGIC || version != SAVE_STATE_VERSION) {
+        std::cerr << "LoadState: formato o versione non supportati (versione " << version << ")\n";
+        return false;
+    }
+
+    m_scheduler.LoadState(reader);
+    m_scanline = static_cast<int>(reader.Read32());
+    m_watchdogFrames = static_cast<int>(reader.Read32());
+
+    m_cpu.LoadState(reader);
+    m_memory.LoadState(reader);
+
+    m_soundGenerator.LoadState(reader);
+    m_audioCycle = reader.Read64();
+
+    return !reader.Failed();
+}
+
+uint32_t Machine::GetRamHash() const
+{
+    const uint8_t *ram = m_memory.GetRam();
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < MemoryBus::RAM_SIZE; i++) {
+        hash = (hash ^ ram[i]) * 16777619u;
+    }
+    return hash;
+}
+
+uint64_t Machine::GetRomHash() const
+{
+    const auto &rom = m_memory.GetRomImage()->rom;
+    uint64_t hash = 14695981039346656037ull;
+    for (uint8_t byte : rom) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    }
+    return hash;
+}
+
+void Machine::RunFrame(bool renderVideo)
+{
+    bool frameDone = false;
+    m_frameAudioCount = 0;
+
+    while (!frameDone) {
+        // La CPU gira in un loop interno fino alla prossima scadenza
+        uint64_t now = m_cpu.GetTotalCycles();
+        uint64_t nextDeadline = m_scheduler.GetNextDeadline();
+        if (now < nextDeadline) {
+            m_cpu.Run(nextDeadline - now);
+        }
+
+        // Servi tutti gli eventi scaduti. Le ripianificazioni partono dalla
+        // scadenza originale, cosi' gli sforamenti dell'ultima istruzione non si accumulano.
+        uint64_t deadline;
+        Scheduler::EventType event;
+        while ((event = m_scheduler.PopDueEvent(m_cpu.GetTotalCycles(), deadline)) != Scheduler::EventType::NONE) {
+            switch (event) {
+            case Scheduler::EventType::SCANLINE:
+                // Audio fino a fine riga: i registri scritti durante la riga valgono da qui
+                GenerateAudio(deadline);
+
+                // Renderizza lo sfondo (Tilemap) per questa riga
+                if (renderVideo) {
+                    m_videoController.RenderScanline(m_scanline);
+                }
+                // Dopo l'ultima riga la prossima scanline la pianifica il VBLANK
+                if (++m_scanline < TOTAL_SCANLINES) {
+                    m_scheduler.Schedule(Scheduler::EventType::SCANLINE, deadline + CYCLES_PER_SCANLINE);
+                }
+                break;
+
+            case Scheduler::EventType::VBLANK:
+                // --- RENDERING SPRITE ---
+                // Una volta disegnato tutto lo sfondo, disegniamo sopra gli sprite (Pac-Man, fantasmi).
+                if (renderVideo) {
+                    m_videoController.RenderSprites();
+                }
+
+                // --- INTERRUPT VBLANK ---
+                // Scatta una volta per frame (60Hz).
+                // Controlliamo se l'hardware video lo permette (registro 0x5000)
+                if (m_memory.IsIrqEnabled()) {
+                    m_cpu.Interrupt();
+                }
+
+                m_scanline = 0;
+                m_scheduler.Schedule(Scheduler::EventType::SCANLINE, deadline + CYCLES_PER_SCANLINE);
+                m_scheduler.Schedule(Scheduler::EventType::VBLANK, deadline + CYCLES_PER_FRAME);
+                frameDone = true;
+                break;
+
+            case Scheduler::EventType::WATCHDOG:
+                // Il gioco deve scrivere a 0x50C0 almeno ogni WATCHDOG_FRAMES frame
+                if (m_memory.ConsumeWatchdogKick()) {
+                    m_watchdogFrames = 0;
+                }
+                else if (++m_watchdogFrames >= WATCHDOG_FRAMES) {
+                    std::cerr << "Machine: watchdog scaduto, reset" << std::endl;
+                    Reset();
+                    return;
+                }
+                m_scheduler.Schedule(Scheduler::EventType::WATCHDOG, deadline + CYCLES_PER_FRAME);
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+}
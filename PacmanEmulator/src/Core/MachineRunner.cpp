@@ -0,0 +1,102 @@
+#include "Core/MachineRunner.h"
+#include <chrono>
+#include <iostream>
+
+MachineRunner::MachineRunner(Machine &machine)
+    : m_machine(machine), m_moviePlayer(nullptr), m_desyncFrames(0)
+{
+}
+
+bool MachineRunner::StartRecording(const std::string &path)
+{
+    // Il movie parte dal reset: registra solo da macchina appena inizializzata
+    return m_movieRecorder.Open(path, m_machine.GetRomHash());
+}
+
+bool MachineRunner::StartReplay(const std::string &path)
+{
+    auto player = std::make_unique<MoviePlayer>();
+    if (!player->Open(path)) {
+        return false;
+    }
+
+    if (player->GetRomHash() != m_machine.GetRomHash()) {
+        std::cerr << "Errore: il movie e' stato registrato con una ROM diversa" << std::endl;
+        return false;
+    }
+
+    m_moviePlayer = std::move(player);
+    m_desyncFrames = 0;
+    return true;
+}
+
+bool MachineRunner::EmulateFrame(const InputState &liveInputs)
+{
+    // In replay gli input vengono dal movie, non dal frontend
+    InputState inputs = liveInputs;
+    MovieFrame recorded;
+    if (m_moviePlayer) {
+        if (!m_moviePlayer->NextFrame(recorded)) {
+            return false;
+        }
+        inputs = recorded.inputs;
+    }
+
+    m_machine.SetInputs(inputs);
+    m_machine.RunFrame();
+
+    uint32_t ramHash = m_machine.GetRamHash();
+
+    if (m_moviePlayer && ramHash != recorded.ramHash) {
+        if (m_desyncFrames == 0) {
+            std::cerr << "MachineRunner: desync al frame " << m_moviePlayer->GetPosition() - 1
+                << " (hash RAM " << std::hex << ramHash << ", atteso " << recorded.ramHash
+                << std::dec << ")" << std::endl;
+        }
+        m_desyncFrames++;
+    }
+
+    if (m_movieRecorder.IsOpen()) {
+        m_movieRecorder.RecordFrame({ inputs, ramHash });
+    }
+    return true;
+}
+
+HeadlessStats MachineRunner::RunHeadless(const HeadlessOptions &options)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::cout << "MachineRunner: Avvio loop headless..." << std::endl;
+
+    HeadlessStats stats;
+    const Clock::time_point start = Clock::now();
+
+    // Nessun limite di framerate: i frame vengono eseguiti il piu' velocemente possibile
+    while (options.maxFrames == 0 || stats.frames < options.maxFrames) {
+        // Senza tastiera gli input live sono "nessun tasto premuto"
+        if (!EmulateFrame(InputState())) break;
+        stats.frames++;
+
+        if (options.maxSeconds > 0.0) {
+            std::chrono::duration<double> elapsed = Clock::now() - start;
+            if (elapsed.count() >= options.maxSeconds) break;
+        }
+    }
+
+    stats.elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    stats.desyncFrames = m_desyncFrames;
+    if (stats.elapsedSeconds > 0.0) {
+        stats.framesPerSecond = stats.frames / stats.elapsedSeconds;
+        stats.speedFactor = stats.framesPerSecond / Machine::FRAME_RATE;
+    }
+
+    std::cout << "MachineRunner: Loop headless terminato - " << stats.frames << " frame in "
+        << stats.elapsedSeconds << " s (" << stats.framesPerSecond << " fps, "
+        << stats.speedFactor << "x tempo reale)" << std::endl;
+    if (m_moviePlayer) {
+        std::cout << "MachineRunner: Replay " << (m_desyncFrames == 0 ? "verificato" : "NON verificato")
+            << " - " << m_moviePlayer->GetPosition() << "/" << m_moviePlayer->GetFrameCount()
+            << " frame, " << m_desyncFrames << " desync" << std::endl;
+    }
+    return stats;
+}
@@ -1,10 +1,16 @@
 #include "Core/PacmanEmulator.h"
+#include "Audio/SFMLAudioStream.h"
 #include "Memory/MemoryBus.h"
+#include "Video/SFMLBackend.h"
+#include <chrono>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 PacmanEmulator::PacmanEmulator()
-    : m_memory(nullptr), m_cpu(nullptr),
-    m_videoController(nullptr), m_window(nullptr),
+    : m_machine(nullptr), m_rewindBuffer(nullptr), m_runner(nullptr),
+    m_audioRing(nullptr), m_audioStream(nullptr),
+    m_pacingMode(PacingMode::AUDIO), m_framePacer(nullptr),
     m_renderBackend(nullptr),
     m_isRunning(false), m_isPaused(false)
 {
@@ -13,6 +19,10 @@ PacmanEmulator::PacmanEmulator()
 
 PacmanEmulator::~PacmanEmulator()
 {
+    // Ferma il thread audio prima di distruggere la coda che legge
+    if (m_audioStream) {
+        m_audioStream->stop();
+    }
     std::cout << "PacmanEmulator: Distruttore chiamato" << std::endl;
 }
 
@@ -20,32 +30,29 @@ bool PacmanEmulator::Initialize()
 {
     std::cout << "PacmanEmulator: Inizializzazione..." << std::endl;
 
-    // Crea finestra SFML
+    // Inizializza la macchina (MemoryBus, CPU Z80 e video controller)
+    m_machine = std::make_unique<Machine>();
+    m_runner = std::make_unique<MachineRunner>(*m_machine);
+    m_rewindBuffer = std::make_unique<RewindBuffer>(REWIND_SECONDS * static_cast<size_t>(TARGET_FPS));
+
+    m_audioRing = std::make_unique<AudioRingBuffer>(AUDIO_RING_SAMPLES);
+    m_audioStream = std::make_unique<SFMLAudioStream>(*m_audioRing, NamcoWSG::OUTPUT_SAMPLE_RATE);
+    m_machine->SetAudioOutput(m_audioRing.get());
+
+    // Inizializza il render backend: un'unica finestra, eventi, tastiera e vsync passano da li'
     // Pac-Man originale: 224x288 pixel, scala x3 per visibilit
-    m_window = std::make_unique<sf::RenderWindow>(
-        sf::VideoMode({ 224 * 3, 288 * 3 }),
-        "Pac-Man Emulator"
-    );
-    m_window->setFramerateLimit(60);
-
-    // Inizializza MemoryBus
-    m_memory = std::make_unique<MemoryBus>();
-    m_memory->Initialize();
-
-    // Inizializza CPU Z80
-    m_cpu = std::make_unique<Z80>(m_memory.get());
-    m_cpu->Reset();
-    
-    // Inizializza il video controller
-    m_videoController = std::make_unique<VideoController>(*m_memory);
-
-    // Inizializza il render backend
     m_renderBackend = std::make_unique<SFMLBackend>();
     if (!m_renderBackend->Initialize(SCREEN_WIDTH, SCREEN_HEIGHT, 3, "Pac-Man Emulator")) {
         std::cerr << "Errore: Impossibile inizializzare il renderer" << std::endl;
         return false;
     }
 
+    // Il vsync serve solo quando e' lui a scandire i frame
+    m_renderBackend->SetVSync(m_pacingMode == PacingMode::VSYNC);
+    m_framePacer = std::make_unique<FramePacer>(m_pacingMode, Machine::FRAME_RATE);
+    m_framePacer->SetAudioSource(m_audioRing.get(), AUDIO_TARGET_FILL,
+        Machine::CYCLES_PER_FRAME / NamcoWSG::CYCLES_PER_OUTPUT_SAMPLE);
+
     std::cout << "PacmanEmulator: Inizializzazione completata" << std::endl;
     m_isRunning = true;
     return true;
@@ -56,39 +63,7 @@ bool PacmanEmulator::LoadRomSet(const std::string &romDir)
     // Caricamento ROM
     std::cout << "PacmanEmulator: Caricamento Rom da " << romDir << std::endl;
 
-    // Caricamento cpu roms
-    for (const auto &rom : cpuRoms) {
-        size_t bytesRead = m_memory->LoadRom(romDir + "/" + rom.filename, MemoryBus::ROMType::CPU, rom.offset);
-
-        if (bytesRead!= rom.expectedSize) {
-            std::cerr << "Failed: " << rom.filename << " (read " << bytesRead << " bytes, expected " << rom.expectedSize << ")\n";
-            return false;
-        }
-    }
-
-    // Caricamento graphics roms
-    for (const auto &rom : graphicRoms) {
-        size_t bytesRead = m_memory->LoadRom(romDir + "/" + rom.filename, MemoryBus::ROMType::GRAPHICS_TILES, rom.offset);
-
-        if (bytesRead != rom.expectedSize) {
-            std::cerr << "Failed: " << rom.filename << " (read " << bytesRead << " bytes, expected " << rom.expectedSize << ")\n";
-            return false;
-        }
-    }
-
-    // Caricamento palette rom
-    size_t bytesRead = m_memory->LoadRom(romDir + "/" + graphicsPaletteFile.filename, MemoryBus::ROMType::GRAPHICS_PALETTE, graphicsPaletteFile.offset);
-
-    if (bytesRead != graphicsPaletteFile.expectedSize) {
-        std::cerr << "Failed: " << graphicsPaletteFile.filename << " (read " << bytesRead << " bytes, expected " << graphicsPaletteFile.expectedSize << ")\n";
-        return false;
-    }
-
-    // Caricamento palette lookup rom
-    bytesRead = m_memory->LoadRom(romDir + "/" + graphicsPaletteLookupFile.filename, MemoryBus::ROMType::PALETTE_LOOKUP, graphicsPaletteLookupFile.offset);
-
-    if (bytesRead != graphicsPaletteLookupFile.expectedSize) {
-        std::cerr << "Failed: " << graphicsPaletteLookupFile.filename << " (read " << bytesRead << " bytes, expected " << graphicsPaletteLookupFile.expectedSize << ")\n";
+    if (!m_machine->LoadRomSet(romDir)) {
         return false;
     }
 
@@ -100,94 +75,126 @@ void PacmanEmulator::Run()
 {
     std::cout << "PacmanEmulator: Avvio game loop..." << std::endl;
 
+    // Parte con la coda audio al livello obiettivo: il controllo del rate non deve recuperare da zero
+    std::vector<int16_t> silence(AUDIO_TARGET_FILL, 0);
+    m_audioRing->Push(silence.data(), silence.size());
+    m_audioStream->play();
+
     while (m_isRunning) {
         // Gestione Input (fondamentale per chiudere o mettere in pausa)
         ProcessInput();
 
         if (m_isPaused) {
-            sf::sleep(sf::milliseconds(10)); // Risparmia CPU se in pausa
+            std::this_thread::sleep_for(std::chrono::milliseconds(10)); // Risparmia CPU se in pausa
+            m_framePacer->Reset();           // La pausa non conta come frame in ritardo
             continue;
         }
 
-        // --- CICLO DI SCANLINE (Rendering e CPU) ---
-        // Deve arrivare fino a TOTAL_SCANLINES (288) per disegnare tutto lo schermo,
-        // incluse le vite e i crediti in basso.
-        for (int scanline = 0; scanline < TOTAL_SCANLINES; scanline++) {
-
-            int cycles_this_scanline = 0;
-
-            // Esegui la CPU per i cicli necessari a disegnare una linea (~224 cicli)
-            while (cycles_this_scanline < CYCLES_PER_SCANLINE) {
-                // La tua funzione Step() gestisce gi internamente lo stato HALT
-                // ritornando 4 cicli senza fare nulla, quindi possiamo chiamarla direttamente.
-                cycles_this_scanline += m_cpu->Step();
-            }
-
-            // Renderizza lo sfondo (Tilemap) per questa riga
-            m_videoController->RenderScanline(scanline);
-
-            // NOTA: Abbiamo RIMOSSO il check "if (total_cycles >= FRAME)" con il break.
-            // Questo garantisce che il loop arrivi fino alla riga 288.
+        // Rewind: lo stato non contiene il framebuffer, quindi si torna indietro
+        // di due frame e se ne riesegue uno per ridisegnare lo schermo.
+        // Non disponibile durante registrazione o replay di un movie.
+        if (!m_runner->IsMovieActive() && m_renderBackend->IsKeyPressed(KeyCode::BACKSPACE) &&
+            m_rewindBuffer->GetFrameCount() > 2) {
+            m_rewindBuffer->Rewind(*m_machine, 2);
         }
 
-        // --- RENDERING SPRITE ---
-        // Una volta disegnato tutto lo sfondo, disegniamo sopra gli sprite (Pac-Man, fantasmi).
-        // (Assicurati di aver aggiunto questo metodo in VideoController come discusso prima)
-        //m_videoController->RenderSprites();
-
-        // --- INTERRUPT VBLANK ---
-        // Scatta una volta per frame (60Hz).
-        // Controlliamo se l'hardware video lo permette (registro 0x5000)
-        if (m_memory->IsIrqEnabled()) {
-            m_cpu->Interrupt();
+        if (!m_runner->EmulateFrame(ReadKeyboardInputs())) {
+            m_isRunning = false;
+            break;
         }
+        m_rewindBuffer->Push(*m_machine);
 
         // --- AGGIORNAMENTO SCHERMO ---
         m_renderBackend->DisplayFrameBuffer(
-            m_videoController->GetFrameBuffer(),
+            m_machine->GetFrameBuffer(),
             SCREEN_WIDTH,
             SCREEN_HEIGHT
         );
         m_renderBackend->Present();
+
+        // --- PACING ---
+        // Attende il clock scelto e aggiorna il ricampionamento dell'audio
+        m_framePacer->EndFrame();
+        m_audioStream->SetRateRatio(m_framePacer->GetRateRatio());
     }
 
-    std::cout << "PacmanEmulator: Game loop terminato" << std::endl;
+    FramePacerStats pacing = m_framePacer->GetStats();
+    std::cout << "PacmanEmulator: Game loop terminato - " << pacing.frames << " frame, durata media "
+        << pacing.meanFrameMs << " ms (jitter " << pacing.jitterMs << " ms, min " << pacing.minFrameMs
+        << ", max " << pacing.maxFrameMs << ", " << pacing.lateFrames << " in ritardo), rapporto audio medio "
+        << pacing.meanRateRatio << ", underrun " << m_audioStream->GetUnderrunSamples()
+        << " campioni, scartati " << m_audioRing->GetDroppedSamples() << " campioni" << std::endl;
 }
 
 void PacmanEmulator::Reset()
 {
+    // Come il rewind, il reset romperebbe un movie in registrazione o in replay
+    if (m_runner->IsMovieActive()) {
+        std::cout << "PacmanEmulator: Reset non disponibile durante un movie" << std::endl;
+        return;
+    }
+
     std::cout << "PacmanEmulator: Reset" << std::endl;
 
-    // TODO: Reset CPU
-    // m_cpu->Reset();
+    m_machine->Reset();
+
+    // Gli stati salvati prima del reset non sono piu' raggiungibili con il rewind
+    m_rewindBuffer->Clear();
+    m_framePacer->Reset();
 
     m_isPaused = false;
 }
 
+bool PacmanEmulator::StartRecording(const std::string &path)
+{
+    return m_runner->StartRecording(path);
+}
+
+bool PacmanEmulator::StartReplay(const std::string &path)
+{
+    return m_runner->StartReplay(path);
+}
+
+InputState PacmanEmulator::ReadKeyboardInputs() const
+{
+    // Frecce = joystick, C = moneta, 1/2 = start. I bit sono attivi bassi.
+    InputState inputs;
+
+    if (m_renderBackend->IsKeyPressed(KeyCode::UP)) inputs.in0 &= ~IN0_UP;
+    if (m_renderBackend->IsKeyPressed(KeyCode::LEFT)) inputs.in0 &= ~IN0_LEFT;
+    if (m_renderBackend->IsKeyPressed(KeyCode::RIGHT)) inputs.in0 &= ~IN0_RIGHT;
+    if (m_renderBackend->IsKeyPressed(KeyCode::DOWN)) inputs.in0 &= ~IN0_DOWN;
+    if (m_renderBackend->IsKeyPressed(KeyCode::C)) inputs.in0 &= ~IN0_COIN1;
+    if (m_renderBackend->IsKeyPressed(KeyCode::NUM1)) inputs.in1 &= ~IN1_START1;
+    if (m_renderBackend->IsKeyPressed(KeyCode::NUM2)) inputs.in1 &= ~IN1_START2;
+
+    return inputs;
+}
+
 void PacmanEmulator::ProcessInput()
 {
-    while (std::optional<sf::Event> event = m_window->pollEvent())
+    BackendEvent event;
+    while (m_renderBackend->PollEvent(event))
     {
-        if (event->is<sf::Event::Closed>())
+        if (event.type == BackendEvent::Type::CLOSED)
         {
             m_isRunning = false;
         }
 
-        // TODO: Gestione input tastiera per i controlli di Pac-Man
-        if (const auto *keyPressed = event->getIf<sf::Event::KeyPressed>())
+        if (event.type == BackendEvent::Type::KEY_PRESSED)
         {
-            switch (keyPressed->code)
+            switch (event.key)
             {
-            case sf::Keyboard::Key::Escape:
+            case KeyCode::ESC:
                 m_isRunning = false;
                 break;
 
-            case sf::Keyboard::Key::P:
+            case KeyCode::P:
                 m_isPaused = !m_isPaused;
                 std::cout << "Pausa: " << (m_isPaused ? "ON" : "OFF") << std::endl;
                 break;
 
-            case sf::Keyboard::Key::R:
+            case KeyCode::R:
                 Reset();
                 break;
 
@@ -197,41 +204,3 @@ void PacmanEmulator::ProcessInput()
         }
     }
 }
-
-void PacmanEmulator::Update(float deltaTime)
-{
-    // TODO: Esegui CPU cycles
-    // int cyclesThisFrame = 0;
-    // while (cyclesThisFrame < CPU_CYCLES_PER_FRAME)
-    // {
-    //     int cycles = m_cpu->Step();
-    //     cyclesThisFrame += cycles;
-    // }
-
-    // TODO: Aggiorna video
-    // m_video->Update();
-}
-
-void PacmanEmulator::Render()
-{
-    m_window->clear(sf::Color::Black);
-
-    // TODO: Renderizza il gioco
-    // m_video->Render(*m_window);
-
-    // Per ora, disegna qualcosa di placeholder
-    sf::CircleShape testCircle(30.f);
-    testCircle.setFillColor(sf::Color::Yellow);
-    testCircle.setPosition({ 300.f, 400.f });
-    m_window->draw(testCircle);
-
-    DrawDebugInfo();
-
-    m_window->display();
-}
-
-void PacmanEmulator::DrawDebugInfo()
-{
-    // TODO: Aggiungi testo debug quando implementeremo la CPU
-    // Mostra: FPS, CPU cycles, stato registri, ecc.
-}
\ No newline at end of file
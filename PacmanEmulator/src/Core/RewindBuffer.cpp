@@ -0,0 +1,179 @@
+#include "Core/RewindBuffer.h"
+#include <algorithm>
+#include <iostream>
+
+// Formato compresso: sequenza di blocchi [salto u16][lunghezza u16][lunghezza byte XOR].
+// Il salto conta i byte uguali al riferimento (XOR nullo) prima del blocco.
+// Gli stati sono piu' piccoli di 64 KB, quindi 16 bit bastano.
+namespace {
+    // Sequenze di zeri piu' corte di cosi' restano dentro il blocco letterale:
+    // aprire un nuovo blocco costerebbe di piu'
+    constexpr size_t MIN_ZERO_RUN = 4;
+
+    void PutU16(std::vector<uint8_t> &out, size_t value)
+    {
+        out.push_back(static_cast<uint8_t>(value & 0xFF));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    // Riferimento vuoto = stato nullo
+    uint8_t ReferenceAt(const std::vector<uint8_t> &reference, size_t pos)
+    {
+        return reference.empty() ? 0 : reference[pos];
+    }
+}
+
+RewindBuffer::RewindBuffer(size_t capacityFrames, size_t keyframeInterval)
+    : m_keyframeInterval(std::max<size_t>(1, keyframeInterval)),
+    m_firstSegment(0), m_segmentCount(0), m_frameCount(0)
+{
+    // Un segmento in piu': quello corrente puo' essere parzialmente pieno
+    size_t segments = (capacityFrames + m_keyframeInterval - 1) / m_keyframeInterval + 1;
+    m_segments.resize(segments);
+}
+
+void RewindBuffer::Push(const Machine &machine)
+{
+    machine.SaveState(m_state);
+
+    Segment *segment = m_segmentCount > 0 ? &GetSegment(m_segmentCount - 1) : nullptr;
+
+    // Segmento corrente pieno (o nessun segmento): inizia un nuovo keyframe
+    if (!segment || segment->deltaCount + 1 >= m_keyframeInterval) {
+        if (m_segmentCount == m_segments.size()) {
+            // Ring pieno: scarta il segmento piu' vecchio
+            m_frameCount -= 1 + m_segments[m_firstSegment].deltaCount;
+            m_firstSegment = (m_firstSegment + 1) % m_segments.size();
+            m_segmentCount--;
+        }
+
+        m_segmentCount++;
+        segment = &GetSegment(m_segmentCount - 1);
+        segment->deltaCount = 0;
+        Encode(m_state, {}, m_encoded);
+        segment->keyframe.assign(m_encoded.begin(), m_encoded.end());
+    }
+    else {
+        if (segment->deltas.size() <= segment->deltaCount) {
+            segment->deltas.emplace_back();
+        }
+        Encode(m_state, m_lastState, m_encoded);
+        // assign: il buffer del delta cresce solo quanto serve e viene riusato al giro successivo
+        segment->deltas[segment->deltaCount].assign(m_encoded.begin(), m_encoded.end());
+        segment->deltaCount++;
+    }
+
+    m_lastState.swap(m_state);
+    m_frameCount++;
+}
+
+bool RewindBuffer::Rewind(Machine &machine, size_t frames)
+{
+    if (frames >= m_frameCount) {
+        std::cerr << "RewindBuffer: storico insufficiente (" << m_frameCount << " frame)" << std::endl;
+        return false;
+    }
+
+    // Scarta gli stati piu' recenti di quello richiesto
+    size_t toDrop = frames;
+    while (toDrop > 0) {
+        Segment &last = GetSegment(m_segmentCount - 1);
+        size_t states = 1 + last.deltaCount;
+        if (toDrop >= states) {
+            m_segmentCount--;
+            toDrop -= states;
+        }
+        else {
+            last.deltaCount -= toDrop;
+            toDrop = 0;
+        }
+    }
+    m_frameCount -= frames;
+
+    // Ricostruisci lo stato: keyframe seguito dai delta del segmento
+    Segment &segment = GetSegment(m_segmentCount - 1);
+    m_lastState.assign(Machine::STATE_SIZE, 0);
+    if (!Apply(segment.keyframe, m_lastState)) return false;
+
+    for (size_t i = 0; i < segment.deltaCount; i++) {
+        if (!Apply(segment.deltas[i], m_lastState)) return false;
+    }
+
+    return machine.LoadState(m_lastState.data(), m_lastState.size());
+}
+
+void RewindBuffer::Clear()
+{
+    m_firstSegment = 0;
+    m_segmentCount = 0;
+    m_frameCount = 0;
+}
+
+size_t RewindBuffer::GetMemoryUsage() const
+{
+    size_t bytes = 0;
+    for (const Segment &segment : m_segments) {
+        bytes += segment.keyframe.capacity();
+        for (const auto &delta : segment.deltas) {
+            bytes += delta.capacity();
+        }
+    }
+    return bytes;
+}
+
+void RewindBuffer::Encode(const std::vector<uint8_t> &state, const std::vector<uint8_t> &reference, std::vector<uint8_t> &out)
+{
+    out.clear();
+    const size_t size = state.size();
+    size_t pos = 0;
+
+    while (pos < size) {
+        // Byte invariati
+        size_t skip = 0;
+        while (pos + skip < size && state[pos + skip] == ReferenceAt(reference, pos + skip)) skip++;
+        if (pos + skip == size) break;
+        pos += skip;
+
+        // Blocco letterale fino a una sequenza di zeri abbastanza lunga
+        size_t length = 0;
+        size_t zeros = 0;
+        while (pos + length < size) {
+            zeros = (state[pos + length] == ReferenceAt(reference, pos + length)) ? zeros + 1 : 0;
+            length++;
+            if (zeros >= MIN_ZERO_RUN) break;
+        }
+        // I byte invariati in coda non fanno parte del blocco
+        length -= zeros;
+
+        PutU16(out, skip);
+        PutU16(out, length);
+        for (size_t i = 0; i < length; i++) {
+            out.push_back(state[pos + i] ^ ReferenceAt(reference, pos + i));
+        }
+        pos += length;
+    }
+}
+
+bool RewindBuffer::Apply(const std::vector<uint8_t> &encoded, std::vector<uint8_t> &state)
+{
+    size_t pos = 0;
+    size_t in = 0;
+
+    while (in + 4 <= encoded.size()) {
+        size_t skip = encoded[in] | (encoded[in + 1] << 8);
+        size_t length = encoded[in + 2] | (encoded[in + 3] << 8);
+        in += 4;
+        pos += skip;
+
+        if (pos + length > state.size() || in + length > encoded.size()) {
+            std::cerr << "RewindBuffer: stato compresso corrotto" << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < length; i++) {
+            state[pos + i] ^= encoded[in + i];
+        }
+        pos += length;
+        in += length;
+    }
+    return true;
+}
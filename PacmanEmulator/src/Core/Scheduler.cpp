@@ -0,0 +1,63 @@
+#include "Core/Scheduler.h"
+
+Scheduler::Scheduler()
+{
+    Reset();
+}
+
+void Scheduler::Reset()
+{
+    m_deadlines.fill(NEVER);
+    m_nextDeadline = NEVER;
+}
+
+void Scheduler::Schedule(EventType type, uint64_t cycle)
+{
+    m_deadlines[static_cast<int>(type)] = cycle;
+    UpdateNextDeadline();
+}
+
+void Scheduler::Cancel(EventType type)
+{
+    m_deadlines[static_cast<int>(type)] = NEVER;
+    UpdateNextDeadline();
+}
+
+Scheduler::EventType Scheduler::PopDueEvent(uint64_t now, uint64_t &deadline)
+{
+    if (m_nextDeadline > now) return EventType::NONE;
+
+    // Pochi eventi: una scansione lineare basta
+    int due = 0;
+    for (int i = 1; i < EVENT_COUNT; i++) {
+        if (m_deadlines[i] < m_deadlines[due]) due = i;
+    }
+
+    deadline = m_deadlines[due];
+    m_deadlines[due] = NEVER;
+    UpdateNextDeadline();
+    return static_cast<EventType>(due);
+}
+
+void Scheduler::UpdateNextDeadline()
+{
+    m_nextDeadline = NEVER;
+    for (uint64_t deadline : m_deadlines) {
+        if (deadline < m_nextDeadline) m_nextDeadline = deadline;
+    }
+}
+
+void Scheduler::SaveState(StateWriter &writer) const
+{
+    for (uint64_t deadline : m_deadlines) {
+        writer.Write64(deadline);
+    }
+}
+
+void Scheduler::LoadState(StateReader &reader)
+{
+    for (uint64_t &deadline : m_deadlines) {
+        deadline = reader.Read64();
+    }
+    UpdateNextDeadline();
+}
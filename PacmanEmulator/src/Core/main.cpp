@@ -1,15 +1,65 @@
 ﻿#include "Core/PacmanEmulator.h"
+#include "CPU/Z80Jit.h"
 #include <iostream>
+#include <string>
 
-int main()
+int main(int argc, char *argv[])
 {
     try {
         std::cout << "=== PAC-MAN EMULATOR ===" << std::endl;
-        
+
+        // Opzioni da riga di comando (le esecuzioni headless e batch sono in PacmanHeadless):
+        //   --record FILE   registra gli input di ogni frame in un movie
+        //   --replay FILE   rigioca un movie verificando l'hash della RAM (esce con 1 se desync)
+        //   --pacing MODE   clock del game loop: audio (default), vsync, timer
+        //   --jit           CPU con JIT x86-64 (solo host x86-64, altrimenti interprete)
+        //   --jit-check     JIT con verifica di ogni blocco contro l'interprete
+        std::string recordPath;
+        std::string replayPath;
+        PacingMode pacingMode = PacingMode::AUDIO;
+        bool jit = false;
+        bool jitCheck = false;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--headless" || arg == "--batch") {
+                std::cerr << "Le esecuzioni headless e batch sono nel runner PacmanHeadless "
+                    << "(stesse opzioni, piu' --roms, --dump e --indexed)" << std::endl;
+                return -1;
+            }
+            else if (arg == "--record" && i + 1 < argc) {
+                recordPath = argv[++i];
+            }
+            else if (arg == "--replay" && i + 1 < argc) {
+                replayPath = argv[++i];
+            }
+            else if (arg == "--jit") {
+                jit = true;
+            }
+            else if (arg == "--jit-check") {
+                jit = true;
+                jitCheck = true;
+            }
+            else if (arg == "--pacing" && i + 1 < argc) {
+                std::string mode = argv[++i];
+                if (mode == "audio") pacingMode = PacingMode::AUDIO;
+                else if (mode == "vsync") pacingMode = PacingMode::VSYNC;
+                else if (mode == "timer") pacingMode = PacingMode::TIMER;
+                else {
+                    std::cerr << "Modalita' di pacing sconosciuta: " << mode << std::endl;
+                    return -1;
+                }
+            }
+            else {
+                std::cerr << "Argomento sconosciuto: " << arg << std::endl;
+                return -1;
+            }
+        }
+
         // 1. Crea l'emulatore
         PacmanEmulator emulator;
         
         // 2. Inizializza
+        emulator.SetPacingMode(pacingMode);
         if (!emulator.Initialize()) {
             std::cerr << "Errore: impossibile inizializzare l'emulatore" << std::endl;
             return -1;
@@ -21,6 +71,19 @@ int main()
             return -1;
         }
         
+        // JIT della CPU (con verifica differenziale opzionale)
+        if (jit && emulator.GetCPU()->SetJitEnabled(true)) {
+            emulator.GetCPU()->GetJit()->SetDifferentialCheck(jitCheck);
+        }
+
+        // Movie: registrazione e/o replay partono dalla macchina appena resettata
+        if (!recordPath.empty() && !emulator.StartRecording(recordPath)) {
+            return -1;
+        }
+        if (!replayPath.empty() && !emulator.StartReplay(replayPath)) {
+            return -1;
+        }
+
         // 4. Avvia il game loop
         emulator.Run();
         
@@ -3,53 +3,73 @@
 #include <iostream>
 #include <iomanip>
 
-MemoryBus::MemoryBus()
+MemoryBus::MemoryBus() : m_romImage(std::make_shared<RomImage>())
 {
+	BuildPageTable();
 }
 
 MemoryBus::~MemoryBus()
 {
 }
 
-// MemoryBus.cpp - Read corretto:
-uint8_t MemoryBus::Read(uint16_t address)
+void MemoryBus::BuildPageTable()
 {
-	// ROM: 0x0000-0x3FFF
-	if (address <= 0x3FFF) return m_rom[address];
+	m_readPages.fill(nullptr);
+	m_writePages.fill(nullptr);
 
-	// Video RAM: 0x4000-0x43FF
-	if (address <= 0x43FF) return m_VRam[address - 0x4000];
+	if (IsFlatMemory()) {
+		for (int page = 0; page < PAGE_COUNT; page++) {
+			m_readPages[page] = m_writePages[page] = m_flatMemory.data() + (page << PAGE_SHIFT);
+		}
+		return;
+	}
 
-	// Color RAM: 0x4400-0x47FF
-	if (address <= 0x47FF) return m_CRam[address - 0x4400];
+	// ROM: 0x0000-0x3FFF (sola lettura: le scritture passano da WriteSlow e vengono ignorate)
+	for (int page = 0x00; page <= 0x3F; page++) {
+		m_readPages[page] = m_romImage->rom.data() + ((page - 0x00) << PAGE_SHIFT);
+	}
+
+	// Video RAM: 0x4000-0x43FF (le scritture passano da WriteSlow per il dirty tracking)
+	for (int page = 0x40; page <= 0x43; page++) {
+		m_readPages[page] = m_VRam.data() + ((page - 0x40) << PAGE_SHIFT);
+	}
+
+	// Color RAM: 0x4400-0x47FF (idem)
+	for (int page = 0x44; page <= 0x47; page++) {
+		m_readPages[page] = m_CRam.data() + ((page - 0x44) << PAGE_SHIFT);
+	}
 
 	// RAM: 0x4800-0x4FFF
-	if (address <= 0x4FFF) return m_ram[address - 0x4800];
+	for (int page = 0x48; page <= 0x4F; page++) {
+		m_readPages[page] = m_writePages[page] = m_ram.data() + ((page - 0x48) << PAGE_SHIFT);
+	}
+
+	// 0x5000-0x50FF (I/O) e il resto dello spazio restano sul percorso lento
+}
 
+void MemoryBus::EnableFlatMemory()
+{
+	m_flatMemory.assign(0x10000, 0x00);
+	BuildPageTable();
+}
+
+// Percorso lento: I/O e indirizzi non mappati
+uint8_t MemoryBus::ReadSlow(uint16_t address)
+{
 	// I/O AREA: 0x5000-0x50FF - CRITICO!
 	if (address >= 0x5000 && address <= 0x50FF) {
 		uint8_t offset = address & 0xFF;
 
-		// Input ports (read only)
+		// Input ports (read only): ogni porta occupa 64 indirizzi.
+		// I registri sprite a 0x5060 sono in sola scrittura: la lettura restituisce IN1.
 		if (offset < 0x40) {
-			switch (offset) {
-			case 0x00: // IN0: P1 controls
-				return m_in0;
-
-			case 0x40: // IN1: P2 controls  
-				return m_in1;
-
-			case 0x80: // DSW1: DIP switches
-				return m_dipSwitches;
-
-			default:
-				return 0xFF;
-			}
+			return m_in0;		// IN0: P1 controls, coin
 		}
-
-		// Sprite coordinates: 0x5060-0x506F
-		if (offset >= 0x60 && offset < 0x70) {
-			return m_spriteCoords[offset - 0x60];
+		if (offset < 0x80) {
+			return m_in1;		// IN1: P2 controls, start
+		}
+		if (offset < 0xC0) {
+			return m_dipSwitches;	// DSW1: DIP switches
 		}
 
 		// Altri registri
@@ -60,27 +80,21 @@ uint8_t MemoryBus::Read(uint16_t address)
 	return 0xFF;
 }
 
-// MemoryBus.cpp - Write corretto:
-void MemoryBus::Write(uint16_t address, uint8_t value)
+// Percorso lento: I/O, ROM (read-only), Video/Color RAM e indirizzi non mappati
+void MemoryBus::WriteSlow(uint16_t address, uint8_t value)
 {
 	// ROM: read-only
 	if (address <= 0x3FFF) return;
 
-	// Video RAM: 0x4000-0x43FF
-	if (address <= 0x43FF) {
-		m_VRam[address - 0x4000] = value;
-		return;
-	}
-
-	// Color RAM: 0x4400-0x47FF
+	// Video RAM e Color RAM: 0x4000-0x47FF
+	// La cella e' dirty solo se il valore cambia davvero
 	if (address <= 0x47FF) {
-		m_CRam[address - 0x4400] = value;
-		return;
-	}
-
-	// RAM: 0x4800-0x4FFF
-	if (address <= 0x4FFF) {
-		m_ram[address - 0x4800] = value;
+		uint16_t offset = address & 0x3FF;
+		uint8_t &cell = (address < 0x4400) ? m_VRam[offset] : m_CRam[offset];
+		if (cell != value) {
+			cell = value;
+			m_tileDirty.set(offset);
+		}
 		return;
 	}
 
@@ -95,9 +109,15 @@ void MemoryBus::Write(uint16_t address, uint8_t value)
 			return;
 		}
 
-		// Sound registers: 0x5040-0x505F
+		// Sound enable: 0x5001
+		if (offset == 0x01) {
+			m_soundEnabled = (value & 0x01) != 0;
+			return;
+		}
+
+		// Sound registers: 0x5040-0x505F (solo il nibble basso e' collegato)
 		if (offset >= 0x40 && offset < 0x60) {
-			// Per ora ignora i suoni
+			m_soundRegs[offset - 0x40] = value & 0x0F;
 			return;
 		}
 
@@ -109,7 +129,8 @@ void MemoryBus::Write(uint16_t address, uint8_t value)
 
 		// Watchdog: 0x50C0
 		if (offset == 0xC0) {
-			// Reset watchdog timer (ignora per ora)
+			// Reset watchdog timer (controllato da Machine una volta per frame)
+			m_watchdogKicked = true;
 			return;
 		}
 
@@ -118,26 +139,29 @@ void MemoryBus::Write(uint16_t address, uint8_t value)
 }
 
 void MemoryBus::Initialize() {
-	m_rom.fill(0);
+	// Le ROM non vengono azzerate qui: l'immagine puo' essere condivisa
+	// con altre istanze e nasce gia' azzerata.
 	m_VRam.fill(0);
 	m_CRam.fill(0);
 	m_ram.fill(0);
 	m_SRam.fill(0);
-	m_graphicsTiles.fill(0);
-	m_graphicsPalette.fill(0);
-
-	// Setup input per attract mode
-	m_in0 = 0x3F;  // Bit pattern: 0011 1111
-	// Bit 7: unused
-	// Bit 6: coin (1=not pressed)
-	// Bit 5-0: altri controlli
-
-	m_in1 = 0xFF;  // Tutti i tasti non premuti
+	m_tileDirty.set();
+	m_irqEnabled = false;
+	m_watchdogKicked = false;
+	m_spriteCoords.fill(0);
+	m_spriteAttribs.fill(0);
+	m_soundRegs.fill(0);
+	m_soundEnabled = false;
+
+	// Nessun tasto premuto e configurazione standard dei DIP switch
+	SetInputs(InputState());
+}
 
-	m_dipSwitches = 0xC9;  // Config standard:
-	// 1 coin = 1 credit
-	// 3 lives
-	// Normal difficulty
+void MemoryBus::SetInputs(const InputState &inputs)
+{
+	m_in0 = inputs.in0;
+	m_in1 = inputs.in1;
+	m_dipSwitches = inputs.dipSwitches;
 }
 
 size_t MemoryBus::LoadRom(const std::string &filename, ROMType type, size_t offset)
@@ -158,37 +182,92 @@ size_t MemoryBus::LoadRom(const std::string &filename, ROMType type, size_t offs
 	
 	if (type == ROMType::CPU) {
 		// Leggi i dati
-		file.read(reinterpret_cast<char *>(m_rom.data() + offset), fileSize);
+		file.read(reinterpret_cast<char *>(m_romImage->rom.data() + offset), fileSize);
 	}
 	else if (type == ROMType::GRAPHICS_TILES) {
-		file.read(reinterpret_cast<char *>(m_graphicsTiles.data() + offset), fileSize);
+		file.read(reinterpret_cast<char *>(m_romImage->graphicsTiles.data() + offset), fileSize);
 	}
 	else if (type == ROMType::GRAPHICS_PALETTE) {
-		file.read(reinterpret_cast<char *>(m_graphicsPalette.data() + offset), fileSize);
+		file.read(reinterpret_cast<char *>(m_romImage->graphicsPalette.data() + offset), fileSize);
 	}
 	else if (type==ROMType::PALETTE_LOOKUP) {
-		file.read(reinterpret_cast<char *>(m_paletteLookup.data() + offset), fileSize);
+		file.read(reinterpret_cast<char *>(m_romImage->paletteLookup.data() + offset), fileSize);
+	}
+	else if (type == ROMType::SOUND_WAVEFORMS) {
+		file.read(reinterpret_cast<char *>(m_romImage->soundWaveforms.data() + offset), fileSize);
 	}
     
 	size_t bytesRead = file.gcount();
     file.close();
 
+	if (type == ROMType::GRAPHICS_TILES || type == ROMType::GRAPHICS_PALETTE || type == ROMType::PALETTE_LOOKUP) {
+		m_romImage->graphicsVersion++;
+	}
+
     std::cout << "ROM caricata con successo: " << filename << std::endl;
     
 	return bytesRead;
 }
 
+void MemoryBus::SaveState(StateWriter &writer) const
+{
+	writer.WriteBytes(m_VRam.data(), m_VRam.size());
+	writer.WriteBytes(m_CRam.data(), m_CRam.size());
+	writer.WriteBytes(m_ram.data(), m_ram.size());
+	writer.WriteBytes(m_SRam.data(), m_SRam.size());
+	writer.WriteBytes(m_spriteCoords.data(), m_spriteCoords.size());
+	writer.WriteBytes(m_spriteAttribs.data(), m_spriteAttribs.size());
+	writer.WriteBytes(m_soundRegs.data(), m_soundRegs.size());
+
+	// Latch di I/O
+	writer.Write8(m_in0);
+	writer.Write8(m_in1);
+	writer.Write8(m_dipSwitches);
+	writer.WriteBool(m_irqEnabled);
+	writer.WriteBool(m_watchdogKicked);
+	writer.WriteBool(m_soundEnabled);
+}
+
+void MemoryBus::LoadState(StateReader &reader)
+{
+	reader.ReadBytes(m_VRam.data(), m_VRam.size());
+	reader.ReadBytes(m_CRam.data(), m_CRam.size());
+	reader.ReadBytes(m_ram.data(), m_ram.size());
+	reader.ReadBytes(m_SRam.data(), m_SRam.size());
+	reader.ReadBytes(m_spriteCoords.data(), m_spriteCoords.size());
+	reader.ReadBytes(m_spriteAttribs.data(), m_spriteAttribs.size());
+	reader.ReadBytes(m_soundRegs.data(), m_soundRegs.size());
+
+	m_in0 = reader.Read8();
+	m_in1 = reader.Read8();
+	m_dipSwitches = reader.Read8();
+	m_irqEnabled = reader.ReadBool();
+	m_watchdogKicked = reader.ReadBool();
+	m_soundEnabled = reader.ReadBool();
+
+	// La tilemap e' cambiata tutta insieme: il video deve ridisegnarla
+	m_tileDirty.set();
+}
+
+void MemoryBus::ShareRomImage(std::shared_ptr<RomImage> image)
+{
+	if (image) {
+		m_romImage = std::move(image);
+		BuildPageTable();
+	}
+}
+
 const uint8_t *MemoryBus::GetGraphicsTiles() const
 {
-	return m_graphicsTiles.data();
+	return m_romImage->graphicsTiles.data();
 }
 
 const uint8_t *MemoryBus::GetGraphicsPalette() const
 {
-	return m_graphicsPalette.data();
+	return m_romImage->graphicsPalette.data();
 }
 
 const uint8_t *MemoryBus::GetGraphicsPaletteLookup() const
 {
-	return m_paletteLookup.data();
+	return m_romImage->paletteLookup.data();
 }
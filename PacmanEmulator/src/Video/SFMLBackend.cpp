@@ -1,5 +1,6 @@
 ﻿#include "Video/SFMLBackend.h"
 #include <iostream>
+#include <bit>
 
 SFMLBackend::SFMLBackend()
     : m_window(nullptr), m_frameTexture(nullptr),
@@ -37,6 +38,11 @@ bool SFMLBackend::Initialize(unsigned int width, unsigned int height, unsigned i
         return false;
     }
 
+    // Buffer di conversione allocato una volta sola (serve solo su host big-endian)
+    if constexpr (std::endian::native != std::endian::little) {
+        m_swizzleBuffer.assign(static_cast<size_t>(width) * height, 0);
+    }
+
     // 4. Crea lo sprite per visualizzare la texture
     m_frameSprite = std::make_unique<sf::Sprite>(*m_frameTexture);
     m_frameSprite->setScale(sf::Vector2f(scale, scale));  // Applica lo scaling
@@ -56,29 +62,28 @@ void SFMLBackend::DisplayFrameBuffer(const uint32_t *frameBuffer,
         return;
     }
 
-    // 2. Converti il framebuffer RGBA in texture SFML
-    // SFML carica i dati così: m_frameTexture->update((uint8_t*)frameBuffer);
-    //m_frameTexture->update((uint8_t *)frameBuffer);
-    // Converti da RGBA 32-bit a SFML Uint8 RGBA
-    // TEST: Riempi la texture di rosso
-    std::vector<uint8_t> pixels(width * height * 4);
-    for (unsigned int i = 0; i < width * height; i++) {
-        uint32_t rgba = frameBuffer[i];
-
-        // Estrai i byte così come sono
-        uint8_t byte0 = (rgba) & 0xFF;
-        uint8_t byte1 = (rgba >> 8) & 0xFF;
-        uint8_t byte2 = (rgba >> 16) & 0xFF;
-        uint8_t byte3 = (rgba >> 24) & 0xFF;
-
-        // Metti nel buffer RGBA
-        pixels[i * 4 + 0] = byte0;
-        pixels[i * 4 + 1] = byte1;
-        pixels[i * 4 + 2] = byte2;
-        pixels[i * 4 + 3] = byte3;
+    // La texture ha le dimensioni fissate in Initialize
+    if (width != m_width || height != m_height) {
+        std::cerr << "❌ Errore: dimensioni del framebuffer diverse dalla texture" << std::endl;
+        return;
     }
-    m_frameTexture->update(pixels.data());
 
+    // 2. Carica il framebuffer nella texture
+    // I pixel sono uint32_t con R nel byte basso: su host little-endian in memoria
+    // sono gia' nell'ordine RGBA che SFML si aspetta, niente copie
+    if constexpr (std::endian::native == std::endian::little) {
+        m_frameTexture->update(reinterpret_cast<const uint8_t *>(frameBuffer));
+    }
+    else {
+        // Big-endian: inverti i byte di ogni pixel nel buffer persistente
+        const size_t pixelCount = static_cast<size_t>(width) * height;
+        for (size_t i = 0; i < pixelCount; i++) {
+            uint32_t rgba = frameBuffer[i];
+            m_swizzleBuffer[i] = (rgba >> 24) | ((rgba >> 8) & 0x0000FF00) |
+                ((rgba << 8) & 0x00FF0000) | (rgba << 24);
+        }
+        m_frameTexture->update(reinterpret_cast<const uint8_t *>(m_swizzleBuffer.data()));
+    }
 
     // 3. Posiziona lo sprite con offset
     m_frameSprite->setPosition(sf::Vector2f(offsetX, offsetY));
@@ -98,29 +103,68 @@ void SFMLBackend::Present()
     m_window->display();
 }
 
+void SFMLBackend::SetVSync(bool enabled)
+{
+    // Col vsync attivo display() blocca fino al refresh successivo
+    m_window->setVerticalSyncEnabled(enabled);
+}
+
+namespace {
+
+// Corrispondenza fra KeyCode (nostro enum) e sf::Keyboard::Key (SFML)
+struct KeyMapping {
+    KeyCode key;
+    sf::Keyboard::Key sfmlKey;
+};
+
+constexpr KeyMapping KEY_MAPPINGS[] = {
+    { KeyCode::UP, sf::Keyboard::Key::Up },
+    { KeyCode::DOWN, sf::Keyboard::Key::Down },
+    { KeyCode::LEFT, sf::Keyboard::Key::Left },
+    { KeyCode::RIGHT, sf::Keyboard::Key::Right },
+    { KeyCode::SPACE, sf::Keyboard::Key::Space },
+    { KeyCode::ENTER, sf::Keyboard::Key::Enter },
+    { KeyCode::P, sf::Keyboard::Key::P },
+    { KeyCode::ESC, sf::Keyboard::Key::Escape },
+    { KeyCode::R, sf::Keyboard::Key::R },
+    { KeyCode::C, sf::Keyboard::Key::C },
+    { KeyCode::NUM1, sf::Keyboard::Key::Num1 },
+    { KeyCode::NUM2, sf::Keyboard::Key::Num2 },
+    { KeyCode::BACKSPACE, sf::Keyboard::Key::Backspace },
+};
+
+KeyCode FromSfmlKey(sf::Keyboard::Key sfmlKey)
+{
+    for (const KeyMapping &mapping : KEY_MAPPINGS) {
+        if (mapping.sfmlKey == sfmlKey) return mapping.key;
+    }
+    return KeyCode::UNKNOWN;
+}
+
+} // namespace
+
+bool SFMLBackend::PollEvent(BackendEvent &event)
+{
+    // Gli eventi che il frontend non usa vengono scartati qui
+    while (std::optional<sf::Event> sfmlEvent = m_window->pollEvent()) {
+        if (sfmlEvent->is<sf::Event::Closed>()) {
+            event = { BackendEvent::Type::CLOSED, KeyCode::UNKNOWN };
+            return true;
+        }
+        if (const auto *keyPressed = sfmlEvent->getIf<sf::Event::KeyPressed>()) {
+            event = { BackendEvent::Type::KEY_PRESSED, FromSfmlKey(keyPressed->code) };
+            return true;
+        }
+    }
+    return false;
+}
+
 bool SFMLBackend::IsKeyPressed(KeyCode key)
 {
-    // Mappa KeyCode (nostro enum) a sf::Keyboard::Key (SFML)
-    switch (key) {
-    case KeyCode::UP:
-        return sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up);
-    case KeyCode::DOWN:
-        return sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Down);
-    case KeyCode::LEFT:
-        return sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left);
-    case KeyCode::RIGHT:
-        return sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right);
-    case KeyCode::SPACE:
-        return sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space);
-    case KeyCode::ENTER:
-        return sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Enter);
-    case KeyCode::P:
-        return sf::Keyboard::isKeyPressed(sf::Keyboard::Key::P);
-    case KeyCode::ESC:
-        return sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Escape);
-    default:
-        return false;
+    for (const KeyMapping &mapping : KEY_MAPPINGS) {
+        if (mapping.key == key) return sf::Keyboard::isKeyPressed(mapping.sfmlKey);
     }
+    return false;
 }
 
 void SFMLBackend::Shutdown()
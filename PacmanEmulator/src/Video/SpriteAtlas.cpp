@@ -0,0 +1,28 @@
+#include "Video/SpriteAtlas.h"
+#include "Video/TileDecoder.h"
+#include <algorithm>
+
+SpriteAtlas::SpriteAtlas(const MemoryBus &memory)
+	: m_pixels((size_t)PALETTE_COUNT * FLIP_COUNT * SPRITE_COUNT * SPRITE_PIXELS),
+	m_indices((size_t)PALETTE_COUNT * FLIP_COUNT * SPRITE_COUNT * SPRITE_PIXELS),
+	m_graphicsVersion(memory.GetGraphicsVersion())
+{
+	TileDecoder decoder(memory);
+	auto colors = decoder.BuildColorTable();
+
+	for (int palette = 0; palette < PALETTE_COUNT; palette++) {
+		for (int flip = 0; flip < FLIP_COUNT; flip++) {
+			for (int code = 0; code < SPRITE_COUNT; code++) {
+				auto indices = decoder.DecodeSpriteIndices(static_cast<uint8_t>(code), static_cast<uint8_t>(palette),
+					(flip & 0x01) != 0, (flip & 0x02) != 0);
+				size_t index = ((size_t)palette * FLIP_COUNT + flip) * SPRITE_COUNT + code;
+				std::copy(indices.begin(), indices.end(), m_indices.begin() + index * SPRITE_PIXELS);
+
+				// Stessa conversione di DecodeSprite, senza decodificare due volte
+				for (int i = 0; i < SPRITE_PIXELS; i++) {
+					m_pixels[index * SPRITE_PIXELS + i] = indices[i] != 0 ? colors[indices[i]] : 0;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,22 @@
+#include "Video/TileAtlas.h"
+#include "Video/TileDecoder.h"
+#include <algorithm>
+
+TileAtlas::TileAtlas(const MemoryBus &memory)
+	: m_pixels((size_t)PALETTE_COUNT * TILE_COUNT * TILE_PIXELS),
+	m_indices((size_t)PALETTE_COUNT * TILE_COUNT * TILE_PIXELS),
+	m_graphicsVersion(memory.GetGraphicsVersion())
+{
+	TileDecoder decoder(memory);
+	m_colors = decoder.BuildColorTable();
+
+	for (int palette = 0; palette < PALETTE_COUNT; palette++) {
+		for (int tile = 0; tile < TILE_COUNT; tile++) {
+			size_t offset = ((size_t)palette * TILE_COUNT + tile) * TILE_PIXELS;
+			auto pixels = decoder.DecodeTile(static_cast<uint8_t>(tile), static_cast<uint8_t>(palette));
+			std::copy(pixels.begin(), pixels.end(), m_pixels.begin() + offset);
+			auto indices = decoder.DecodeTileIndices(static_cast<uint8_t>(tile), static_cast<uint8_t>(palette));
+			std::copy(indices.begin(), indices.end(), m_indices.begin() + offset);
+		}
+	}
+}
@@ -1,10 +1,108 @@
 ﻿#include "Video/TileDecoder.h"
 
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(TILEDECODER_NO_SIMD)
+#define TILEDECODER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+#if defined(TILEDECODER_SSE2)
+    // Colore di 4 pixel a partire dai loro indici 0-3 (uno per lane a 32 bit).
+    // Le quattro maschere si escludono a vicenda: basta un OR dei colori selezionati.
+    inline __m128i LookupColors(__m128i indices, const __m128i colors[4])
+    {
+        __m128i pixels = _mm_and_si128(_mm_cmpeq_epi32(indices, _mm_setzero_si128()), colors[0]);
+        pixels = _mm_or_si128(pixels, _mm_and_si128(_mm_cmpeq_epi32(indices, _mm_set1_epi32(1)), colors[1]));
+        pixels = _mm_or_si128(pixels, _mm_and_si128(_mm_cmpeq_epi32(indices, _mm_set1_epi32(2)), colors[2]));
+        pixels = _mm_or_si128(pixels, _mm_and_si128(_mm_cmpeq_epi32(indices, _mm_set1_epi32(3)), colors[3]));
+        return pixels;
+    }
+
+    // Espande 8 indici (byte) in 8 pixel RGBA
+    inline void StoreRow(uint32_t *dest, __m128i indices16, const __m128i colors[4])
+    {
+        __m128i zero = _mm_setzero_si128();
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest), LookupColors(_mm_unpacklo_epi16(indices16, zero), colors));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + 4), LookupColors(_mm_unpackhi_epi16(indices16, zero), colors));
+    }
+
+    // Stesso risultato di DecodeTileScalar, 16 pixel per iterazione.
+    // I 16 byte del tile sono le righe native: 0-7 meta' destra, 8-15 meta' sinistra.
+    // Dopo la rotazione la riga k (0-3) viene dal bit 3-k della meta' sinistra e la
+    // riga k+4 dallo stesso bit della meta' destra, con la colonna c presa dalla riga
+    // nativa 7-c: un solo shift produce entrambe le righe.
+    void DecodeTileSSE2(const uint8_t *tile, const std::array<uint32_t, 4> &palette, uint32_t *output)
+    {
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tile));
+
+        // Inverti l'ordine dei byte dentro ciascuna meta' da 8 (SSE2 non ha pshufb:
+        // scambio dei byte nelle word, poi delle word nelle meta')
+        data = _mm_or_si128(_mm_slli_epi16(data, 8), _mm_srli_epi16(data, 8));
+        data = _mm_shufflelo_epi16(data, _MM_SHUFFLE(0, 1, 2, 3));
+        data = _mm_shufflehi_epi16(data, _MM_SHUFFLE(0, 1, 2, 3));
+
+        const __m128i colors[4] = {
+            _mm_set1_epi32(static_cast<int>(palette[0])), _mm_set1_epi32(static_cast<int>(palette[1])),
+            _mm_set1_epi32(static_cast<int>(palette[2])), _mm_set1_epi32(static_cast<int>(palette[3]))
+        };
+        const __m128i one = _mm_set1_epi8(1);
+        const __m128i zero = _mm_setzero_si128();
+
+        for (int row = 0; row < 4; row++) {
+            int bitIndex = 3 - row;
+
+            // Piano basso (bit 0-3) e alto (bit 4-7): gli shift a 16 bit sporcano solo i bit alti, tolti dalla maschera
+            __m128i bit0 = _mm_and_si128(_mm_srl_epi16(data, _mm_cvtsi32_si128(bitIndex)), one);
+            __m128i bit1 = _mm_and_si128(_mm_srl_epi16(data, _mm_cvtsi32_si128(bitIndex + 4)), one);
+            __m128i indices = _mm_or_si128(bit0, _mm_add_epi8(bit1, bit1));
+
+            StoreRow(output + (row + 4) * 8, _mm_unpacklo_epi8(indices, zero), colors);
+            StoreRow(output + row * 8, _mm_unpackhi_epi8(indices, zero), colors);
+        }
+    }
+#endif
+}
+
 TileDecoder::TileDecoder(const MemoryBus &memory) : m_memory(memory)
 {
 }
 
+bool TileDecoder::IsSimdSupported()
+{
+#if defined(TILEDECODER_SSE2)
+    return true;
+#else
+    return false;
+#endif
+}
+
 std::array<uint32_t, 64> TileDecoder::DecodeTile(uint8_t tile_index, uint8_t palette_offset)
+{
+#if defined(TILEDECODER_SSE2)
+    std::array<uint32_t, 64> output;
+    DecodeTileSSE2(m_memory.GetGraphicsTiles() + (tile_index << 4), BuildTileColors(palette_offset), output.data());
+    return output;
+#else
+    return DecodeTileScalar(tile_index, palette_offset);
+#endif
+}
+
+std::array<uint32_t, 4> TileDecoder::BuildTileColors(uint8_t palette_offset)
+{
+    // I 4 colori che un tile puo' usare con questa palette (stessa lookup di DecodeTileScalar)
+    std::array<uint32_t, 4> colors;
+    const uint8_t *paletteData = m_memory.GetGraphicsPalette();
+    const uint8_t *paletteLookup = m_memory.GetGraphicsPaletteLookup();
+
+    for (int pixel_value = 0; pixel_value < 4; pixel_value++) {
+        uint8_t lookup_addr = (palette_offset << 2) | pixel_value;
+        uint8_t color_index = paletteLookup[lookup_addr] & 0x0F;
+        colors[pixel_value] = ConvertPaletteByteToRGBA(paletteData[color_index]);
+    }
+    return colors;
+}
+
+std::array<uint32_t, 64> TileDecoder::DecodeTileScalar(uint8_t tile_index, uint8_t palette_offset)
 {
     std::array<uint32_t, 64> output = {};
     const uint8_t *tileData = m_memory.GetGraphicsTiles();
@@ -58,6 +156,93 @@ std::array<uint32_t, 64> TileDecoder::DecodeTile(uint8_t tile_index, uint8_t pal
     return output;
 }
 
+std::array<uint32_t, 256> TileDecoder::DecodeSprite(uint8_t sprite_code, uint8_t palette_offset, bool flip_x, bool flip_y)
+{
+    std::array<uint8_t, 256> indices = DecodeSpriteIndices(sprite_code, palette_offset, flip_x, flip_y);
+    std::array<uint32_t, COLOR_COUNT> colors = BuildColorTable();
+
+    // Il colore 0 della lookup e' trasparente (alpha 0)
+    std::array<uint32_t, 256> output;
+    for (size_t i = 0; i < output.size(); i++) {
+        output[i] = indices[i] != 0 ? colors[indices[i]] : 0;
+    }
+    return output;
+}
+
+std::array<uint8_t, 256> TileDecoder::DecodeSpriteIndices(uint8_t sprite_code, uint8_t palette_offset, bool flip_x, bool flip_y)
+{
+    std::array<uint8_t, 256> output = {};
+    // Gli sprite stanno nella seconda meta' della rom grafica (pacman.5f), 64 byte ciascuno
+    const uint8_t *spriteData = m_memory.GetGraphicsTiles() + 0x1000 + ((sprite_code & 0x3F) << 6);
+    const uint8_t *paletteLookup = m_memory.GetGraphicsPaletteLookup();
+
+    // Layout hardware (coordinate native, non ruotate): lo sprite e' fatto di
+    // 8 strisce 8x4. Colonne 0-3 -> byte +8, 4-7 -> +16, 8-11 -> +24, 12-15 -> +0;
+    // le righe 8-15 stanno 32 byte piu' avanti. Come nei tile, i bit 4-7 di ogni
+    // byte sono il piano alto e i bit 0-3 il piano basso, MSB a sinistra.
+    static constexpr int stripOffset[4] = { 8, 16, 24, 0 };
+
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 16; x++) {
+            uint8_t data = spriteData[stripOffset[x >> 2] + (y & 7) + ((y >> 3) << 5)];
+            int bitIndex = 3 - (x & 3);
+
+            uint8_t bit0 = (data >> bitIndex) & 0x01;
+            uint8_t bit1 = (data >> (bitIndex + 4)) & 0x01;
+            uint8_t pixel_value = (bit1 << 1) | bit0;
+
+            // Lookup Colore: l'indice 0 e' trasparente
+            uint8_t lookup_addr = (palette_offset << 2) | pixel_value;
+            uint8_t color_index = paletteLookup[lookup_addr] & 0x0F;
+
+            // Flip applicati nelle coordinate native, poi rotazione 90 gradi oraria
+            int nativeX = flip_x ? 15 - x : x;
+            int nativeY = flip_y ? 15 - y : y;
+            int targetX = 15 - nativeY;
+            int targetY = nativeX;
+
+            output[(targetY * 16) + targetX] = color_index;
+        }
+    }
+    return output;
+}
+
+std::array<uint8_t, 64> TileDecoder::DecodeTileIndices(uint8_t tile_index, uint8_t palette_offset)
+{
+    std::array<uint8_t, 64> output = {};
+    const uint8_t *tileData = m_memory.GetGraphicsTiles() + (tile_index << 4);
+    const uint8_t *paletteLookup = m_memory.GetGraphicsPaletteLookup();
+
+    // Stesso layout di DecodeTileScalar: colonne 0-3 dal byte +8, 4-7 dal byte +0
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            uint8_t data = tileData[y + (x < 4 ? 8 : 0)];
+            int bitIndex = 3 - (x & 3);
+
+            uint8_t bit0 = (data >> bitIndex) & 0x01;
+            uint8_t bit1 = (data >> (bitIndex + 4)) & 0x01;
+            uint8_t pixel_value = (bit1 << 1) | bit0;
+
+            uint8_t lookup_addr = (palette_offset << 2) | pixel_value;
+
+            // Rotazione 90 gradi oraria come DecodeTile
+            output[x * 8 + (7 - y)] = paletteLookup[lookup_addr] & 0x0F;
+        }
+    }
+    return output;
+}
+
+std::array<uint32_t, TileDecoder::COLOR_COUNT> TileDecoder::BuildColorTable()
+{
+    std::array<uint32_t, COLOR_COUNT> colors;
+    const uint8_t *paletteData = m_memory.GetGraphicsPalette();
+
+    for (int color_index = 0; color_index < COLOR_COUNT; color_index++) {
+        colors[color_index] = ConvertPaletteByteToRGBA(paletteData[color_index]);
+    }
+    return colors;
+}
+
 uint32_t TileDecoder::ConvertPaletteByteToRGBA(uint8_t palette_byte)
 {
     // Hardware Pac-Man (PROM 82S123) output mapping:
@@ -1,10 +1,33 @@
 ﻿#include "Video/VideoController.h"
 #include <iostream>
 #include <fstream>
+#include <cstring>
+#include <algorithm>
 
-VideoController::VideoController(MemoryBus &memory) : m_memory(memory), m_tileDecoder(memory)
+VideoController::VideoController(MemoryBus &memory)
+	: m_memory(memory), m_format(FrameBufferFormat::RGBA), m_frameBuffer(SCREEN_SIZE, 0)
 {
-	m_frameBuffer.fill(0);
+	m_rowRedraw.fill(false);
+	MarkAllTilesForRedraw();
+}
+
+void VideoController::SetFrameBufferFormat(FrameBufferFormat format)
+{
+	if (format == m_format) return;
+	m_format = format;
+
+	// Il buffer dell'altro formato viene rilasciato: e' qui il risparmio di memoria
+	if (format == FrameBufferFormat::INDEXED) {
+		std::vector<uint32_t>().swap(m_frameBuffer);
+		m_indexedFrameBuffer.assign(SCREEN_SIZE, 0);
+	}
+	else {
+		std::vector<uint8_t>().swap(m_indexedFrameBuffer);
+		m_frameBuffer.assign(SCREEN_SIZE, 0);
+	}
+
+	// Il nuovo buffer e' vuoto: lo sfondo va ridisegnato per intero
+	MarkAllTilesForRedraw();
 }
 
 void VideoController::RenderScanline(int scanline_y)
@@ -12,50 +35,161 @@ void VideoController::RenderScanline(int scanline_y)
 	// Pac-Man ha risoluzione 224x288
 	if (scanline_y >= SCREEN_HEIGHT) return;
 
+	// All'inizio del frame verifica che l'atlante corrisponda alle ROM caricate
+	if (scanline_y == 0) EnsureTileAtlas();
+
 	int tile_y = scanline_y / 8;        // Riga del tile (0-35)
 	int pixel_row_in_tile = scanline_y % 8;
+	const bool indexed = m_format == FrameBufferFormat::INDEXED;
 
-	// Per ogni colonna dello schermo (0-27)
-	for (int tile_x = 0; tile_x < 28; tile_x++) {
+	// Prima riga di pixel del tile: decidi quali tile della riga vanno ridisegnati
+	// (cella modificata in VRAM/Color RAM, oppure ridisegno forzato)
+	if (pixel_row_in_tile == 0) {
+		for (int tile_x = 0; tile_x < TILE_FOR_ROW; tile_x++) {
+			uint16_t vram_offset = GetVramOffset(tile_x, tile_y);
+			m_rowRedraw[tile_x] = m_forceRedraw[tile_y][tile_x] || m_memory.IsTileDirty(vram_offset);
+			m_forceRedraw[tile_y][tile_x] = false;
+			m_memory.ClearTileDirty(vram_offset);
+		}
+	}
 
-		// --- FIX: Calcolo Indirizzo VRAM Corretto ---
+	// Per ogni colonna dello schermo (0-27)
+	for (int tile_x = 0; tile_x < TILE_FOR_ROW; tile_x++) {
 		uint16_t vram_offset = GetVramOffset(tile_x, tile_y);
-		// --------------------------------------------
+
+		// Una scrittura a meta' riga resta dirty: le righe di pixel successive la
+		// vedono subito e il frame seguente ridisegna il tile intero
+		if (!m_rowRedraw[tile_x] && !m_memory.IsTileDirty(vram_offset)) continue;
 
 		// Leggi Tile Index (0x4000) e Attributi Colore (0x4400) usando lo stesso offset
 		uint8_t tile_index = m_memory.Read(0x4000 + vram_offset);
-		uint8_t color_attr = m_memory.Read(0x4400 + vram_offset); // Era color_index
-
-		// Decodifica: Attenzione! Passa 'color_attr' (che è l'indice palette), 
-		// NON tile_index o altro.
-		auto tile_pixels = m_tileDecoder.DecodeTile(tile_index, color_attr);
-
-		// Disegna gli 8 pixel orizzontali
-		for (int px = 0; px < 8; px++) {
-			int screen_x = tile_x * 8 + px;
-			int screen_y = scanline_y;
-
-			// Check bounds (sicurezza)
-			if (screen_x < SCREEN_WIDTH && screen_y < SCREEN_HEIGHT) {
-				int fb_offset = screen_y * SCREEN_WIDTH + screen_x;
-				m_frameBuffer[fb_offset] = tile_pixels[pixel_row_in_tile * 8 + px];
-			}
+		uint8_t color_attr = m_memory.Read(0x4400 + vram_offset);
+
+		// La riga del tile e' gia' decodificata: copia diretta degli 8 pixel
+		int fb_offset = scanline_y * SCREEN_WIDTH + tile_x * 8;
+		if (indexed) {
+			const uint8_t *tile_indices = m_tileAtlas->GetTileIndices(tile_index, color_attr);
+			std::memcpy(&m_indexedFrameBuffer[fb_offset], tile_indices + pixel_row_in_tile * 8, 8);
+		}
+		else {
+			const uint32_t *tile_pixels = m_tileAtlas->GetTile(tile_index, color_attr);
+			std::memcpy(&m_frameBuffer[fb_offset], tile_pixels + pixel_row_in_tile * 8, 8 * sizeof(uint32_t));
 		}
 	}
 }
 
-void VideoController::RenderFrame()
+void VideoController::RenderFrame(bool full_redraw)
 {
-	for (int y = 0; y < 36; y++) {
-		for (int x = 0; x < 28; x++) {
-			RenderTile(x, y);
+	// Frame intero in un colpo solo (strumenti, benchmark): stesso ordine di
+	// Machine::RunFrame, prima lo sfondo riga per riga e poi gli sprite.
+	// Il ridisegno completo passa comunque dal dirty tracking.
+	if (full_redraw) MarkAllTilesForRedraw();
+
+	for (int scanline_y = 0; scanline_y < SCREEN_HEIGHT; scanline_y++) {
+		RenderScanline(scanline_y);
+	}
+	RenderSprites();
+}
+
+void VideoController::RenderSprites()
+{
+	EnsureSpriteAtlas();
+
+	// 8 sprite hardware: attributi in RAM a 0x4FF0 (codice/flip, colore),
+	// coordinate a 0x5060 (x, y). Lo sprite 0 ha la priorita' piu' alta,
+	// quindi si disegna dal 7 allo 0.
+	for (int i = 7; i >= 0; i--) {
+		uint8_t attr = m_memory.Read(0x4FF0 + i * 2);
+		uint8_t color = m_memory.Read(0x4FF1 + i * 2);
+		uint8_t coord_x = m_memory.Read(0x5060 + i * 2);
+		uint8_t coord_y = m_memory.Read(0x5061 + i * 2);
+
+		// Posizione nello schermo nativo (288x224, non ruotato)
+		int native_x = 272 - coord_y;
+		int native_y = coord_x - 31;
+
+		// I primi sprite sono spostati di un pixel sull'hardware reale
+		if (i <= 2) native_y += 1;
+
+		// Rotazione 90 gradi oraria, come per i tile
+		int screen_x = SCREEN_WIDTH - SpriteAtlas::SPRITE_SIZE - native_y;
+		int screen_y = native_x;
+
+		// Il secondo DrawSprite copre il wraparound orizzontale (tunnel)
+		if (m_format == FrameBufferFormat::INDEXED) {
+			const uint8_t *sprite_indices = m_spriteAtlas->GetSpriteIndices(attr >> 2, attr & 0x03, color);
+			DrawSprite(sprite_indices, m_indexedFrameBuffer.data(), screen_x, screen_y);
+			DrawSprite(sprite_indices, m_indexedFrameBuffer.data(), screen_x, screen_y - 256);
+		}
+		else {
+			const uint32_t *sprite_pixels = m_spriteAtlas->GetSprite(attr >> 2, attr & 0x03, color);
+			DrawSprite(sprite_pixels, m_frameBuffer.data(), screen_x, screen_y);
+			DrawSprite(sprite_pixels, m_frameBuffer.data(), screen_x, screen_y - 256);
+		}
+	}
+}
+
+template <typename Pixel>
+void VideoController::DrawSprite(const Pixel *sprite_pixels, Pixel *frame_buffer, int screen_x, int screen_y)
+{
+	// Gli sprite non coprono le due righe di tile in alto e in basso (punteggio e vite)
+	constexpr int clip_top = 2 * 8;
+	constexpr int clip_bottom = 34 * 8;
+	constexpr int size = SpriteAtlas::SPRITE_SIZE;
+
+	if (screen_y + size <= clip_top || screen_y >= clip_bottom) return;
+	if (screen_x + size <= 0 || screen_x >= SCREEN_WIDTH) return;
+
+	int y_start = std::max(0, clip_top - screen_y);
+	int y_end = std::min(size, clip_bottom - screen_y);
+	int x_start = std::max(0, -screen_x);
+	int x_end = std::min(size, SCREEN_WIDTH - screen_x);
+
+	// Lo sfondo sotto lo sprite va ridisegnato al prossimo frame
+	for (int tile_y = (screen_y + y_start) / 8; tile_y <= (screen_y + y_end - 1) / 8; tile_y++) {
+		for (int tile_x = (screen_x + x_start) / 8; tile_x <= (screen_x + x_end - 1) / 8; tile_x++) {
+			m_forceRedraw[tile_y][tile_x] = true;
+		}
+	}
+
+	for (int py = y_start; py < y_end; py++) {
+		const Pixel *src = sprite_pixels + py * size;
+		Pixel *dest = frame_buffer + (screen_y + py) * SCREEN_WIDTH + screen_x;
+
+		for (int px = x_start; px < x_end; px++) {
+			// Pixel trasparente: RGBA 0 (alpha 0) o indice colore 0
+			if (src[px] != 0) dest[px] = src[px];
 		}
 	}
 }
 
 const uint32_t *VideoController::GetFrameBuffer() const
 {
-	return m_frameBuffer.data();
+	return m_format == FrameBufferFormat::RGBA ? m_frameBuffer.data() : nullptr;
+}
+
+const uint8_t *VideoController::GetIndexedFrameBuffer() const
+{
+	return m_format == FrameBufferFormat::INDEXED ? m_indexedFrameBuffer.data() : nullptr;
+}
+
+void VideoController::ConvertFrameBufferToRGBA(uint32_t *dest) const
+{
+	if (m_format == FrameBufferFormat::RGBA) {
+		std::memcpy(dest, m_frameBuffer.data(), SCREEN_SIZE * sizeof(uint32_t));
+		return;
+	}
+
+	// Prima del primo frame non c'e' ancora un atlante: il buffer e' tutto a 0 come in RGBA
+	if (!m_tileAtlas) {
+		std::fill(dest, dest + SCREEN_SIZE, 0u);
+		return;
+	}
+
+	const uint32_t *colors = m_tileAtlas->GetColors();
+	for (int i = 0; i < SCREEN_SIZE; i++) {
+		dest[i] = colors[m_indexedFrameBuffer[i] & (TileDecoder::COLOR_COUNT - 1)];
+	}
 }
 
 std::pair<int, int> VideoController::GetFrameBufferSize() const
@@ -63,24 +197,48 @@ std::pair<int, int> VideoController::GetFrameBufferSize() const
 	return { SCREEN_WIDTH, SCREEN_HEIGHT };
 }
 
-void VideoController::RenderTile(int tile_x, int tile_y)
+void VideoController::RebuildTileAtlas()
+{
+	// Nuovo oggetto: un atlante eventualmente condiviso non viene mai modificato
+	m_tileAtlas = std::make_shared<const TileAtlas>(m_memory);
+	MarkAllTilesForRedraw();
+}
+
+void VideoController::ShareTileAtlas(std::shared_ptr<const TileAtlas> atlas)
 {
-	// Usa la stessa formula helper
-	uint16_t vram_offset = GetVramOffset(tile_x, tile_y);
+	m_tileAtlas = std::move(atlas);
+	MarkAllTilesForRedraw();
+}
 
-	uint8_t tile_index = m_memory.Read(0x4000 + vram_offset);
-	uint8_t color_index = m_memory.Read(0x4400 + vram_offset);
+void VideoController::MarkAllTilesForRedraw()
+{
+	// Fallback: palette o tile cambiati, tutto lo sfondo va ridisegnato
+	for (auto &row : m_forceRedraw) {
+		row.fill(true);
+	}
+}
 
-	auto tile_pixels = m_tileDecoder.DecodeTile(tile_index, color_index);
+void VideoController::RebuildSpriteAtlas()
+{
+	m_spriteAtlas = std::make_shared<const SpriteAtlas>(m_memory);
+}
 
-	for (int py = 0; py < 8; py++) {
-		for (int px = 0; px < 8; px++) {
-			int screen_x = tile_x * 8 + px;
-			int screen_y = tile_y * 8 + py;
-			int fb_offset = screen_y * SCREEN_WIDTH + screen_x;
+void VideoController::ShareSpriteAtlas(std::shared_ptr<const SpriteAtlas> atlas)
+{
+	m_spriteAtlas = std::move(atlas);
+}
 
-			m_frameBuffer[fb_offset] = tile_pixels[py * 8 + px];
-		}
+void VideoController::EnsureSpriteAtlas()
+{
+	if (!m_spriteAtlas || m_spriteAtlas->GetGraphicsVersion() != m_memory.GetGraphicsVersion()) {
+		RebuildSpriteAtlas();
+	}
+}
+
+void VideoController::EnsureTileAtlas()
+{
+	if (!m_tileAtlas || m_tileAtlas->GetGraphicsVersion() != m_memory.GetGraphicsVersion()) {
+		RebuildTileAtlas();
 	}
 }
 
@@ -127,11 +285,16 @@ bool VideoController::SaveFramebufferPPM(const std::string &filename) const
 	file << SCREEN_WIDTH << " " << SCREEN_HEIGHT << "\n";
 	file << "255\n";
 
+	// In modalita' INDEXED la conversione in RGBA avviene solo qui
+	std::vector<uint32_t> pixels(SCREEN_SIZE);
+	ConvertFrameBufferToRGBA(pixels.data());
+
 	for (int i = 0; i < SCREEN_SIZE; i++) {
-		uint32_t rgba = m_frameBuffer[i];
-		uint8_t r = (rgba >> 24) & 0xFF;
-		uint8_t g = (rgba >> 16) & 0xFF;
-		uint8_t b = (rgba >> 8) & 0xFF;
+		uint32_t rgba = pixels[i];
+		// Pixel 0xAABBGGRR (vedi TileDecoder::ConvertPaletteByteToRGBA): rosso nel byte basso
+		uint8_t r = rgba & 0xFF;
+		uint8_t g = (rgba >> 8) & 0xFF;
+		uint8_t b = (rgba >> 16) & 0xFF;
 
 		file.put(r);
 		file.put(g);
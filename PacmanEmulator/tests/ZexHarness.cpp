@@ -0,0 +1,216 @@
+#include "CPU/Z80.h"
+#include "Memory/MemoryBus.h"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Harness CP/M per gli instruction exerciser ZEXDOC/ZEXALL (.com/.cim).
+// Il programma viene caricato a 0x0100 in 64 KB di RAM flat; le chiamate al
+// BDOS (CALL 0x0005) vengono intercettate per l'output su console e il warm
+// boot (salto a 0x0000) termina l'esecuzione.
+//
+// Uso: ZexHarness [file] [--max-seconds S] [--quiet]
+//   file             programma CP/M (default zexdoc.cim)
+//   --max-seconds S  interrompe dopo S secondi (0 = nessun limite)
+//   --quiet          stampa solo il riepilogo dei gruppi
+//
+// Esce con 0 solo se il programma arriva in fondo e tutti i gruppi passano.
+
+namespace {
+
+constexpr uint16_t WARM_BOOT = 0x0000;
+constexpr uint16_t BDOS_ENTRY = 0x0005;
+constexpr uint16_t TPA_START = 0x0100;
+constexpr uint16_t TPA_END = 0xFE00;		// Cima della memoria (letta dal programma a 0x0006)
+
+// Funzioni BDOS usate dagli exerciser
+constexpr uint8_t BDOS_CONSOLE_OUTPUT = 2;	// Carattere in E
+constexpr uint8_t BDOS_PRINT_STRING = 9;	// Stringa a DE terminata da '$'
+
+struct GroupResult {
+    std::string name;
+    bool passed;
+};
+
+// Raccoglie l'output del programma e riconosce le righe di esito:
+// "<gruppo>....  OK" oppure "<gruppo>....  ERROR **** crc expected:... found:..."
+class ConsoleParser {
+public:
+    explicit ConsoleParser(bool echo) : m_echo(echo) {}
+
+    void Put(char c)
+    {
+        if (m_echo) {
+            std::cout << c << std::flush;
+        }
+
+        if (c == '\n') {
+            ParseLine();
+            m_line.clear();
+        }
+        else if (c != '\r') {
+            m_line += c;
+        }
+    }
+
+    const std::vector<GroupResult> &GetResults() const { return m_results; }
+
+private:
+    void ParseLine()
+    {
+        bool passed = m_line.find("OK") != std::string::npos;
+        bool failed = m_line.find("ERROR") != std::string::npos;
+        size_t dots = m_line.find("....");
+        if ((!passed && !failed) || dots == std::string::npos) {
+            return;
+        }
+
+        m_results.push_back({ m_line.substr(0, dots), passed && !failed });
+    }
+
+    bool m_echo;
+    std::string m_line;
+    std::vector<GroupResult> m_results;
+};
+
+bool LoadProgram(const std::string &path, MemoryBus &memory)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Impossibile aprire " << path << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> program((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (program.empty() || program.size() > TPA_END - TPA_START) {
+        std::cerr << "Dimensione del programma non valida: " << program.size() << " byte" << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < program.size(); i++) {
+        memory.Write(static_cast<uint16_t>(TPA_START + i), program[i]);
+    }
+
+    // Pagina zero minima: warm boot a 0x0000, BDOS a 0x0005 che ritorna subito
+    // (la chiamata viene servita dal harness prima del RET). I byte a 0x0006
+    // sono l'indirizzo del JP al BDOS, cioe' la cima della memoria per lo stack.
+    memory.Write(WARM_BOOT, 0x76);				// HALT (mai eseguito)
+    memory.Write(BDOS_ENTRY, 0xC9);				// RET
+    memory.Write(BDOS_ENTRY + 1, TPA_END & 0xFF);
+    memory.Write(BDOS_ENTRY + 2, TPA_END >> 8);
+    return true;
+}
+
+void CallBdos(Z80 &cpu, MemoryBus &memory, ConsoleParser &console)
+{
+    uint8_t function = cpu.GetBC() & 0xFF;
+
+    switch (function) {
+    case BDOS_CONSOLE_OUTPUT:
+        console.Put(static_cast<char>(cpu.GetDE() & 0xFF));
+        break;
+    case BDOS_PRINT_STRING: {
+        uint16_t address = cpu.GetDE();
+        for (char c; (c = static_cast<char>(memory.Read(address))) != '$'; address++) {
+            console.Put(c);
+        }
+        break;
+    }
+    default:
+        // Le altre funzioni non servono agli exerciser
+        break;
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    std::string path = "zexdoc.cim";
+    double maxSeconds = 0.0;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--max-seconds" && i + 1 < argc) {
+            maxSeconds = std::stod(argv[++i]);
+        }
+        else if (arg == "--quiet") {
+            quiet = true;
+        }
+        else if (!arg.empty() && arg[0] != '-') {
+            path = arg;
+        }
+        else {
+            std::cerr << "Argomento sconosciuto: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    MemoryBus memory;
+    memory.EnableFlatMemory();
+    if (!LoadProgram(path, memory)) {
+        return 2;
+    }
+
+    // Il codice degli exerciser si modifica da solo: Step() non passa dalla block
+    // cache, e Run() la disattiva comunque sul bus piatto
+    Z80 cpu(&memory);
+    cpu.SetPC(TPA_START);
+
+    ConsoleParser console(!quiet);
+    uint64_t instructions = 0;
+    bool finished = false;
+    bool timedOut = false;
+
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        uint16_t pc = cpu.GetPC();
+        if (pc == WARM_BOOT) {
+            finished = true;
+            break;
+        }
+        if (pc == BDOS_ENTRY) {
+            CallBdos(cpu, memory, console);
+        }
+
+        cpu.Step();
+        instructions++;
+
+        // Il limite di tempo si controlla di rado per non pesare sul loop
+        if (maxSeconds > 0.0 && (instructions & 0xFFFFF) == 0) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= maxSeconds) {
+                timedOut = true;
+                break;
+            }
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Riepilogo
+    size_t passed = 0;
+    std::cout << "\n=== Riepilogo " << path << " ===\n";
+    for (const GroupResult &group : console.GetResults()) {
+        std::cout << (group.passed ? "  PASS  " : "  FAIL  ") << group.name << "\n";
+        if (group.passed) passed++;
+    }
+    size_t total = console.GetResults().size();
+
+    double seconds = elapsed.count();
+    double mips = seconds > 0.0 ? instructions / seconds / 1e6 : 0.0;
+    double mhz = seconds > 0.0 ? cpu.GetTotalCycles() / seconds / 1e6 : 0.0;
+    std::cout << passed << "/" << total << " gruppi passati, "
+        << instructions << " istruzioni in " << seconds << " s ("
+        << mips << " MIPS, " << mhz << " MHz Z80 emulati)" << std::endl;
+
+    if (timedOut) {
+        std::cout << "Interrotto dopo " << maxSeconds << " s" << std::endl;
+    }
+
+    return (finished && total > 0 && passed == total) ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+#include "Core/BatchRunner.h"
+#include "Core/Machine.h"
+#include "Core/MachineRunner.h"
+#include "CPU/Z80Jit.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Runner headless senza SFML: solo la macchina, alla massima velocita'.
+// E' l'unico punto d'ingresso per le esecuzioni headless, batch e di replay:
+// il frontend SFML serve solo per giocare.
+//
+// Uso: PacmanHeadless [opzioni]
+//   --roms DIR      directory delle ROM di Pac-Man (default assets)
+//   --frames N      fermati dopo N frame (default 600 senza --seconds e --replay)
+//   --seconds S     fermati dopo S secondi
+//   --batch N       esegui N istanze in parallelo
+//   --threads T     (batch) numero di thread, 0 = tutti i core
+//   --record FILE   registra gli input di ogni frame in un movie
+//   --replay FILE   rigioca un movie verificando l'hash della RAM (esce con 1 se desync)
+//   --jit           CPU con JIT x86-64 (solo host x86-64, altrimenti interprete)
+//   --jit-check     JIT con verifica di ogni blocco contro l'interprete
+//   --dump FILE     salva l'ultimo frame in formato PPM
+//   --dump-rgba FILE  salva l'ultimo frame RGBA grezzo (4 byte per pixel, R G B A)
+//   --indexed       framebuffer a indici colore (1 byte per pixel), RGBA solo per i dump
+
+namespace {
+
+struct RunnerOptions {
+    std::string romDir = "assets";
+    uint64_t maxFrames = 0;
+    double maxSeconds = 0.0;
+    size_t batchInstances = 0;
+    unsigned int batchThreads = 0;
+    std::string recordPath;
+    std::string replayPath;
+    std::string dumpPath;
+    std::string rgbaDumpPath;
+    bool jit = false;
+    bool jitCheck = false;
+    bool indexed = false;
+};
+
+// Tutti e quattro i canali, cosi' il confronto tra i due formati di framebuffer e' completo
+bool SaveFramebufferRGBA(const VideoController &video, const std::string &path)
+{
+    std::vector<uint32_t> pixels(SCREEN_SIZE);
+    video.ConvertFrameBufferToRGBA(pixels.data());
+
+    std::vector<uint8_t> bytes;
+    bytes.reserve(pixels.size() * 4);
+    for (uint32_t rgba : pixels) {
+        bytes.push_back(static_cast<uint8_t>(rgba));
+        bytes.push_back(static_cast<uint8_t>(rgba >> 8));
+        bytes.push_back(static_cast<uint8_t>(rgba >> 16));
+        bytes.push_back(static_cast<uint8_t>(rgba >> 24));
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size())) {
+        std::cerr << "Errore: impossibile scrivere " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int RunBatch(const RunnerOptions &options)
+{
+    uint32_t frameObservation = options.indexed ? OBS_FRAMEBUFFER_INDEXED : OBS_FRAMEBUFFER;
+    BatchRunner batch(options.batchInstances, options.batchThreads, frameObservation | OBS_RAM);
+    if (!batch.LoadRomSet(options.romDir)) {
+        std::cerr << "Errore: impossibile caricare la ROM" << std::endl;
+        return -1;
+    }
+    if (options.jit) {
+        batch.SetJitEnabled(true);
+    }
+
+    uint64_t frames = options.maxFrames != 0 ? options.maxFrames : 600;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t f = 0; f < frames; f++) {
+        batch.Step();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double totalFps = (options.batchInstances * frames) / elapsed.count();
+    std::cout << "Batch: " << options.batchInstances << " istanze x " << frames << " frame in "
+        << elapsed.count() << " s (" << totalFps << " frame/s aggregati, "
+        << totalFps / options.batchInstances << " fps per istanza)" << std::endl;
+    return 0;
+}
+
+int RunSingle(const RunnerOptions &options)
+{
+    auto machine = std::make_unique<Machine>();
+    if (!machine->LoadRomSet(options.romDir)) {
+        std::cerr << "Errore: impossibile caricare la ROM" << std::endl;
+        return -1;
+    }
+
+    if (options.jit && machine->GetCPU()->SetJitEnabled(true)) {
+        machine->GetCPU()->GetJit()->SetDifferentialCheck(options.jitCheck);
+    }
+    if (options.indexed) {
+        machine->GetVideo().SetFrameBufferFormat(FrameBufferFormat::INDEXED);
+    }
+
+    // Movie: registrazione e/o replay partono dalla macchina appena resettata
+    MachineRunner runner(*machine);
+    if (!options.recordPath.empty() && !runner.StartRecording(options.recordPath)) {
+        return -1;
+    }
+    if (!options.replayPath.empty() && !runner.StartReplay(options.replayPath)) {
+        return -1;
+    }
+
+    HeadlessOptions headlessOptions;
+    headlessOptions.maxFrames = options.maxFrames;
+    headlessOptions.maxSeconds = options.maxSeconds;
+    if (headlessOptions.maxFrames == 0 && headlessOptions.maxSeconds <= 0.0 && options.replayPath.empty()) {
+        headlessOptions.maxFrames = 600;
+    }
+
+    HeadlessStats stats = runner.RunHeadless(headlessOptions);
+
+    if (!options.dumpPath.empty() && !machine->GetVideo().SaveFramebufferPPM(options.dumpPath)) {
+        return -1;
+    }
+    if (!options.rgbaDumpPath.empty() && !SaveFramebufferRGBA(machine->GetVideo(), options.rgbaDumpPath)) {
+        return -1;
+    }
+    return stats.desyncFrames > 0 ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    RunnerOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--roms" && hasValue) {
+            options.romDir = argv[++i];
+        }
+        else if (arg == "--frames" && hasValue) {
+            options.maxFrames = std::stoull(argv[++i]);
+        }
+        else if (arg == "--seconds" && hasValue) {
+            options.maxSeconds = std::stod(argv[++i]);
+        }
+        else if (arg == "--batch" && hasValue) {
+            options.batchInstances = std::stoull(argv[++i]);
+        }
+        else if (arg == "--threads" && hasValue) {
+            options.batchThreads = std::stoul(argv[++i]);
+        }
+        else if (arg == "--record" && hasValue) {
+            options.recordPath = argv[++i];
+        }
+        else if (arg == "--replay" && hasValue) {
+            options.replayPath = argv[++i];
+        }
+        else if (arg == "--dump" && hasValue) {
+            options.dumpPath = argv[++i];
+        }
+        else if (arg == "--dump-rgba" && hasValue) {
+            options.rgbaDumpPath = argv[++i];
+        }
+        else if (arg == "--jit") {
+            options.jit = true;
+        }
+        else if (arg == "--jit-check") {
+            options.jit = true;
+            options.jitCheck = true;
+        }
+        else if (arg == "--indexed") {
+            options.indexed = true;
+        }
+        else {
+            std::cerr << "Argomento sconosciuto: " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    if (options.batchInstances > 0) {
+        return RunBatch(options);
+    }
+    return RunSingle(options);
+}